@@ -0,0 +1,195 @@
+/*
+ * Copyright (C) 2019 Xinyu Ma, Zhiyi Zhang
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include "fec.h"
+
+// GF(2^8) with the polynomial x^8 + x^4 + x^3 + x^2 + 1 (0x11D).
+// fec_exp is doubled so that the sum of two logarithms needs no modulo.
+static const uint8_t fec_exp[510] = {
+  0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1d, 0x3a, 0x74, 0xe8, 0xcd, 0x87, 0x13, 0x26,
+  0x4c, 0x98, 0x2d, 0x5a, 0xb4, 0x75, 0xea, 0xc9, 0x8f, 0x03, 0x06, 0x0c, 0x18, 0x30, 0x60, 0xc0,
+  0x9d, 0x27, 0x4e, 0x9c, 0x25, 0x4a, 0x94, 0x35, 0x6a, 0xd4, 0xb5, 0x77, 0xee, 0xc1, 0x9f, 0x23,
+  0x46, 0x8c, 0x05, 0x0a, 0x14, 0x28, 0x50, 0xa0, 0x5d, 0xba, 0x69, 0xd2, 0xb9, 0x6f, 0xde, 0xa1,
+  0x5f, 0xbe, 0x61, 0xc2, 0x99, 0x2f, 0x5e, 0xbc, 0x65, 0xca, 0x89, 0x0f, 0x1e, 0x3c, 0x78, 0xf0,
+  0xfd, 0xe7, 0xd3, 0xbb, 0x6b, 0xd6, 0xb1, 0x7f, 0xfe, 0xe1, 0xdf, 0xa3, 0x5b, 0xb6, 0x71, 0xe2,
+  0xd9, 0xaf, 0x43, 0x86, 0x11, 0x22, 0x44, 0x88, 0x0d, 0x1a, 0x34, 0x68, 0xd0, 0xbd, 0x67, 0xce,
+  0x81, 0x1f, 0x3e, 0x7c, 0xf8, 0xed, 0xc7, 0x93, 0x3b, 0x76, 0xec, 0xc5, 0x97, 0x33, 0x66, 0xcc,
+  0x85, 0x17, 0x2e, 0x5c, 0xb8, 0x6d, 0xda, 0xa9, 0x4f, 0x9e, 0x21, 0x42, 0x84, 0x15, 0x2a, 0x54,
+  0xa8, 0x4d, 0x9a, 0x29, 0x52, 0xa4, 0x55, 0xaa, 0x49, 0x92, 0x39, 0x72, 0xe4, 0xd5, 0xb7, 0x73,
+  0xe6, 0xd1, 0xbf, 0x63, 0xc6, 0x91, 0x3f, 0x7e, 0xfc, 0xe5, 0xd7, 0xb3, 0x7b, 0xf6, 0xf1, 0xff,
+  0xe3, 0xdb, 0xab, 0x4b, 0x96, 0x31, 0x62, 0xc4, 0x95, 0x37, 0x6e, 0xdc, 0xa5, 0x57, 0xae, 0x41,
+  0x82, 0x19, 0x32, 0x64, 0xc8, 0x8d, 0x07, 0x0e, 0x1c, 0x38, 0x70, 0xe0, 0xdd, 0xa7, 0x53, 0xa6,
+  0x51, 0xa2, 0x59, 0xb2, 0x79, 0xf2, 0xf9, 0xef, 0xc3, 0x9b, 0x2b, 0x56, 0xac, 0x45, 0x8a, 0x09,
+  0x12, 0x24, 0x48, 0x90, 0x3d, 0x7a, 0xf4, 0xf5, 0xf7, 0xf3, 0xfb, 0xeb, 0xcb, 0x8b, 0x0b, 0x16,
+  0x2c, 0x58, 0xb0, 0x7d, 0xfa, 0xe9, 0xcf, 0x83, 0x1b, 0x36, 0x6c, 0xd8, 0xad, 0x47, 0x8e, 0x01,
+  0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1d, 0x3a, 0x74, 0xe8, 0xcd, 0x87, 0x13, 0x26, 0x4c,
+  0x98, 0x2d, 0x5a, 0xb4, 0x75, 0xea, 0xc9, 0x8f, 0x03, 0x06, 0x0c, 0x18, 0x30, 0x60, 0xc0, 0x9d,
+  0x27, 0x4e, 0x9c, 0x25, 0x4a, 0x94, 0x35, 0x6a, 0xd4, 0xb5, 0x77, 0xee, 0xc1, 0x9f, 0x23, 0x46,
+  0x8c, 0x05, 0x0a, 0x14, 0x28, 0x50, 0xa0, 0x5d, 0xba, 0x69, 0xd2, 0xb9, 0x6f, 0xde, 0xa1, 0x5f,
+  0xbe, 0x61, 0xc2, 0x99, 0x2f, 0x5e, 0xbc, 0x65, 0xca, 0x89, 0x0f, 0x1e, 0x3c, 0x78, 0xf0, 0xfd,
+  0xe7, 0xd3, 0xbb, 0x6b, 0xd6, 0xb1, 0x7f, 0xfe, 0xe1, 0xdf, 0xa3, 0x5b, 0xb6, 0x71, 0xe2, 0xd9,
+  0xaf, 0x43, 0x86, 0x11, 0x22, 0x44, 0x88, 0x0d, 0x1a, 0x34, 0x68, 0xd0, 0xbd, 0x67, 0xce, 0x81,
+  0x1f, 0x3e, 0x7c, 0xf8, 0xed, 0xc7, 0x93, 0x3b, 0x76, 0xec, 0xc5, 0x97, 0x33, 0x66, 0xcc, 0x85,
+  0x17, 0x2e, 0x5c, 0xb8, 0x6d, 0xda, 0xa9, 0x4f, 0x9e, 0x21, 0x42, 0x84, 0x15, 0x2a, 0x54, 0xa8,
+  0x4d, 0x9a, 0x29, 0x52, 0xa4, 0x55, 0xaa, 0x49, 0x92, 0x39, 0x72, 0xe4, 0xd5, 0xb7, 0x73, 0xe6,
+  0xd1, 0xbf, 0x63, 0xc6, 0x91, 0x3f, 0x7e, 0xfc, 0xe5, 0xd7, 0xb3, 0x7b, 0xf6, 0xf1, 0xff, 0xe3,
+  0xdb, 0xab, 0x4b, 0x96, 0x31, 0x62, 0xc4, 0x95, 0x37, 0x6e, 0xdc, 0xa5, 0x57, 0xae, 0x41, 0x82,
+  0x19, 0x32, 0x64, 0xc8, 0x8d, 0x07, 0x0e, 0x1c, 0x38, 0x70, 0xe0, 0xdd, 0xa7, 0x53, 0xa6, 0x51,
+  0xa2, 0x59, 0xb2, 0x79, 0xf2, 0xf9, 0xef, 0xc3, 0x9b, 0x2b, 0x56, 0xac, 0x45, 0x8a, 0x09, 0x12,
+  0x24, 0x48, 0x90, 0x3d, 0x7a, 0xf4, 0xf5, 0xf7, 0xf3, 0xfb, 0xeb, 0xcb, 0x8b, 0x0b, 0x16, 0x2c,
+  0x58, 0xb0, 0x7d, 0xfa, 0xe9, 0xcf, 0x83, 0x1b, 0x36, 0x6c, 0xd8, 0xad, 0x47, 0x8e,
+};
+
+static const uint8_t fec_log[256] = {
+  0x00, 0x00, 0x01, 0x19, 0x02, 0x32, 0x1a, 0xc6, 0x03, 0xdf, 0x33, 0xee, 0x1b, 0x68, 0xc7, 0x4b,
+  0x04, 0x64, 0xe0, 0x0e, 0x34, 0x8d, 0xef, 0x81, 0x1c, 0xc1, 0x69, 0xf8, 0xc8, 0x08, 0x4c, 0x71,
+  0x05, 0x8a, 0x65, 0x2f, 0xe1, 0x24, 0x0f, 0x21, 0x35, 0x93, 0x8e, 0xda, 0xf0, 0x12, 0x82, 0x45,
+  0x1d, 0xb5, 0xc2, 0x7d, 0x6a, 0x27, 0xf9, 0xb9, 0xc9, 0x9a, 0x09, 0x78, 0x4d, 0xe4, 0x72, 0xa6,
+  0x06, 0xbf, 0x8b, 0x62, 0x66, 0xdd, 0x30, 0xfd, 0xe2, 0x98, 0x25, 0xb3, 0x10, 0x91, 0x22, 0x88,
+  0x36, 0xd0, 0x94, 0xce, 0x8f, 0x96, 0xdb, 0xbd, 0xf1, 0xd2, 0x13, 0x5c, 0x83, 0x38, 0x46, 0x40,
+  0x1e, 0x42, 0xb6, 0xa3, 0xc3, 0x48, 0x7e, 0x6e, 0x6b, 0x3a, 0x28, 0x54, 0xfa, 0x85, 0xba, 0x3d,
+  0xca, 0x5e, 0x9b, 0x9f, 0x0a, 0x15, 0x79, 0x2b, 0x4e, 0xd4, 0xe5, 0xac, 0x73, 0xf3, 0xa7, 0x57,
+  0x07, 0x70, 0xc0, 0xf7, 0x8c, 0x80, 0x63, 0x0d, 0x67, 0x4a, 0xde, 0xed, 0x31, 0xc5, 0xfe, 0x18,
+  0xe3, 0xa5, 0x99, 0x77, 0x26, 0xb8, 0xb4, 0x7c, 0x11, 0x44, 0x92, 0xd9, 0x23, 0x20, 0x89, 0x2e,
+  0x37, 0x3f, 0xd1, 0x5b, 0x95, 0xbc, 0xcf, 0xcd, 0x90, 0x87, 0x97, 0xb2, 0xdc, 0xfc, 0xbe, 0x61,
+  0xf2, 0x56, 0xd3, 0xab, 0x14, 0x2a, 0x5d, 0x9e, 0x84, 0x3c, 0x39, 0x53, 0x47, 0x6d, 0x41, 0xa2,
+  0x1f, 0x2d, 0x43, 0xd8, 0xb7, 0x7b, 0xa4, 0x76, 0xc4, 0x17, 0x49, 0xec, 0x7f, 0x0c, 0x6f, 0xf6,
+  0x6c, 0xa1, 0x3b, 0x52, 0x29, 0x9d, 0x55, 0xaa, 0xfb, 0x60, 0x86, 0xb1, 0xbb, 0xcc, 0x3e, 0x5a,
+  0xcb, 0x59, 0x5f, 0xb0, 0x9c, 0xa9, 0xa0, 0x51, 0x0b, 0xf5, 0x16, 0xeb, 0x7a, 0x75, 0x2c, 0xd7,
+  0x4f, 0xae, 0xd5, 0xe9, 0xe6, 0xe7, 0xad, 0xe8, 0x74, 0xd6, 0xf4, 0xea, 0xa8, 0x50, 0x58, 0xaf,
+};
+
+static inline uint8_t
+fec_mul(uint8_t a, uint8_t b)
+{
+  if (a == 0 || b == 0)
+    return 0;
+  return fec_exp[fec_log[a] + fec_log[b]];
+}
+
+static inline uint8_t
+fec_inv(uint8_t a)
+{
+  return fec_exp[255 - fec_log[a]];
+}
+
+// The coefficient of data block i in parity block j.
+// The Cauchy matrix 1 / (x_j + y_i), with x_j = 255 - j and y_i = i, has every square submatrix
+// invertible. Its columns are scaled so that the first row is all ones, i.e. a plain XOR.
+static inline uint8_t
+fec_coefficient(uint32_t parity_index, uint32_t data_index)
+{
+  if (parity_index == 0)
+    return 1;
+  return fec_mul((uint8_t)(255 ^ data_index), fec_inv((uint8_t)((255 - parity_index) ^ data_index)));
+}
+
+// block ^= c * data
+static void
+fec_mul_add(uint8_t* block, const uint8_t* data, uint32_t size, uint8_t c)
+{
+  if (c == 0)
+    return;
+  if (c == 1) {
+    for (uint32_t b = 0; b < size; b++)
+      block[b] ^= data[b];
+    return;
+  }
+  uint32_t log_c = fec_log[c];
+  for (uint32_t b = 0; b < size; b++) {
+    if (data[b] != 0)
+      block[b] ^= fec_exp[fec_log[data[b]] + log_c];
+  }
+}
+
+void
+ndn_fec_encode(const uint8_t* packet, uint32_t size, uint32_t unit, uint32_t data_count,
+               uint32_t parity_index, uint8_t* parity)
+{
+  memset(parity, 0, unit);
+  for (uint32_t i = 0; i < data_count; i++) {
+    uint32_t offset = i * unit;
+    if (offset >= size)
+      break;
+    // the missing bytes of the last block are zeros
+    uint32_t length = (size - offset < unit) ? size - offset : unit;
+    fec_mul_add(parity, packet + offset, length, fec_coefficient(parity_index, i));
+  }
+}
+
+int
+ndn_fec_decode(uint8_t* blocks, uint32_t unit, uint32_t data_count,
+               const uint32_t* lost, uint32_t lost_count,
+               const uint32_t* parities, uint32_t parity_count)
+{
+  uint8_t matrix[NDN_FEC_MAX_PARITY][NDN_FEC_MAX_PARITY];
+  uint8_t inverse[NDN_FEC_MAX_PARITY][NDN_FEC_MAX_PARITY];
+  uint32_t is_lost[8] = {0};
+  const uint32_t n = lost_count;
+
+  if (n == 0)
+    return 0;
+  if (n > NDN_FEC_MAX_PARITY || n > parity_count || data_count > 255 - NDN_FEC_MAX_PARITY)
+    return NDN_OVERSIZE;
+  for (uint32_t m = 0; m < n; m++)
+    is_lost[lost[m] / 32] |= 1u << (lost[m] % 32);
+
+  // Take the received data out of the parity blocks, leaving what the lost blocks add
+  for (uint32_t r = 0; r < n; r++) {
+    uint8_t* syndrome = blocks + (data_count + parities[r]) * unit;
+    for (uint32_t i = 0; i < data_count; i++) {
+      if (is_lost[i / 32] & (1u << (i % 32)))
+        continue;
+      fec_mul_add(syndrome, blocks + i * unit, unit, fec_coefficient(parities[r], i));
+    }
+    for (uint32_t m = 0; m < n; m++)
+      matrix[r][m] = fec_coefficient(parities[r], lost[m]);
+  }
+
+  // Invert the coefficients of the lost blocks by Gauss-Jordan elimination
+  for (uint32_t r = 0; r < n; r++) {
+    for (uint32_t m = 0; m < n; m++)
+      inverse[r][m] = (r == m) ? 1 : 0;
+  }
+  for (uint32_t col = 0; col < n; col++) {
+    uint32_t pivot = col;
+    while (pivot < n && matrix[pivot][col] == 0)
+      pivot ++;
+    if (pivot == n)
+      return NDN_OVERSIZE;
+    if (pivot != col) {
+      for (uint32_t m = 0; m < n; m++) {
+        uint8_t t = matrix[col][m]; matrix[col][m] = matrix[pivot][m]; matrix[pivot][m] = t;
+        t = inverse[col][m]; inverse[col][m] = inverse[pivot][m]; inverse[pivot][m] = t;
+      }
+    }
+    uint8_t scale = fec_inv(matrix[col][col]);
+    for (uint32_t m = 0; m < n; m++) {
+      matrix[col][m] = fec_mul(matrix[col][m], scale);
+      inverse[col][m] = fec_mul(inverse[col][m], scale);
+    }
+    for (uint32_t r = 0; r < n; r++) {
+      uint8_t factor = matrix[r][col];
+      if (r == col || factor == 0)
+        continue;
+      for (uint32_t m = 0; m < n; m++) {
+        matrix[r][m] ^= fec_mul(factor, matrix[col][m]);
+        inverse[r][m] ^= fec_mul(factor, inverse[col][m]);
+      }
+    }
+  }
+
+  // Each lost block is a combination of the syndromes
+  for (uint32_t m = 0; m < n; m++) {
+    uint8_t* block = blocks + lost[m] * unit;
+    memset(block, 0, unit);
+    for (uint32_t r = 0; r < n; r++)
+      fec_mul_add(block, blocks + (data_count + parities[r]) * unit, unit, inverse[m][r]);
+  }
+  return 0;
+}
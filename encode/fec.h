@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2019 Xinyu Ma, Zhiyi Zhang
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#ifndef NDN_ENCODING_FEC_H
+#define NDN_ENCODING_FEC_H
+
+#include "../ndn-constants.h"
+#include "../ndn-error-code.h"
+#include <inttypes.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Erasure code over the fragments of a packet.
+ * A packet cut into n data blocks of the same size (the last one padded with zeros) gets up to
+ * NDN_FEC_MAX_PARITY parity blocks. Any n of the n + k blocks rebuild the packet: the parity
+ * blocks are a systematic Reed-Solomon code over GF(2^8), built from a Cauchy matrix so that
+ * every set of parity blocks can replace the same number of lost data blocks.
+ * With a single parity block, the code is the XOR of the data blocks.
+ *
+ * On a link, a parity fragment uses the ndn-riot header of fragmentation-support.h with the
+ * parity bit set and the parity index as Seq#, followed by the number of data fragments and
+ * the size of the packet (NDN_FEC_HDR_LEN bytes), then the parity block:
+ *
+ *    0           1           2           3           4           5
+ *    +-+-+--+----+----------------------+-----------+-----------------------+
+ *    |1|1|0 |Par#|    Identification    | Frag count|      Packet size      |
+ *    +-+-+--+----+----------------------+-----------+-----------------------+
+ */
+
+/**
+ * The bit of the ndn-riot header marking a parity fragment.
+ */
+#define NDN_FEC_PARITY_MASK 0x40
+
+/**
+ * The size of the parity fragment fields following the ndn-riot header.
+ */
+#define NDN_FEC_HDR_LEN 3
+
+/**
+ * Compute a parity block of a packet.
+ * @param packet. Input. The packet.
+ * @param size. Input. The size of the packet, up to @c data_count * @c unit.
+ * @param unit. Input. The size of a block.
+ * @param data_count. Input. The number of data blocks, smaller than 256 - NDN_FEC_MAX_PARITY.
+ * @param parity_index. Input. The index of the parity block, smaller than NDN_FEC_MAX_PARITY.
+ * @param parity. Output. The parity block, @c unit bytes.
+ */
+void
+ndn_fec_encode(const uint8_t* packet, uint32_t size, uint32_t unit, uint32_t data_count,
+               uint32_t parity_index, uint8_t* parity);
+
+/**
+ * Rebuild the lost data blocks of a packet from its parity blocks.
+ * @param blocks. Input/Output. The blocks: data block i at i * @c unit, the last one padded
+ *        with zeros, and parity block j at (@c data_count + j) * @c unit.
+ * @param unit. Input. The size of a block.
+ * @param data_count. Input. The number of data blocks.
+ * @param lost. Input. The indexes of the lost data blocks.
+ * @param lost_count. Input. The number of lost data blocks, up to NDN_FEC_MAX_PARITY.
+ * @param parities. Input. The indexes of the received parity blocks.
+ * @param parity_count. Input. The number of received parity blocks, at least @c lost_count.
+ * @return 0 if there is no error. NDN_OVERSIZE if too many blocks are lost.
+ */
+int
+ndn_fec_decode(uint8_t* blocks, uint32_t unit, uint32_t data_count,
+               const uint32_t* lost, uint32_t lost_count,
+               const uint32_t* parities, uint32_t parity_count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NDN_ENCODING_FEC_H
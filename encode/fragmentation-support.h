@@ -28,10 +28,14 @@ extern "C" {
  *    +-+-+--+----+----------------------+
  *
  *    First bit: header bit, always 1 (indicating the fragmentation header)
- *    Second bit: reserved, always 0
+ *    Second bit: parity bit (NDN_FEC_PARITY_MASK), 0 for a data fragment
  *    Third bit: MF bit
  *    4th to 8th bit: sequence number (5 bits, encoding up to 31 fragments)
  *    9th to 24th bit: identification (2-byte random number)
+ *
+ *    A parity fragment has the parity bit set and the parity index as sequence number, and
+ *    the header is followed by NDN_FEC_HDR_LEN more bytes: the number of data fragments
+ *    (1 byte) and the size of the packet (2 bytes). See fec.h.
  */
 
 /**
@@ -98,39 +102,100 @@ ndn_fragmenter_init(ndn_fragmenter_t* fragmenter, const uint8_t* original, uint3
 }
 
 /**
- * Generate one fragmented packet.
+ * A fragment described in place: its header, and the slice of the original packet it carries.
+ * Sending the header followed by the payload gives the same bytes as ndn_fragmenter_fragment().
+ */
+typedef struct ndn_fragment {
+  /**
+   * The fragmentation header.
+   */
+  uint8_t header[NDN_FRAG_HDR_LEN];
+  /**
+   * The payload, pointing into the original packet.
+   */
+  const uint8_t* payload;
+  /**
+   * The size of the payload.
+   */
+  uint32_t payload_size;
+} ndn_fragment_t;
+
+/**
+ * Describe the next fragment without copying the original packet.
  * @param fragmenter. Input/Output. The fragmenter used to keep the original packet and the state.
- * @param fragmented. Output. The buffer to keep the fragmented packet.
- *        The buffer size should at least be the fragmenter->fragment_max_size.
- * @return 0 if there is no error.
+ * @param fragment. Output. The fragment. Its payload is valid while the original packet is.
+ * @return 0 if there is no error. NDN_FRAG_NO_MORE_FRAGS if all fragments have been generated.
  */
 static inline int
-ndn_fragmenter_fragment(ndn_fragmenter_t* fragmenter, uint8_t* fragmented)
+ndn_fragmenter_next(ndn_fragmenter_t* fragmenter, ndn_fragment_t* fragment)
 {
   if (fragmenter->counter == fragmenter->total_frag_num)
     return NDN_FRAG_NO_MORE_FRAGS;
 
-  memset(fragmented, 0, fragmenter->fragment_max_size);
-
   uint8_t is_last = (fragmenter->counter == fragmenter->total_frag_num - 1)? 1 : 0;
   uint8_t seq = fragmenter->counter % (NDN_FRAG_MAX_SEQ_NUM + 1);
 
   // header
-  fragmented[0] = seq;
+  fragment->header[0] = seq | NDN_FRAG_HB_MASK;
   if (is_last)
-    fragmented[0] |= NDN_FRAG_MF_MASK;
-  fragmented[0] |= NDN_FRAG_HB_MASK;
-  fragmented[1] = (fragmenter->frag_identifier >> 8) & 0xFF;
-  fragmented[2] = fragmenter->frag_identifier & 0xFF;
+    fragment->header[0] |= NDN_FRAG_MF_MASK;
+  fragment->header[1] = (fragmenter->frag_identifier >> 8) & 0xFF;
+  fragment->header[2] = fragmenter->frag_identifier & 0xFF;
 
   // payload
-  int size = (is_last)?
-    fragmenter->original_size - fragmenter->offset: fragmenter->fragment_max_size - 3;
-  memcpy(&fragmented[3], &fragmenter->original[fragmenter->offset], size);
+  fragment->payload = &fragmenter->original[fragmenter->offset];
+  fragment->payload_size = (is_last)?
+    fragmenter->original_size - fragmenter->offset: fragmenter->fragment_max_size - NDN_FRAG_HDR_LEN;
 
   // update state
   fragmenter->counter++;
-  fragmenter->offset += size;
+  fragmenter->offset += fragment->payload_size;
+  return 0;
+}
+
+/**
+ * Get the size of a fragment on the wire.
+ * @param fragment. Input. The fragment.
+ */
+static inline uint32_t
+ndn_fragment_size(const ndn_fragment_t* fragment)
+{
+  return NDN_FRAG_HDR_LEN + fragment->payload_size;
+}
+
+/**
+ * Copy a fragment into a contiguous buffer, for links which cannot send it in pieces.
+ * @param fragment. Input. The fragment.
+ * @param buffer. Output. The buffer, at least ndn_fragment_size() bytes.
+ * @return The size of the fragment.
+ */
+static inline uint32_t
+ndn_fragment_copy(const ndn_fragment_t* fragment, uint8_t* buffer)
+{
+  memcpy(buffer, fragment->header, NDN_FRAG_HDR_LEN);
+  memcpy(&buffer[NDN_FRAG_HDR_LEN], fragment->payload, fragment->payload_size);
+  return ndn_fragment_size(fragment);
+}
+
+/**
+ * Generate one fragmented packet.
+ * The buffer is written once: only the bytes past a shorter last fragment are zeroed.
+ * ndn_fragmenter_next() avoids the copy.
+ * @param fragmenter. Input/Output. The fragmenter used to keep the original packet and the state.
+ * @param fragmented. Output. The buffer to keep the fragmented packet.
+ *        The buffer size should at least be the fragmenter->fragment_max_size.
+ * @return 0 if there is no error.
+ */
+static inline int
+ndn_fragmenter_fragment(ndn_fragmenter_t* fragmenter, uint8_t* fragmented)
+{
+  ndn_fragment_t fragment;
+  int ret = ndn_fragmenter_next(fragmenter, &fragment);
+  if (ret != 0)
+    return ret;
+  uint32_t size = ndn_fragment_copy(&fragment, fragmented);
+  if (size < fragmenter->fragment_max_size)
+    memset(&fragmented[size], 0, fragmenter->fragment_max_size - size);
   return 0;
 }
 
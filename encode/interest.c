@@ -12,6 +12,89 @@
 /*  Definition of helper functions                          */
 /************************************************************/
 
+// get the length of tlv's v of the forwarding hint
+static uint32_t
+ndn_forwarding_hint_probe_block_value_size(const interest_forwarding_hint_t* hint)
+{
+  uint32_t hint_buffer_size = 0;
+  for (uint32_t i = 0; i < hint->size; i++) {
+    uint32_t delegation_size = 2 + encoder_probe_uint_length(hint->delegations[i].preference)
+                               + ndn_name_probe_block_size(&hint->delegations[i].name);
+    hint_buffer_size += encoder_probe_block_size(TLV_Delegation, delegation_size);
+  }
+  return hint_buffer_size;
+}
+
+static int
+ndn_forwarding_hint_tlv_encode(ndn_encoder_t* encoder, const interest_forwarding_hint_t* hint)
+{
+  int ret_val = -1;
+
+  ret_val = encoder_append_type(encoder, TLV_ForwardingHint);
+  if (ret_val != NDN_SUCCESS) return ret_val;
+  ret_val = encoder_append_length(encoder, ndn_forwarding_hint_probe_block_value_size(hint));
+  if (ret_val != NDN_SUCCESS) return ret_val;
+  for (uint32_t i = 0; i < hint->size; i++) {
+    const ndn_delegation_t* delegation = &hint->delegations[i];
+    uint32_t preference_size = encoder_probe_uint_length(delegation->preference);
+    ret_val = encoder_append_type(encoder, TLV_Delegation);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+    ret_val = encoder_append_length(encoder, 2 + preference_size
+                                    + ndn_name_probe_block_size(&delegation->name));
+    if (ret_val != NDN_SUCCESS) return ret_val;
+    ret_val = encoder_append_type(encoder, TLV_Preference);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+    ret_val = encoder_append_length(encoder, preference_size);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+    ret_val = encoder_append_uint_value(encoder, delegation->preference);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+    ret_val = ndn_name_tlv_encode(encoder, &delegation->name);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+  }
+  return 0;
+}
+
+static int
+ndn_forwarding_hint_tlv_decode(ndn_decoder_t* decoder, uint32_t length, interest_forwarding_hint_t* hint)
+{
+  int ret_val = -1;
+  uint32_t end_offset = decoder->offset + length;
+  uint32_t type = 0;
+  uint32_t delegation_length = 0;
+  uint32_t preference_length = 0;
+
+  hint->size = 0;
+  while (decoder->offset < end_offset) {
+    ret_val = decoder_get_type(decoder, &type);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+    if (type != TLV_Delegation) {
+      return NDN_WRONG_TLV_TYPE;
+    }
+    ret_val = decoder_get_length(decoder, &delegation_length);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+    if (hint->size == NDN_INTEREST_DELEGATIONS_SIZE) {
+      // the least preferred ones are dropped
+      ret_val = decoder_move_forward(decoder, delegation_length);
+      if (ret_val != NDN_SUCCESS) return ret_val;
+      continue;
+    }
+    ndn_delegation_t* delegation = &hint->delegations[hint->size];
+    ret_val = decoder_get_type(decoder, &type);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+    if (type != TLV_Preference) {
+      return NDN_WRONG_TLV_TYPE;
+    }
+    ret_val = decoder_get_length(decoder, &preference_length);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+    ret_val = decoder_get_uint_value(decoder, preference_length, &delegation->preference);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+    ret_val = ndn_name_tlv_decode(decoder, &delegation->name);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+    hint->size ++;
+  }
+  return 0;
+}
+
 // get the length of tlv's v of the interest
 static uint32_t
 ndn_interest_probe_block_value_size(const ndn_interest_t* interest)
@@ -23,6 +106,10 @@ ndn_interest_probe_block_value_size(const ndn_interest_t* interest)
   // must be fresh
   if (interest->enable_MustBeFresh)
     interest_buffer_size += 2;
+  // forwarding hint
+  if (interest->enable_ForwardingHint)
+    interest_buffer_size += encoder_probe_block_size(TLV_ForwardingHint,
+                                                     ndn_forwarding_hint_probe_block_value_size(&interest->forwarding_hint));
   // nonce
   interest_buffer_size += 6;
   // life time
@@ -83,6 +170,13 @@ ndn_interest_from_block(ndn_interest_t* interest, const uint8_t* block_value, ui
       ret_val = decoder_get_length(&decoder, &length);
       if (ret_val != NDN_SUCCESS) return ret_val;
     }
+    else if (type == TLV_ForwardingHint) {
+      interest->enable_ForwardingHint = 1;
+      ret_val = decoder_get_length(&decoder, &length);
+      if (ret_val != NDN_SUCCESS) return ret_val;
+      ret_val = ndn_forwarding_hint_tlv_decode(&decoder, length, &interest->forwarding_hint);
+      if (ret_val != NDN_SUCCESS) return ret_val;
+    }
     else if (type == TLV_Nonce) {
       ret_val = decoder_get_length(&decoder, &length);
       if (ret_val != NDN_SUCCESS) return ret_val;
@@ -168,6 +262,11 @@ ndn_interest_tlv_encode(ndn_encoder_t* encoder, const ndn_interest_t* interest)
     ret_val = encoder_append_length(encoder, 0);
     if (ret_val != NDN_SUCCESS) return ret_val;
   }
+  // forwarding hint
+  if (interest->enable_ForwardingHint > 0) {
+    ret_val = ndn_forwarding_hint_tlv_encode(encoder, &interest->forwarding_hint);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+  }
   // nonce
   ret_val = encoder_append_type(encoder, TLV_Nonce);
   if (ret_val != NDN_SUCCESS) return ret_val;
@@ -210,3 +309,21 @@ ndn_interest_tlv_encode(ndn_encoder_t* encoder, const ndn_interest_t* interest)
   }
   return 0;
 }
+
+int
+ndn_interest_add_Delegation(ndn_interest_t* interest, uint64_t preference, const ndn_name_t* name)
+{
+  interest_forwarding_hint_t* hint = &interest->forwarding_hint;
+  if (hint->size >= NDN_INTEREST_DELEGATIONS_SIZE)
+    return NDN_OVERSIZE;
+  uint32_t pos = hint->size;
+  while (pos > 0 && hint->delegations[pos - 1].preference > preference) {
+    hint->delegations[pos] = hint->delegations[pos - 1];
+    pos --;
+  }
+  hint->delegations[pos].preference = preference;
+  hint->delegations[pos].name = *name;
+  hint->size ++;
+  interest->enable_ForwardingHint = 1;
+  return 0;
+}
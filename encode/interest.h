@@ -25,6 +25,31 @@ typedef struct interest_params {
   uint32_t size;
 } interest_params_t;
 
+/**
+ * The structure to represent a Delegation of the ForwardingHint element.
+ */
+typedef struct ndn_delegation {
+  /**
+   * The Preference, lower is more preferred.
+   */
+  uint64_t preference;
+  /**
+   * The name through which the Interest can be forwarded.
+   */
+  ndn_name_t name;
+} ndn_delegation_t;
+
+/**
+ * The structure to represent the Interest ForwardingHint element.
+ */
+typedef struct interest_forwarding_hint {
+  /**
+   * The Delegations, sorted by Preference.
+   */
+  ndn_delegation_t delegations[NDN_INTEREST_DELEGATIONS_SIZE];
+  uint32_t size;
+} interest_forwarding_hint_t;
+
 /**
  * The structure to represent an NDN Interest packet.
  */
@@ -45,6 +70,12 @@ typedef struct ndn_interest {
   uint8_t enable_CanBePrefix;
   uint8_t enable_MustBeFresh;
 
+  /**
+   * The ForwardingHint of the Interest. Used when enable_ForwardingHint > 0.
+   */
+  interest_forwarding_hint_t forwarding_hint;
+  uint8_t enable_ForwardingHint;
+
   /**
    * The Parameters of the Interest. Used when enable_Parameters > 0.
    */
@@ -75,6 +106,8 @@ ndn_interest_init(ndn_interest_t* interest)
 {
   interest->enable_CanBePrefix = 0;
   interest->enable_MustBeFresh = 0;
+  interest->enable_ForwardingHint = 0;
+  interest->forwarding_hint.size = 0;
   interest->enable_HopLimit = 0;
   interest->enable_Parameters = 0;
   interest->is_SignedInterest = 0;
@@ -98,6 +131,8 @@ ndn_interest_from_name(ndn_interest_t* interest, const ndn_name_t* name)
 
   interest->enable_CanBePrefix = 0;
   interest->enable_MustBeFresh = 0;
+  interest->enable_ForwardingHint = 0;
+  interest->forwarding_hint.size = 0;
   interest->enable_HopLimit = 0;
   interest->enable_Parameters = 0;
   interest->is_SignedInterest = 0;
@@ -139,6 +174,18 @@ ndn_interest_set_MustBeFresh(ndn_interest_t* interest, uint8_t must_be_fresh)
   interest->enable_MustBeFresh = (must_be_fresh > 0 ? 1 : 0);
 }
 
+/**
+ * Add a Delegation to the ForwardingHint of the Interest, keeping them sorted by Preference.
+ * A router without a route to the Interest name forwards it towards a Delegation name instead.
+ * @param interest. Output. The Interest whose ForwardingHint will be set.
+ * @param preference. Input. The Preference of the Delegation, lower is more preferred.
+ * @param name. Input. The Delegation name.
+ * @return 0 if there is no error. NDN_OVERSIZE if the ForwardingHint already holds
+ *         NDN_INTEREST_DELEGATIONS_SIZE Delegations.
+ */
+int
+ndn_interest_add_Delegation(ndn_interest_t* interest, uint64_t preference, const ndn_name_t* name);
+
 /**
  * Set HopLimit element of the Interest.
  * @param interest. Output. The Interest whose HopLimit will be set.
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2019 Xinyu Ma, Zhiyi Zhang
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include "lp-aggregation.h"
+
+void
+ndn_lp_aggregator_init(ndn_lp_aggregator_t* aggregator, ndn_lp_aggregator_send_t send,
+                       uint8_t* frame, uint32_t mtu, uint32_t delay)
+{
+  aggregator->send = send;
+  aggregator->frame = frame;
+  aggregator->mtu = mtu;
+  aggregator->size = 0;
+  aggregator->count = 0;
+  aggregator->delay = delay;
+  aggregator->deadline = 0;
+}
+
+int
+ndn_lp_aggregator_add(ndn_lp_aggregator_t* aggregator, const uint8_t* packet, uint32_t size, uint64_t now)
+{
+  int ret_val = 0;
+  if (size > aggregator->mtu || aggregator->size + size > aggregator->mtu) {
+    ret_val = ndn_lp_aggregator_flush(aggregator);
+    if (ret_val != 0) return ret_val;
+    if (size > aggregator->mtu) return NDN_OVERSIZE;
+  }
+  if (aggregator->count == 0) {
+    aggregator->deadline = now + aggregator->delay;
+  }
+  memcpy(aggregator->frame + aggregator->size, packet, size);
+  aggregator->size += size;
+  aggregator->count ++;
+
+  // a full frame cannot wait for more
+  if (aggregator->size == aggregator->mtu) {
+    return ndn_lp_aggregator_flush(aggregator);
+  }
+  return ndn_lp_aggregator_poll(aggregator, now);
+}
+
+int
+ndn_lp_aggregator_poll(ndn_lp_aggregator_t* aggregator, uint64_t now)
+{
+  if (aggregator->count == 0 || now < aggregator->deadline) {
+    return 0;
+  }
+  return ndn_lp_aggregator_flush(aggregator);
+}
+
+int
+ndn_lp_aggregator_flush(ndn_lp_aggregator_t* aggregator)
+{
+  uint32_t size = aggregator->size;
+  if (aggregator->count == 0) {
+    return 0;
+  }
+  aggregator->size = 0;
+  aggregator->count = 0;
+  return aggregator->send(aggregator, aggregator->frame, size);
+}
@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2019 Xinyu Ma, Zhiyi Zhang
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#ifndef NDN_ENCODING_LP_AGGREGATION_H
+#define NDN_ENCODING_LP_AGGREGATION_H
+
+#include "decoder.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * NDN-Lite packs several small packets into one link layer frame, as stream transports do:
+ *
+ *    +----------------+------------+-----------------+
+ *    | Interest TLV   | Data TLV   | LpPacket TLV    |  <= MTU
+ *    +----------------+------------+-----------------+
+ *
+ * Each packet is a complete TLV block, so the receiver splits the frame by the TLV lengths.
+ * A frame with a single packet is the packet itself, so receivers of aggregated frames also
+ * accept links which do not aggregate.
+ */
+
+struct ndn_lp_aggregator;
+
+/**
+ * The frame sending function of an aggregator.
+ * @param self Input. The aggregator, usually a member of the face which owns it.
+ * @param frame Input. The frame.
+ * @param size Input. The size of the frame.
+ * @return 0 if there is no error.
+ */
+typedef int (*ndn_lp_aggregator_send_t)(struct ndn_lp_aggregator* self, const uint8_t* frame, uint32_t size);
+
+/**
+ * The structure to keep the packets waiting for a frame.
+ * Packets are copied into the frame as they are sent. The frame goes out once the next packet
+ * does not fit in the MTU, or at the latest @c delay microseconds after its first packet.
+ * The owner drives the deadline by calling ndn_lp_aggregator_poll() from its event loop.
+ */
+typedef struct ndn_lp_aggregator {
+  /**
+   * The frame sending function.
+   */
+  ndn_lp_aggregator_send_t send;
+  /**
+   * The frame being filled.
+   */
+  uint8_t* frame;
+  /**
+   * The max size of a frame, obtained from the link MTU.
+   */
+  uint32_t mtu;
+  /**
+   * The size of the packets in @c frame.
+   */
+  uint32_t size;
+  /**
+   * The number of packets in @c frame.
+   */
+  uint32_t count;
+  /**
+   * The longest time (in microseconds) a packet waits for a frame. 0 to send every packet
+   * alone.
+   */
+  uint32_t delay;
+  /**
+   * The time (in microseconds) @c frame is sent at the latest.
+   */
+  uint64_t deadline;
+} ndn_lp_aggregator_t;
+
+/**
+ * Init an aggregator.
+ * @param aggregator. Output. The aggregator to be inited.
+ * @param send. Input. The frame sending function.
+ * @param frame. Input. The buffer used to fill a frame, of @c mtu bytes.
+ * @param mtu. Input. The max size of a frame.
+ * @param delay. Input. The longest time (in microseconds) a packet waits for a frame,
+ *        e.g. NDN_LP_AGGREGATION_DELAY.
+ */
+void
+ndn_lp_aggregator_init(ndn_lp_aggregator_t* aggregator, ndn_lp_aggregator_send_t send,
+                       uint8_t* frame, uint32_t mtu, uint32_t delay);
+
+/**
+ * Add a packet to the frame, sending the frame first if the packet does not fit.
+ * @param aggregator. Input/Output. The aggregator.
+ * @param packet. Input. The wire format packet, a complete TLV block. It is copied.
+ * @param size. Input. The size of the packet.
+ * @param now. Input. The current time in microseconds.
+ * @return 0 if there is no error. NDN_OVERSIZE if the packet exceeds the MTU: the packets
+ *         before it are sent, and the caller should fragment it.
+ */
+int
+ndn_lp_aggregator_add(ndn_lp_aggregator_t* aggregator, const uint8_t* packet, uint32_t size, uint64_t now);
+
+/**
+ * Send the frame if it is due.
+ * @param aggregator. Input/Output. The aggregator.
+ * @param now. Input. The current time in microseconds.
+ * @return 0 if there is no error.
+ */
+int
+ndn_lp_aggregator_poll(ndn_lp_aggregator_t* aggregator, uint64_t now);
+
+/**
+ * Send the frame now, e.g. at the end of a burst.
+ * @param aggregator. Input/Output. The aggregator.
+ * @return 0 if there is no error.
+ */
+int
+ndn_lp_aggregator_flush(ndn_lp_aggregator_t* aggregator);
+
+/**
+ * Get the next packet of a received frame, without copying.
+ * @param frame. Input. The frame.
+ * @param size. Input. The size of the frame.
+ * @param offset. Input/Output. The offset of the next packet, 0 for the first one.
+ * @param packet. Output. The packet, pointing into @c frame.
+ * @param packet_size. Output. The size of the packet.
+ * @return 0 if there is no error. NDN_FRAG_NO_MORE_FRAGS at the end of the frame.
+ *         NDN_WRONG_TLV_LENGTH if the rest of the frame is not a TLV block.
+ */
+static inline int
+ndn_lp_frame_next(const uint8_t* frame, uint32_t size, uint32_t* offset,
+                  const uint8_t** packet, uint32_t* packet_size)
+{
+  ndn_decoder_t decoder;
+  uint32_t probe = 0;
+  if (*offset >= size)
+    return NDN_FRAG_NO_MORE_FRAGS;
+  decoder_init(&decoder, frame + *offset, size - *offset);
+  if (decoder_get_type(&decoder, &probe) != NDN_SUCCESS
+      || decoder_get_length(&decoder, &probe) != NDN_SUCCESS
+      || probe > decoder.input_size - decoder.offset)
+    return NDN_WRONG_TLV_LENGTH;
+  *packet = frame + *offset;
+  *packet_size = decoder.offset + probe;
+  *offset += *packet_size;
+  return 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NDN_ENCODING_LP_AGGREGATION_H
@@ -0,0 +1,255 @@
+/*
+ * Copyright (C) 2019 Xinyu Ma, Zhiyi Zhang
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include "lp-reliability.h"
+
+// An IDLE packet carrying every pending ack: the LpPacket T and L, then 12-byte Ack fields
+#define LP_RELIABILITY_IDLE_MAX_SIZE (4 + 12 * NDN_LP_RELIABILITY_MAX_ACKS)
+
+// Overwrite the TxSequence of a kept LpPacket
+static void
+lp_reliability_set_tx_sequence(ndn_lp_reliability_entry_t* entry, uint64_t tx_sequence)
+{
+  for (int i = 0; i < 8; i++) {
+    entry->frame[entry->tx_sequence_offset + i] = (tx_sequence >> (8 * (7 - i))) & 0xFF;
+  }
+  entry->tx_sequence = tx_sequence;
+}
+
+// Update the RTO with a round-trip time measurement (RFC 6298)
+static void
+lp_reliability_measure(ndn_lp_reliability_t* reliability, uint32_t rtt)
+{
+  uint32_t rto = 0;
+  if (reliability->srtt == 0) {
+    reliability->srtt = rtt > 0 ? rtt : 1;
+    reliability->rttvar = rtt / 2;
+  }
+  else {
+    uint32_t delta = (reliability->srtt > rtt) ? reliability->srtt - rtt : rtt - reliability->srtt;
+    // rounded up, so that the variation of a steady link does not fade to 0
+    reliability->rttvar = (3 * reliability->rttvar + delta + 3) / 4;
+    reliability->srtt = (7 * reliability->srtt + rtt + 7) / 8;
+  }
+  rto = reliability->srtt + ((4 * reliability->rttvar > 1) ? 4 * reliability->rttvar : 1);
+  if (rto < NDN_LP_RELIABILITY_RTO_MIN)
+    rto = NDN_LP_RELIABILITY_RTO_MIN;
+  if (rto > NDN_LP_RELIABILITY_RTO_MAX)
+    rto = NDN_LP_RELIABILITY_RTO_MAX;
+  reliability->rto = rto;
+}
+
+// Send a kept LpPacket again with a new TxSequence, or give it up
+static int
+lp_reliability_retransmit(ndn_lp_reliability_t* reliability, ndn_lp_reliability_entry_t* entry, uint64_t now)
+{
+  if (entry->retx_count >= NDN_LP_RELIABILITY_MAX_RETX) {
+    entry->in_use = false;
+    reliability->given_up ++;
+    return 0;
+  }
+  lp_reliability_set_tx_sequence(entry, reliability->next_tx_sequence++);
+  entry->sent_at = now;
+  entry->deadline = now + reliability->rto;
+  entry->retx_count ++;
+  entry->gap_count = 0;
+  reliability->retransmitted ++;
+  return reliability->send(reliability, entry->frame, entry->size);
+}
+
+// Take as many pending acks as an LpPacket can carry within the MTU, oldest first
+static void
+lp_reliability_take_acks(ndn_lp_reliability_t* reliability, ndn_lp_packet_t* lp_packet)
+{
+  uint32_t count = reliability->ack_count;
+  ndn_lp_packet_set_acks(lp_packet, reliability->acks, count);
+  while (count > 0 && ndn_lp_packet_probe_block_size(lp_packet) > reliability->mtu) {
+    ndn_lp_packet_set_acks(lp_packet, reliability->acks, --count);
+  }
+}
+
+// Remove the acks that have been sent
+static void
+lp_reliability_drop_acks(ndn_lp_reliability_t* reliability, uint32_t count)
+{
+  reliability->ack_count -= count;
+  memmove(reliability->acks, reliability->acks + count, reliability->ack_count * sizeof(uint64_t));
+}
+
+// Send the pending acks in as few IDLE packets as the MTU allows
+static int
+lp_reliability_flush_acks(ndn_lp_reliability_t* reliability)
+{
+  int ret_val = 0;
+  uint8_t buffer[LP_RELIABILITY_IDLE_MAX_SIZE];
+  ndn_encoder_t encoder;
+  ndn_lp_packet_t lp_packet;
+
+  while (reliability->ack_count > 0) {
+    ndn_lp_packet_init(&lp_packet, NULL, 0);
+    lp_reliability_take_acks(reliability, &lp_packet);
+    if (lp_packet.ack_count == 0)
+      return NDN_OVERSIZE;
+    encoder_init(&encoder, buffer, sizeof(buffer));
+    ret_val = ndn_lp_packet_tlv_encode(&encoder, &lp_packet);
+    if (ret_val == 0)
+      ret_val = reliability->send(reliability, buffer, encoder.offset);
+    if (ret_val != 0) return ret_val;
+    lp_reliability_drop_acks(reliability, lp_packet.ack_count);
+  }
+  return 0;
+}
+
+void
+ndn_lp_reliability_init(ndn_lp_reliability_t* reliability, ndn_lp_reliability_send_t send,
+                        void* memory, uint32_t capacity, uint32_t mtu)
+{
+  uint8_t* frames = (uint8_t*)memory + sizeof(ndn_lp_reliability_entry_t) * capacity;
+  uint32_t stride = (mtu + 7) & ~7u;
+  reliability->send = send;
+  reliability->entries = (ndn_lp_reliability_entry_t*)memory;
+  reliability->capacity = capacity;
+  reliability->mtu = mtu;
+  reliability->next_tx_sequence = 0;
+  reliability->ack_count = 0;
+  reliability->ack_deadline = 0;
+  reliability->srtt = 0;
+  reliability->rttvar = 0;
+  reliability->rto = NDN_LP_RELIABILITY_RTO_INITIAL;
+  reliability->retransmitted = 0;
+  reliability->given_up = 0;
+  for (uint32_t i = 0; i < capacity; i++) {
+    reliability->entries[i].frame = frames + (size_t)i * stride;
+    reliability->entries[i].in_use = false;
+  }
+}
+
+int
+ndn_lp_reliability_send(ndn_lp_reliability_t* reliability, const ndn_lp_packet_t* lp_packet, uint64_t now)
+{
+  int ret_val = 0;
+  ndn_encoder_t encoder;
+  ndn_lp_packet_t reliable = *lp_packet;
+  ndn_lp_reliability_entry_t* entry = NULL;
+
+  if (reliability->capacity == 0) {
+    return NDN_FRAG_NO_MEM;
+  }
+  reliable.enable_TxSequence = 1;
+  reliable.tx_sequence = reliability->next_tx_sequence;
+  lp_reliability_take_acks(reliability, &reliable);
+  // checked before an LpPacket is given up for a window entry
+  if (ndn_lp_packet_probe_block_size(&reliable) > reliability->mtu) {
+    return NDN_OVERSIZE;
+  }
+  for (uint32_t i = 0; i < reliability->capacity; i++) {
+    ndn_lp_reliability_entry_t* candidate = &reliability->entries[i];
+    if (!candidate->in_use) {
+      entry = candidate;
+      break;
+    }
+    if (entry == NULL || candidate->tx_sequence < entry->tx_sequence)
+      entry = candidate;
+  }
+  if (entry->in_use) {
+    // the window is full: the oldest LpPacket is unlikely to be acknowledged
+    reliability->given_up ++;
+    entry->in_use = false;
+  }
+
+  encoder_init(&encoder, entry->frame, reliability->mtu);
+  ret_val = ndn_lp_packet_tlv_encode(&encoder, &reliable);
+  if (ret_val != NDN_SUCCESS) return ret_val;
+  lp_reliability_drop_acks(reliability, reliable.ack_count);
+
+  // the TxSequence is the last field before the fragment
+  entry->size = encoder.offset;
+  entry->tx_sequence_offset = encoder.offset - 8;
+  if (reliable.fragment != NULL)
+    entry->tx_sequence_offset -= encoder_probe_block_size(TLV_LpFragment, reliable.fragment_size);
+  entry->tx_sequence = reliability->next_tx_sequence++;
+  entry->sent_at = now;
+  entry->deadline = now + reliability->rto;
+  entry->retx_count = 0;
+  entry->gap_count = 0;
+  entry->in_use = true;
+  return reliability->send(reliability, entry->frame, entry->size);
+}
+
+int
+ndn_lp_reliability_on_receive(ndn_lp_reliability_t* reliability, const ndn_lp_packet_t* lp_packet, uint64_t now)
+{
+  int ret_val = 0;
+  uint32_t cursor = 0;
+  uint64_t ack = 0;
+  bool acked = false;
+
+  // release every acknowledged LpPacket first, so that none of them is deemed lost below
+  while (ndn_lp_packet_next_ack(lp_packet, &cursor, &ack)) {
+    for (uint32_t i = 0; i < reliability->capacity; i++) {
+      ndn_lp_reliability_entry_t* entry = &reliability->entries[i];
+      if (entry->in_use && entry->tx_sequence == ack) {
+        entry->in_use = false;
+        lp_reliability_measure(reliability, (uint32_t)(now - entry->sent_at));
+        acked = true;
+        break;
+      }
+    }
+  }
+  if (acked) {
+    // LpPackets sent earlier and still not acknowledged are likely lost
+    for (uint32_t i = 0; i < reliability->capacity; i++) {
+      ndn_lp_reliability_entry_t* entry = &reliability->entries[i];
+      if (!entry->in_use)
+        continue;
+      cursor = 0;
+      while (ndn_lp_packet_next_ack(lp_packet, &cursor, &ack)) {
+        if (ack > entry->tx_sequence)
+          entry->gap_count ++;
+      }
+      if (entry->gap_count >= NDN_LP_RELIABILITY_LOSS_THRESHOLD) {
+        ret_val = lp_reliability_retransmit(reliability, entry, now);
+        if (ret_val != 0) return ret_val;
+      }
+    }
+  }
+  if (lp_packet->enable_TxSequence) {
+    if (reliability->ack_count == NDN_LP_RELIABILITY_MAX_ACKS) {
+      ret_val = lp_reliability_flush_acks(reliability);
+      if (ret_val != 0) return ret_val;
+    }
+    if (reliability->ack_count == 0)
+      reliability->ack_deadline = now + NDN_LP_RELIABILITY_ACK_DELAY;
+    reliability->acks[reliability->ack_count++] = lp_packet->tx_sequence;
+  }
+  return 0;
+}
+
+int
+ndn_lp_reliability_poll(ndn_lp_reliability_t* reliability, uint64_t now)
+{
+  int ret_val = 0;
+  bool backoff = false;
+  for (uint32_t i = 0; i < reliability->capacity; i++) {
+    ndn_lp_reliability_entry_t* entry = &reliability->entries[i];
+    if (!entry->in_use || entry->deadline > now)
+      continue;
+    if (!backoff) {
+      // the link may be slower than estimated (RFC 6298, 5.5)
+      backoff = true;
+      reliability->rto = (reliability->rto * 2 < NDN_LP_RELIABILITY_RTO_MAX) ?
+                         reliability->rto * 2 : NDN_LP_RELIABILITY_RTO_MAX;
+    }
+    ret_val = lp_reliability_retransmit(reliability, entry, now);
+    if (ret_val != 0) return ret_val;
+  }
+  if (reliability->ack_count > 0 && now >= reliability->ack_deadline) {
+    return lp_reliability_flush_acks(reliability);
+  }
+  return 0;
+}
@@ -0,0 +1,208 @@
+/*
+ * Copyright (C) 2019 Xinyu Ma, Zhiyi Zhang
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#ifndef NDN_ENCODING_LP_RELIABILITY_H
+#define NDN_ENCODING_LP_RELIABILITY_H
+
+#include "lp.h"
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * NDNLPv2 link reliability repairs a lost frame on the link it was lost on, instead of waiting
+ * for the consumer to retransmit the Interest.
+ * Every LpPacket sent gets a new TxSequence and is kept until the other end acknowledges it.
+ * The other end acknowledges each TxSequence received with an Ack field, piggybacked on the
+ * next LpPacket it sends, or in an IDLE packet if none is sent within
+ * NDN_LP_RELIABILITY_ACK_DELAY milliseconds. An LpPacket carries as many Ack fields as fit
+ * within the MTU.
+ * An LpPacket is sent again, with a new TxSequence, when it is not acknowledged within the
+ * retransmission timeout (RTO) or when NDN_LP_RELIABILITY_LOSS_THRESHOLD LpPackets sent after
+ * it are acknowledged first. It is given up after NDN_LP_RELIABILITY_MAX_RETX retransmissions.
+ * The RTO is estimated from the acknowledgements as in RFC 6298. Since each transmission has
+ * its own TxSequence, retransmitted LpPackets are also measured.
+ * Retransmission may deliver a packet twice when only the Ack is lost, which the network layer
+ * tolerates as it does duplicates from multiple paths.
+ */
+
+struct ndn_lp_reliability;
+
+/**
+ * The frame sending function of a reliability state, e.g. the link send function of a face.
+ * @param self Input. The reliability state, usually a member of the face which owns it.
+ * @param frame Input. The encoded LpPacket.
+ * @param size Input. The size of the frame.
+ * @return 0 if there is no error.
+ */
+typedef int (*ndn_lp_reliability_send_t)(struct ndn_lp_reliability* self, const uint8_t* frame, uint32_t size);
+
+/**
+ * An LpPacket waiting for its acknowledgement.
+ */
+typedef struct ndn_lp_reliability_entry {
+  /**
+   * The encoded LpPacket, kept to be sent again.
+   */
+  uint8_t* frame;
+  /**
+   * The size of @c frame.
+   */
+  uint32_t size;
+  /**
+   * The offset of the TxSequence value in @c frame, overwritten on retransmission.
+   */
+  uint32_t tx_sequence_offset;
+  /**
+   * The TxSequence of the last transmission.
+   */
+  uint64_t tx_sequence;
+  /**
+   * The time (in milliseconds) of the last transmission.
+   */
+  uint64_t sent_at;
+  /**
+   * The time (in milliseconds) the LpPacket is sent again if not acknowledged.
+   */
+  uint64_t deadline;
+  /**
+   * The number of retransmissions.
+   */
+  uint8_t retx_count;
+  /**
+   * The number of LpPackets sent after this one and acknowledged first.
+   */
+  uint8_t gap_count;
+  /**
+   * Whether the entry keeps an LpPacket.
+   */
+  bool in_use;
+} ndn_lp_reliability_entry_t;
+
+/**
+ * The reliability state of one link.
+ * The owner sends LpPackets with ndn_lp_reliability_send(), gives every received LpPacket to
+ * ndn_lp_reliability_on_receive(), and drives the timers by calling ndn_lp_reliability_poll()
+ * from its event loop.
+ */
+typedef struct ndn_lp_reliability {
+  /**
+   * The frame sending function.
+   */
+  ndn_lp_reliability_send_t send;
+  /**
+   * The LpPackets sent and not yet acknowledged.
+   */
+  ndn_lp_reliability_entry_t* entries;
+  /**
+   * The max number of LpPackets not yet acknowledged.
+   */
+  uint32_t capacity;
+  /**
+   * The max size of a frame, obtained from the link MTU.
+   */
+  uint32_t mtu;
+  /**
+   * The TxSequence of the next transmission.
+   */
+  uint64_t next_tx_sequence;
+  /**
+   * The TxSequences received and not yet acknowledged, oldest first.
+   */
+  uint64_t acks[NDN_LP_RELIABILITY_MAX_ACKS];
+  /**
+   * The number of @c acks.
+   */
+  uint32_t ack_count;
+  /**
+   * The time (in milliseconds) the pending acks are sent at the latest.
+   */
+  uint64_t ack_deadline;
+  /**
+   * The smoothed round-trip time in milliseconds. 0 until the first measurement.
+   */
+  uint32_t srtt;
+  /**
+   * The round-trip time variation in milliseconds.
+   */
+  uint32_t rttvar;
+  /**
+   * The retransmission timeout in milliseconds.
+   */
+  uint32_t rto;
+  /**
+   * The number of retransmissions.
+   */
+  uint32_t retransmitted;
+  /**
+   * The number of LpPackets given up.
+   */
+  uint32_t given_up;
+} ndn_lp_reliability_t;
+
+/**
+ * The required memory to initialize a reliability state.
+ * @param capacity Input. The max number of LpPackets not yet acknowledged.
+ * @param mtu Input. The max size of a frame.
+ */
+#define NDN_LP_RELIABILITY_RESERVE_SIZE(capacity, mtu) \
+    ((sizeof(ndn_lp_reliability_entry_t) + (((mtu) + 7) & ~(size_t)7)) * (capacity))
+
+/**
+ * Init a reliability state.
+ * @pre NDN_LP_RELIABILITY_RESERVE_SIZE(capacity, mtu) bytes needed, aligned to 8 bytes.
+ * @param reliability. Output. The reliability state to be inited.
+ * @param send. Input. The frame sending function.
+ * @param memory. Input. The memory used to keep the LpPackets not yet acknowledged.
+ * @param capacity. Input. The max number of LpPackets not yet acknowledged.
+ * @param mtu. Input. The max size of a frame.
+ */
+void
+ndn_lp_reliability_init(ndn_lp_reliability_t* reliability, ndn_lp_reliability_send_t send,
+                        void* memory, uint32_t capacity, uint32_t mtu);
+
+/**
+ * Send an LpPacket reliably, with a TxSequence and the pending acks that fit within the MTU.
+ * If all entries are in use, the oldest LpPacket not yet acknowledged is given up, unless this
+ * LpPacket exceeds the MTU.
+ * @param reliability. Input/Output. The reliability state.
+ * @param lp_packet. Input. The LpPacket, e.g. a bare network layer packet or an NDNLPv2
+ *        fragment. Its TxSequence and Ack fields are ignored.
+ * @param now. Input. The current time in milliseconds.
+ * @return 0 if there is no error. NDN_OVERSIZE if the LpPacket exceeds the MTU.
+ */
+int
+ndn_lp_reliability_send(ndn_lp_reliability_t* reliability, const ndn_lp_packet_t* lp_packet, uint64_t now);
+
+/**
+ * Process the reliability fields of a received LpPacket: release the LpPackets it acknowledges
+ * and schedule the acknowledgement of its TxSequence.
+ * @param reliability. Input/Output. The reliability state.
+ * @param lp_packet. Input. The received LpPacket.
+ * @param now. Input. The current time in milliseconds.
+ * @return 0 if there is no error.
+ */
+int
+ndn_lp_reliability_on_receive(ndn_lp_reliability_t* reliability, const ndn_lp_packet_t* lp_packet, uint64_t now);
+
+/**
+ * Send again the LpPackets whose RTO expired, and the pending acks if they are due.
+ * @param reliability. Input/Output. The reliability state.
+ * @param now. Input. The current time in milliseconds.
+ * @return 0 if there is no error.
+ */
+int
+ndn_lp_reliability_poll(ndn_lp_reliability_t* reliability, uint64_t now);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NDN_ENCODING_LP_RELIABILITY_H
@@ -0,0 +1,298 @@
+/*
+ * Copyright (C) 2019 Xinyu Ma, Zhiyi Zhang
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include "lp.h"
+
+// An unknown header field may be skipped if its type is in [800, 959] and ends with 00
+#define LP_IS_IGNORABLE_FIELD(type) ((type) >= 800 && (type) <= 959 && ((type) & 0x03) == 0)
+
+// Sequence, TxSequence and Ack are fixed-width integers
+#define LP_SEQUENCE_SIZE 8
+
+static uint32_t
+lp_probe_uint_field(uint32_t type, uint64_t value)
+{
+  return encoder_probe_block_size(type, encoder_probe_uint_length(value));
+}
+
+static int
+lp_append_uint_field(ndn_encoder_t* encoder, uint32_t type, uint64_t value)
+{
+  int ret_val = encoder_append_type(encoder, type);
+  if (ret_val != NDN_SUCCESS) return ret_val;
+  ret_val = encoder_append_length(encoder, encoder_probe_uint_length(value));
+  if (ret_val != NDN_SUCCESS) return ret_val;
+  return encoder_append_uint_value(encoder, value);
+}
+
+static int
+lp_append_sequence_field(ndn_encoder_t* encoder, uint32_t type, uint64_t value)
+{
+  int ret_val = encoder_append_type(encoder, type);
+  if (ret_val != NDN_SUCCESS) return ret_val;
+  ret_val = encoder_append_length(encoder, LP_SEQUENCE_SIZE);
+  if (ret_val != NDN_SUCCESS) return ret_val;
+  return encoder_append_uint64_value(encoder, value);
+}
+
+static uint32_t
+lp_probe_nack_value_size(const ndn_lp_packet_t* lp_packet)
+{
+  if (lp_packet->nack_reason == NDN_LP_NACK_REASON_NONE)
+    return 0;
+  return lp_probe_uint_field(TLV_LpNackReason, lp_packet->nack_reason);
+}
+
+static int
+lp_decode_nack(ndn_decoder_t* decoder, uint32_t length, ndn_lp_packet_t* lp_packet)
+{
+  int ret_val = 0;
+  uint32_t type = 0;
+  uint32_t field_length = 0;
+  uint32_t end = decoder->offset + length;
+  uint64_t reason = NDN_LP_NACK_REASON_NONE;
+
+  while (decoder->offset < end) {
+    ret_val = decoder_get_type(decoder, &type);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+    ret_val = decoder_get_length(decoder, &field_length);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+    if (type == TLV_LpNackReason) {
+      ret_val = decoder_get_uint_value(decoder, field_length, &reason);
+      if (ret_val != NDN_SUCCESS) return ret_val;
+    }
+    else {
+      ret_val = decoder_move_forward(decoder, field_length);
+      if (ret_val != NDN_SUCCESS) return ret_val;
+    }
+  }
+  ndn_lp_packet_set_nack(lp_packet, reason <= 0xFF ? (uint8_t)reason : NDN_LP_NACK_REASON_NONE);
+  return 0;
+}
+
+int
+ndn_lp_packet_from_block(ndn_lp_packet_t* lp_packet, const uint8_t* block_value, uint32_t block_size)
+{
+  int ret_val = 0;
+  uint32_t type = 0;
+  uint32_t length = 0;
+  ndn_decoder_t decoder;
+
+  ndn_lp_packet_init(lp_packet, NULL, 0);
+  decoder_init(&decoder, block_value, block_size);
+  ret_val = decoder_get_type(&decoder, &type);
+  if (ret_val != NDN_SUCCESS) return ret_val;
+  if (type == TLV_Interest || type == TLV_Data) {
+    lp_packet->fragment = block_value;
+    lp_packet->fragment_size = block_size;
+    return 0;
+  }
+  if (type != TLV_LpPacket) {
+    return NDN_WRONG_TLV_TYPE;
+  }
+  ret_val = decoder_get_length(&decoder, &length);
+  if (ret_val != NDN_SUCCESS) return ret_val;
+  if (decoder.offset + length > block_size) {
+    return NDN_WRONG_TLV_LENGTH;
+  }
+  uint32_t end = decoder.offset + length;
+
+  while (decoder.offset < end) {
+    uint32_t field_offset = decoder.offset;
+    ret_val = decoder_get_type(&decoder, &type);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+    ret_val = decoder_get_length(&decoder, &length);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+
+    switch (type) {
+    case TLV_LpFragment:
+      // the fragment is always the last field
+      if (decoder.offset + length != end) {
+        return NDN_WRONG_TLV_LENGTH;
+      }
+      lp_packet->fragment = block_value + decoder.offset;
+      lp_packet->fragment_size = length;
+      ret_val = decoder_move_forward(&decoder, length);
+      break;
+    case TLV_LpSequence:
+      lp_packet->enable_Sequence = 1;
+      ret_val = decoder_get_uint_value(&decoder, length, &lp_packet->sequence);
+      break;
+    case TLV_LpFragIndex: {
+      uint64_t value = 0;
+      lp_packet->enable_FragIndex = 1;
+      ret_val = decoder_get_uint_value(&decoder, length, &value);
+      lp_packet->frag_index = (uint32_t)value;
+      break;
+    }
+    case TLV_LpFragCount: {
+      uint64_t value = 0;
+      lp_packet->enable_FragCount = 1;
+      ret_val = decoder_get_uint_value(&decoder, length, &value);
+      lp_packet->frag_count = (uint32_t)value;
+      break;
+    }
+    case TLV_LpNack:
+      ret_val = lp_decode_nack(&decoder, length, lp_packet);
+      break;
+    case TLV_LpIncomingFaceId:
+      lp_packet->enable_IncomingFaceId = 1;
+      ret_val = decoder_get_uint_value(&decoder, length, &lp_packet->incoming_face_id);
+      break;
+    case TLV_LpCongestionMark:
+      lp_packet->enable_CongestionMark = 1;
+      ret_val = decoder_get_uint_value(&decoder, length, &lp_packet->congestion_mark);
+      break;
+    case TLV_LpAck: {
+      uint64_t value = 0;
+      // header fields are in the order of their types, so repeated Acks are consecutive
+      if (lp_packet->ack_count == 0)
+        lp_packet->ack_fields = block_value + field_offset;
+      else if (lp_packet->ack_fields + lp_packet->ack_fields_size != block_value + field_offset)
+        return NDN_WRONG_TLV_TYPE;
+      ret_val = decoder_get_uint_value(&decoder, length, &value);
+      lp_packet->ack_fields_size += decoder.offset - field_offset;
+      lp_packet->ack_count ++;
+      break;
+    }
+    case TLV_LpTxSequence:
+      lp_packet->enable_TxSequence = 1;
+      ret_val = decoder_get_uint_value(&decoder, length, &lp_packet->tx_sequence);
+      break;
+    default:
+      if (!LP_IS_IGNORABLE_FIELD(type)) {
+        return NDN_WRONG_TLV_TYPE;
+      }
+      ret_val = decoder_move_forward(&decoder, length);
+      break;
+    }
+    if (ret_val != NDN_SUCCESS) return ret_val;
+  }
+  return 0;
+}
+
+bool
+ndn_lp_packet_next_ack(const ndn_lp_packet_t* lp_packet, uint32_t* cursor, uint64_t* ack)
+{
+  uint32_t type = 0;
+  uint32_t length = 0;
+  ndn_decoder_t decoder;
+
+  if (lp_packet->acks != NULL) {
+    if (*cursor >= lp_packet->ack_count)
+      return false;
+    *ack = lp_packet->acks[(*cursor)++];
+    return true;
+  }
+  // the Ack fields have been checked while decoding
+  if (lp_packet->ack_fields == NULL || *cursor >= lp_packet->ack_fields_size)
+    return false;
+  decoder_init(&decoder, lp_packet->ack_fields + *cursor, lp_packet->ack_fields_size - *cursor);
+  if (decoder_get_type(&decoder, &type) != NDN_SUCCESS
+      || decoder_get_length(&decoder, &length) != NDN_SUCCESS
+      || decoder_get_uint_value(&decoder, length, ack) != NDN_SUCCESS)
+    return false;
+  *cursor += decoder.offset;
+  return true;
+}
+
+static uint32_t
+lp_probe_value_size(const ndn_lp_packet_t* lp_packet)
+{
+  uint32_t value_size = 0;
+  if (lp_packet->enable_Sequence)
+    value_size += encoder_probe_block_size(TLV_LpSequence, LP_SEQUENCE_SIZE);
+  if (lp_packet->enable_FragIndex)
+    value_size += lp_probe_uint_field(TLV_LpFragIndex, lp_packet->frag_index);
+  if (lp_packet->enable_FragCount)
+    value_size += lp_probe_uint_field(TLV_LpFragCount, lp_packet->frag_count);
+  if (lp_packet->enable_Nack)
+    value_size += encoder_probe_block_size(TLV_LpNack, lp_probe_nack_value_size(lp_packet));
+  if (lp_packet->enable_IncomingFaceId)
+    value_size += lp_probe_uint_field(TLV_LpIncomingFaceId, lp_packet->incoming_face_id);
+  if (lp_packet->enable_CongestionMark)
+    value_size += lp_probe_uint_field(TLV_LpCongestionMark, lp_packet->congestion_mark);
+  value_size += lp_packet->ack_count * encoder_probe_block_size(TLV_LpAck, LP_SEQUENCE_SIZE);
+  if (lp_packet->enable_TxSequence)
+    value_size += encoder_probe_block_size(TLV_LpTxSequence, LP_SEQUENCE_SIZE);
+  if (lp_packet->fragment != NULL)
+    value_size += encoder_probe_block_size(TLV_LpFragment, lp_packet->fragment_size);
+  return value_size;
+}
+
+uint32_t
+ndn_lp_packet_probe_block_size(const ndn_lp_packet_t* lp_packet)
+{
+  return encoder_probe_block_size(TLV_LpPacket, lp_probe_value_size(lp_packet));
+}
+
+int
+ndn_lp_packet_tlv_encode(ndn_encoder_t* encoder, const ndn_lp_packet_t* lp_packet)
+{
+  int ret_val = 0;
+  uint32_t cursor = 0;
+  uint64_t ack = 0;
+  uint32_t value_size = lp_probe_value_size(lp_packet);
+  if (encoder->offset + encoder_probe_block_size(TLV_LpPacket, value_size) > encoder->output_max_size) {
+    return NDN_OVERSIZE;
+  }
+
+  ret_val = encoder_append_type(encoder, TLV_LpPacket);
+  if (ret_val != NDN_SUCCESS) return ret_val;
+  ret_val = encoder_append_length(encoder, value_size);
+  if (ret_val != NDN_SUCCESS) return ret_val;
+
+  // header fields in the order of their types, then the fragment
+  if (lp_packet->enable_Sequence) {
+    ret_val = lp_append_sequence_field(encoder, TLV_LpSequence, lp_packet->sequence);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+  }
+  if (lp_packet->enable_FragIndex) {
+    ret_val = lp_append_uint_field(encoder, TLV_LpFragIndex, lp_packet->frag_index);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+  }
+  if (lp_packet->enable_FragCount) {
+    ret_val = lp_append_uint_field(encoder, TLV_LpFragCount, lp_packet->frag_count);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+  }
+  if (lp_packet->enable_Nack) {
+    ret_val = encoder_append_type(encoder, TLV_LpNack);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+    ret_val = encoder_append_length(encoder, lp_probe_nack_value_size(lp_packet));
+    if (ret_val != NDN_SUCCESS) return ret_val;
+    if (lp_packet->nack_reason != NDN_LP_NACK_REASON_NONE) {
+      ret_val = lp_append_uint_field(encoder, TLV_LpNackReason, lp_packet->nack_reason);
+      if (ret_val != NDN_SUCCESS) return ret_val;
+    }
+  }
+  if (lp_packet->enable_IncomingFaceId) {
+    ret_val = lp_append_uint_field(encoder, TLV_LpIncomingFaceId, lp_packet->incoming_face_id);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+  }
+  if (lp_packet->enable_CongestionMark) {
+    ret_val = lp_append_uint_field(encoder, TLV_LpCongestionMark, lp_packet->congestion_mark);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+  }
+  while (ndn_lp_packet_next_ack(lp_packet, &cursor, &ack)) {
+    ret_val = lp_append_sequence_field(encoder, TLV_LpAck, ack);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+  }
+  if (lp_packet->enable_TxSequence) {
+    ret_val = lp_append_sequence_field(encoder, TLV_LpTxSequence, lp_packet->tx_sequence);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+  }
+  if (lp_packet->fragment != NULL) {
+    ret_val = encoder_append_type(encoder, TLV_LpFragment);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+    ret_val = encoder_append_length(encoder, lp_packet->fragment_size);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+    ret_val = encoder_append_raw_buffer_value(encoder, lp_packet->fragment, lp_packet->fragment_size);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+  }
+  return 0;
+}
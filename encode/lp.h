@@ -0,0 +1,207 @@
+/*
+ * Copyright (C) 2019 Xinyu Ma, Zhiyi Zhang
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#ifndef NDN_ENCODING_LP_H
+#define NDN_ENCODING_LP_H
+
+#include <stdbool.h>
+#include "tlv.h"
+#include "encoder.h"
+#include "decoder.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Nack reasons of NDNLPv2.
+ * A smaller value is less severe.
+ */
+enum {
+  NDN_LP_NACK_REASON_NONE = 0,
+  NDN_LP_NACK_REASON_CONGESTION = 50,
+  NDN_LP_NACK_REASON_DUPLICATE = 100,
+  NDN_LP_NACK_REASON_NO_ROUTE = 150,
+};
+
+/**
+ * The structure to represent an NDNLPv2 LpPacket.
+ * The fragment is not copied: after decoding, it points into the decoded buffer.
+ */
+typedef struct ndn_lp_packet {
+  /**
+   * The fragment, i.e. a network layer packet or a part of it. NULL for an IDLE packet.
+   */
+  const uint8_t* fragment;
+  /**
+   * The size of the fragment.
+   */
+  uint32_t fragment_size;
+  /**
+   * The sequence number of the fragment.
+   */
+  uint64_t sequence;
+  /**
+   * The index of the fragment in the network layer packet.
+   */
+  uint32_t frag_index;
+  /**
+   * The number of fragments of the network layer packet.
+   */
+  uint32_t frag_count;
+  /**
+   * The Nack reason. The fragment is a Nacked Interest if @c enable_Nack is set.
+   */
+  uint8_t nack_reason;
+  /**
+   * The ID of the face a packet is received from, told to a local application.
+   */
+  uint64_t incoming_face_id;
+  /**
+   * The congestion mark. 0 means no congestion.
+   */
+  uint64_t congestion_mark;
+  /**
+   * The acknowledged TxSequences to encode. NULL after decoding: read them with ndn_lp_packet_next_ack().
+   */
+  const uint64_t* acks;
+  /**
+   * The decoded Ack fields, which are consecutive in the wire format. It points into the decoded buffer.
+   */
+  const uint8_t* ack_fields;
+  /**
+   * The size of @c ack_fields.
+   */
+  uint32_t ack_fields_size;
+  /**
+   * The number of Ack fields. Ack is the only repeatable header field.
+   */
+  uint32_t ack_count;
+  /**
+   * The transmission sequence number of the LpPacket.
+   */
+  uint64_t tx_sequence;
+
+  uint8_t enable_Sequence;
+  uint8_t enable_FragIndex;
+  uint8_t enable_FragCount;
+  uint8_t enable_Nack;
+  uint8_t enable_IncomingFaceId;
+  uint8_t enable_CongestionMark;
+  uint8_t enable_TxSequence;
+} ndn_lp_packet_t;
+
+/**
+ * Init an LpPacket carrying a fragment without any header field.
+ * @param lp_packet. Output. The LpPacket to be inited.
+ * @param fragment. Input. The fragment. May be NULL for an IDLE packet.
+ * @param fragment_size. Input. The size of the fragment.
+ */
+static inline void
+ndn_lp_packet_init(ndn_lp_packet_t* lp_packet, const uint8_t* fragment, uint32_t fragment_size)
+{
+  memset(lp_packet, 0, sizeof(ndn_lp_packet_t));
+  lp_packet->fragment = fragment;
+  lp_packet->fragment_size = fragment_size;
+}
+
+/**
+ * Set the Nack header of an LpPacket.
+ * @param lp_packet. Output. The LpPacket whose fragment is the Nacked Interest.
+ * @param reason. Input. The Nack reason.
+ */
+static inline void
+ndn_lp_packet_set_nack(ndn_lp_packet_t* lp_packet, uint8_t reason)
+{
+  lp_packet->enable_Nack = 1;
+  lp_packet->nack_reason = reason;
+}
+
+/**
+ * Set the CongestionMark header of an LpPacket.
+ * @param lp_packet. Output. The LpPacket whose CongestionMark will be set.
+ * @param congestion_mark. Input. The congestion mark.
+ */
+static inline void
+ndn_lp_packet_set_congestion_mark(ndn_lp_packet_t* lp_packet, uint64_t congestion_mark)
+{
+  lp_packet->enable_CongestionMark = 1;
+  lp_packet->congestion_mark = congestion_mark;
+}
+
+/**
+ * Set the IncomingFaceId header of an LpPacket.
+ * @param lp_packet. Output. The LpPacket whose IncomingFaceId will be set.
+ * @param face_id. Input. The face ID.
+ */
+static inline void
+ndn_lp_packet_set_incoming_face_id(ndn_lp_packet_t* lp_packet, uint64_t face_id)
+{
+  lp_packet->enable_IncomingFaceId = 1;
+  lp_packet->incoming_face_id = face_id;
+}
+
+/**
+ * Set the Ack fields of an LpPacket.
+ * @param lp_packet. Output. The LpPacket whose Ack fields will be set.
+ * @param acks. Input. The acknowledged TxSequences. It must outlive @c lp_packet.
+ * @param ack_count. Input. The number of @c acks. 0 to remove the Ack fields.
+ */
+static inline void
+ndn_lp_packet_set_acks(ndn_lp_packet_t* lp_packet, const uint64_t* acks, uint32_t ack_count)
+{
+  lp_packet->acks = acks;
+  lp_packet->ack_fields = NULL;
+  lp_packet->ack_fields_size = 0;
+  lp_packet->ack_count = ack_count;
+}
+
+/**
+ * Read the next acknowledged TxSequence of an LpPacket, either set or decoded.
+ * @param lp_packet. Input. The LpPacket.
+ * @param cursor. Input/Output. The position of the next Ack. Set it to 0 to read the first one.
+ * @param ack. Output. The acknowledged TxSequence.
+ * @return true if an Ack is read, false if there is no more.
+ */
+bool
+ndn_lp_packet_next_ack(const ndn_lp_packet_t* lp_packet, uint32_t* cursor, uint64_t* ack);
+
+/**
+ * Decode a wire format packet into an LpPacket.
+ * A bare Interest or Data is accepted as an LpPacket with no header field.
+ * Unknown header fields are skipped when NDNLPv2 allows it, otherwise the packet is rejected.
+ * @param lp_packet. Output. The LpPacket decoded.
+ * @param block_value. Input. The wire format packet buffer. It must outlive @c lp_packet.
+ * @param block_size. Input. The size of the wire format packet buffer.
+ * @return 0 if decoding is successful.
+ */
+int
+ndn_lp_packet_from_block(ndn_lp_packet_t* lp_packet, const uint8_t* block_value, uint32_t block_size);
+
+/**
+ * Probe the size of the LpPacket TLV block before encoding it.
+ * @param lp_packet. Input. The LpPacket to probe.
+ * @return the length of the LpPacket TLV block.
+ */
+uint32_t
+ndn_lp_packet_probe_block_size(const ndn_lp_packet_t* lp_packet);
+
+/**
+ * Encode an LpPacket into wire format (TLV block).
+ * @param encoder. Output. The encoder who keeps the encoding result and the state.
+ * @param lp_packet. Input. The LpPacket to be encoded.
+ * @return 0 if there is no error.
+ */
+int
+ndn_lp_packet_tlv_encode(ndn_encoder_t* encoder, const ndn_lp_packet_t* lp_packet);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NDN_ENCODING_LP_H
@@ -141,6 +141,48 @@ name_component_probe_block_size(const name_component_t* component)
   return encoder_probe_block_size(component->type, component->size);
 }
 
+/**
+ * The initial value of a name hash, i.e. the hash of an empty name.
+ */
+#define NDN_NAME_HASH_SEED 2166136261u
+
+/**
+ * The odd multipliers of the name hash mixer.
+ */
+#define NDN_NAME_HASH_M1 0x9E3779B97F4A7C15ull
+#define NDN_NAME_HASH_M2 0xD6E8FEB86659FD93ull
+
+/**
+ * Fold a name component into an accumulated name hash.
+ * The value is consumed 8 bytes per multiply-xorshift round rather than one byte at a time.
+ * The hash covers the component type, length and value, so it gives the same result
+ * whether the component comes from a name_component_t or directly from the wire.
+ * It is not cryptographic, and is meant for hash tables only.
+ * @param seed. Input. The hash of the name before this component.
+ * @param type. Input. The component type.
+ * @param value. Input. The component value.
+ * @param size. Input. The size of the component value.
+ * @return the hash of the name after appending this component.
+ */
+static inline uint32_t
+name_component_hash_append(uint32_t seed, uint32_t type, const uint8_t* value, uint32_t size)
+{
+  uint64_t hash = (((uint64_t)type << 32) | size) ^ ((uint64_t)seed * NDN_NAME_HASH_M2);
+  uint64_t word = 0;
+  hash = (hash ^ (hash >> 32)) * NDN_NAME_HASH_M1;
+  for (; size >= 8; size -= 8, value += 8) {
+    memcpy(&word, value, 8);
+    hash = (hash ^ (hash >> 32) ^ word) * NDN_NAME_HASH_M1;
+  }
+  if (size > 0) {
+    word = 0;
+    memcpy(&word, value, size);
+    hash = (hash ^ (hash >> 32) ^ word) * NDN_NAME_HASH_M1;
+  }
+  hash = (hash ^ (hash >> 29)) * NDN_NAME_HASH_M2;
+  return (uint32_t)(hash >> 32);
+}
+
 /**
  * Encode the Name Component structure into wire format (TLV block).
  * @param encoder. Output. The encoder who keeps the encoding result and the state.
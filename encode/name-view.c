@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2019 Xinyu Ma
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include "name-view.h"
+
+int
+ndn_name_view_tlv_decode(ndn_decoder_t* decoder, ndn_name_view_t* view)
+{
+  int ret_val = -1;
+
+  uint32_t type = 0;
+  ret_val = decoder_get_type(decoder, &type);
+  if (ret_val != NDN_SUCCESS) return ret_val;
+  if (type != TLV_Name) {
+    return NDN_WRONG_TLV_TYPE;
+  }
+  uint32_t length = 0;
+  ret_val = decoder_get_length(decoder, &length);
+  if (ret_val != NDN_SUCCESS) return ret_val;
+  if (length > decoder->input_size - decoder->offset || length > UINT16_MAX) {
+    return NDN_OVERSIZE;
+  }
+
+  ndn_decoder_t value_decoder;
+  decoder_init(&value_decoder, decoder->input_value + decoder->offset, length);
+  view->value = value_decoder.input_value;
+  view->prefix_hashes[0] = NDN_NAME_HASH_SEED;
+  uint32_t counter = 0;
+  while (value_decoder.offset < length) {
+    if (counter >= NDN_NAME_VIEW_COMPONENTS_SIZE)
+      return NDN_OVERSIZE;
+    view->offsets[counter] = (uint16_t)value_decoder.offset;
+    uint32_t comp_type = 0, comp_size = 0;
+    ret_val = decoder_get_type(&value_decoder, &comp_type);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+    if (!(comp_type == TLV_GenericNameComponent
+          || comp_type == TLV_ImplicitSha256DigestComponent
+          || comp_type == TLV_ParametersSha256DigestComponent
+          || comp_type == TLV_SignedInterestSha256DigestComponent)) {
+      return NDN_WRONG_TLV_TYPE;
+    }
+    ret_val = decoder_get_length(&value_decoder, &comp_size);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+    if (value_decoder.offset - view->offsets[counter]
+        != encoder_get_var_size(comp_type) + encoder_get_var_size(comp_size)) {
+      return NDN_WRONG_TLV_LENGTH;
+    }
+    const uint8_t* comp_value = value_decoder.input_value + value_decoder.offset;
+    ret_val = decoder_move_forward(&value_decoder, comp_size);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+    view->prefix_hashes[counter + 1] = name_component_hash_append(view->prefix_hashes[counter],
+                                                                  comp_type, comp_value, comp_size);
+    ++counter;
+  }
+  view->offsets[counter] = (uint16_t)length;
+  view->components_size = counter;
+  decoder->offset += length;
+  return 0;
+}
+
+int
+ndn_name_view_from_block(ndn_name_view_t* view, const uint8_t* block_value, uint32_t block_size)
+{
+  ndn_decoder_t decoder;
+  decoder_init(&decoder, block_value, block_size);
+  return ndn_name_view_tlv_decode(&decoder, view);
+}
+
+void
+ndn_name_view_get_component(const ndn_name_view_t* view, uint32_t index,
+                            uint32_t* type, const uint8_t** value, uint32_t* size)
+{
+  // the components were checked when the view was decoded
+  ndn_decoder_t decoder;
+  decoder_init(&decoder, view->value + view->offsets[index],
+               view->offsets[index + 1] - view->offsets[index]);
+  decoder_get_type(&decoder, type);
+  decoder_get_length(&decoder, size);
+  *value = decoder.input_value + decoder.offset;
+}
+
+ndn_packed_name_t*
+ndn_name_view_to_packed(const ndn_name_view_t* view, void* buffer, uint32_t size)
+{
+  if (ndn_name_view_packed_size(view) > size) {
+    return NULL;
+  }
+  ndn_packed_name_t* packed = (ndn_packed_name_t*)buffer;
+  packed->size = view->offsets[view->components_size];
+  packed->components_size = (uint16_t)view->components_size;
+  memcpy(packed->offsets, view->offsets, sizeof(uint16_t) * (view->components_size + 1));
+  memcpy((uint8_t*)ndn_packed_name_value(packed), view->value, packed->size);
+  return packed;
+}
+
+int
+ndn_name_view_to_name(const ndn_name_view_t* view, ndn_name_t* name)
+{
+  uint32_t size = 0;
+  const uint8_t* value = NULL;
+  if (view->components_size > NDN_NAME_COMPONENTS_SIZE) {
+    return NDN_OVERSIZE;
+  }
+  for (uint32_t i = 0; i < view->components_size; i++) {
+    ndn_name_view_get_component(view, i, &name->components[i].type, &value, &size);
+    if (size > NDN_NAME_COMPONENT_BUFFER_SIZE) {
+      return NDN_OVERSIZE;
+    }
+    memcpy(name->components[i].value, value, size);
+    name->components[i].size = size;
+  }
+  name->components_size = view->components_size;
+  return 0;
+}
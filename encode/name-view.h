@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2019 Xinyu Ma
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#ifndef NDN_ENCODING_NAME_VIEW_H
+#define NDN_ENCODING_NAME_VIEW_H
+
+#include "packed-name.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A Name read in place from a wire format packet.
+ * Unlike ndn_name_t, a view copies no component: it keeps where each component starts in
+ * the packet, and the hashes of all prefixes computed while parsing. It is only valid while
+ * the packet buffer is. A view can be copied into a packed name with ndn_name_view_to_packed(),
+ * or into an ndn_name_t with ndn_name_view_to_name().
+ * A view holds up to NDN_NAME_VIEW_COMPONENTS_SIZE components of any size.
+ */
+typedef struct ndn_name_view {
+  /**
+   * The TLV-VALUE of the Name in the packet.
+   */
+  const uint8_t* value;
+  /**
+   * The number of name components.
+   */
+  uint32_t components_size;
+  /**
+   * The offset of each component TLV from @c value. @c offsets[components_size] is
+   * the size of @c value.
+   */
+  uint16_t offsets[NDN_NAME_VIEW_COMPONENTS_SIZE + 1];
+  /**
+   * @c prefix_hashes[i] is the hash of the first @c i components, as ndn_name_prefix_hashes().
+   */
+  uint32_t prefix_hashes[NDN_NAME_VIEW_COMPONENTS_SIZE + 1];
+} ndn_name_view_t;
+
+/**
+ * Read a Name from its wire format block, without copying.
+ * Types and lengths must be encoded in the shortest form, as NDN requires.
+ * @param view. Output. The view.
+ * @param block_value. Input. The Name TLV block. It must outlive @c view.
+ * @param block_size. Input. The size of @c block_value.
+ * @return 0 if there is no error.
+ */
+int
+ndn_name_view_from_block(ndn_name_view_t* view, const uint8_t* block_value, uint32_t block_size);
+
+/**
+ * Read a Name TLV block from a decoder, without copying.
+ * @param decoder. Input/Output. The decoder, left right after the Name.
+ * @param view. Output. The view.
+ * @return 0 if there is no error. NDN_OVERSIZE if the Name has more than
+ *         NDN_NAME_VIEW_COMPONENTS_SIZE components.
+ */
+int
+ndn_name_view_tlv_decode(ndn_decoder_t* decoder, ndn_name_view_t* view);
+
+/**
+ * Get the hash of a Name view, equal to ndn_name_hash() of the same Name.
+ * @param view. Input. The view.
+ */
+static inline uint32_t
+ndn_name_view_hash(const ndn_name_view_t* view)
+{
+  return view->prefix_hashes[view->components_size];
+}
+
+/**
+ * Get a component of a Name view.
+ * @param view. Input. The view.
+ * @param index. Input. The index of the component, smaller than @c components_size.
+ * @param type. Output. The component type.
+ * @param value. Output. The component value, in the packet.
+ * @param size. Output. The size of the component value.
+ */
+void
+ndn_name_view_get_component(const ndn_name_view_t* view, uint32_t index,
+                            uint32_t* type, const uint8_t** value, uint32_t* size);
+
+/**
+ * Check whether the first @c length components of a Name view make exactly a packed name.
+ * @param view. Input. The view.
+ * @param length. Input. The number of components to compare, up to @c components_size.
+ * @param name. Input. The packed name.
+ * @return true if they are equal.
+ */
+static inline bool
+ndn_name_view_prefix_equals(const ndn_name_view_t* view, uint32_t length, const ndn_packed_name_t* name)
+{
+  // both are encoded in the shortest form, so equal names have equal bytes
+  return name->components_size == length && name->size == view->offsets[length]
+         && memcmp(view->value, ndn_packed_name_value(name), name->size) == 0;
+}
+
+/**
+ * Check whether a Name view equals a packed name.
+ * @param view. Input. The view.
+ * @param name. Input. The packed name.
+ * @return true if they are equal.
+ */
+static inline bool
+ndn_name_view_equals(const ndn_name_view_t* view, const ndn_packed_name_t* name)
+{
+  return ndn_name_view_prefix_equals(view, view->components_size, name);
+}
+
+/**
+ * Check whether a Name view is a prefix of a packed name.
+ * @param view. Input. The view.
+ * @param name. Input. The packed name.
+ * @return true if every component of @c view starts @c name.
+ */
+static inline bool
+ndn_name_view_is_prefix_of(const ndn_name_view_t* view, const ndn_packed_name_t* name)
+{
+  uint32_t size = view->offsets[view->components_size];
+  return view->components_size <= name->components_size
+         && name->offsets[view->components_size] == size
+         && memcmp(view->value, ndn_packed_name_value(name), size) == 0;
+}
+
+/**
+ * Get the memory a Name view takes once packed.
+ * @param view. Input. The view.
+ */
+static inline uint32_t
+ndn_name_view_packed_size(const ndn_name_view_t* view)
+{
+  return NDN_PACKED_NAME_SIZE(view->components_size, view->offsets[view->components_size]);
+}
+
+/**
+ * Copy the Name a view refers to into a packed name.
+ * @param view. Input. The view.
+ * @param buffer. Output. The memory to keep the packed name, aligned to 2 bytes.
+ * @param size. Input. The size of @c buffer, at least ndn_name_view_packed_size().
+ * @return The packed name. NULL if @c buffer is too small.
+ */
+ndn_packed_name_t*
+ndn_name_view_to_packed(const ndn_name_view_t* view, void* buffer, uint32_t size);
+
+/**
+ * Copy the Name a view refers to into a Name structure.
+ * @param view. Input. The view.
+ * @param name. Output. The Name.
+ * @return 0 if there is no error. NDN_OVERSIZE if the name exceeds the limits of ndn_name_t.
+ */
+int
+ndn_name_view_to_name(const ndn_name_view_t* view, ndn_name_t* name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NDN_ENCODING_NAME_VIEW_H
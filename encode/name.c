@@ -22,6 +22,12 @@ ndn_name_init(ndn_name_t *name, const name_component_t* components, uint32_t siz
 
 int
 ndn_name_tlv_decode(ndn_decoder_t* decoder, ndn_name_t* name)
+{
+  return ndn_name_tlv_decode_with_hashes(decoder, name, NULL);
+}
+
+int
+ndn_name_tlv_decode_with_hashes(ndn_decoder_t* decoder, ndn_name_t* name, uint32_t* hashes)
 {
 
   int ret_val = -1;
@@ -37,12 +43,18 @@ ndn_name_tlv_decode(ndn_decoder_t* decoder, ndn_name_t* name)
   if (ret_val != NDN_SUCCESS) return ret_val;
   uint32_t start_offset = decoder->offset;
   int counter = 0;
+  if (hashes != NULL)
+    hashes[0] = NDN_NAME_HASH_SEED;
   while (decoder->offset < start_offset + length) {
     if (counter >= NDN_NAME_COMPONENTS_SIZE)
       return NDN_OVERSIZE;
-    int result = name_component_tlv_decode(decoder, &name->components[counter]);
+    name_component_t* component = &name->components[counter];
+    int result = name_component_tlv_decode(decoder, component);
     if (result < 0)
       return result;
+    if (hashes != NULL)
+      hashes[counter + 1] = name_component_hash_append(hashes[counter], component->type,
+                                                       component->value, component->size);
     ++counter;
   }
   name->components_size = counter;
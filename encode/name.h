@@ -49,6 +49,19 @@ ndn_name_init(ndn_name_t *name, const name_component_t* components, uint32_t siz
 int
 ndn_name_tlv_decode(ndn_decoder_t* decoder, ndn_name_t* name);
 
+/**
+ * Decode the Name TLV, computing the hashes of all its prefixes in the same pass.
+ * This saves walking the components again with ndn_name_prefix_hashes() when the Name
+ * is looked up in several tables.
+ * @param decoder. Input. The decoder who keeps the decoding result and the state.
+ * @param name. Output. The Name decoded from TLV block.
+ * @param hashes. Output. The array of at least <tt> NDN_NAME_COMPONENTS_SIZE + 1 </tt> hashes,
+ *        filled as ndn_name_prefix_hashes() does. May be NULL.
+ * @return 0 if there is no error.
+ */
+int
+ndn_name_tlv_decode_with_hashes(ndn_decoder_t* decoder, ndn_name_t* name, uint32_t* hashes);
+
 /**
  * Decode an Name TLV block into an Name. This function will do memory copy.
  * @param name. Output. The Name to which the TLV block will be decoded.
@@ -124,6 +137,41 @@ ndn_name_compare(const ndn_name_t* lhs, const ndn_name_t* rhs);
 int
 ndn_name_is_prefix_of(const ndn_name_t* lhs, const ndn_name_t* rhs);
 
+/**
+ * Compute the hash of a Name.
+ * Names that compare equal with ndn_name_compare() always have the same hash.
+ * @param name. Input. The Name to be hashed.
+ * @return the 32-bit hash of the Name.
+ */
+static inline uint32_t
+ndn_name_hash(const ndn_name_t* name)
+{
+  uint32_t hash = NDN_NAME_HASH_SEED;
+  for (uint32_t i = 0; i < name->components_size; i++) {
+    hash = name_component_hash_append(hash, name->components[i].type,
+                                      name->components[i].value, name->components[i].size);
+  }
+  return hash;
+}
+
+/**
+ * Compute the hashes of all prefixes of a Name in one pass.
+ * @c hashes[i] is the hash of the first @c i components, so @c hashes[0] is the hash of
+ * the empty name and @c hashes[components_size] equals ndn_name_hash().
+ * @param name. Input. The Name to be hashed.
+ * @param hashes. Output. The array of at least <tt> components_size + 1 </tt> hashes.
+ */
+static inline void
+ndn_name_prefix_hashes(const ndn_name_t* name, uint32_t* hashes)
+{
+  hashes[0] = NDN_NAME_HASH_SEED;
+  for (uint32_t i = 0; i < name->components_size; i++) {
+    hashes[i + 1] = name_component_hash_append(hashes[i], name->components[i].type,
+                                               name->components[i].value,
+                                               name->components[i].size);
+  }
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,315 @@
+/*
+ * Copyright (C) 2019 Xinyu Ma
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include "packed-name.h"
+
+#define NAME_ARENA_NIL ((uint32_t)-1)
+
+ndn_packed_name_t*
+ndn_packed_name_from_name(const ndn_name_t* name, void* buffer, uint32_t size)
+{
+  uint32_t value_size = 0;
+  for (uint32_t i = 0; i < name->components_size; i++) {
+    value_size += name_component_probe_block_size(&name->components[i]);
+  }
+  if (NDN_PACKED_NAME_SIZE(name->components_size, value_size) > size || value_size > UINT16_MAX) {
+    return NULL;
+  }
+
+  ndn_packed_name_t* packed = (ndn_packed_name_t*)buffer;
+  packed->size = (uint16_t)value_size;
+  packed->components_size = (uint16_t)name->components_size;
+  ndn_encoder_t encoder;
+  encoder_init(&encoder, (uint8_t*)ndn_packed_name_value(packed), value_size);
+  for (uint32_t i = 0; i < name->components_size; i++) {
+    packed->offsets[i] = (uint16_t)encoder.offset;
+    name_component_tlv_encode(&encoder, &name->components[i]);
+  }
+  packed->offsets[name->components_size] = (uint16_t)value_size;
+  return packed;
+}
+
+void
+ndn_packed_name_get_component(const ndn_packed_name_t* name, uint32_t index,
+                              uint32_t* type, const uint8_t** value, uint32_t* size)
+{
+  ndn_decoder_t decoder;
+  decoder_init(&decoder, ndn_packed_name_value(name) + name->offsets[index],
+               name->offsets[index + 1] - name->offsets[index]);
+  decoder_get_type(&decoder, type);
+  decoder_get_length(&decoder, size);
+  *value = decoder.input_value + decoder.offset;
+}
+
+int
+ndn_packed_name_to_name(const ndn_packed_name_t* packed, ndn_name_t* name)
+{
+  uint32_t size = 0;
+  const uint8_t* value = NULL;
+  if (packed->components_size > NDN_NAME_COMPONENTS_SIZE) {
+    return NDN_OVERSIZE;
+  }
+  for (uint32_t i = 0; i < packed->components_size; i++) {
+    ndn_packed_name_get_component(packed, i, &name->components[i].type, &value, &size);
+    if (size > NDN_NAME_COMPONENT_BUFFER_SIZE) {
+      return NDN_OVERSIZE;
+    }
+    memcpy(name->components[i].value, value, size);
+    name->components[i].size = size;
+  }
+  name->components_size = packed->components_size;
+  return 0;
+}
+
+int
+ndn_packed_name_tlv_encode(ndn_encoder_t* encoder, const ndn_packed_name_t* name)
+{
+  int ret_val = -1;
+
+  ret_val = encoder_append_type(encoder, TLV_Name);
+  if (ret_val != NDN_SUCCESS) return ret_val;
+  ret_val = encoder_append_length(encoder, name->size);
+  if (ret_val != NDN_SUCCESS) return ret_val;
+  return encoder_append_raw_buffer_value(encoder, ndn_packed_name_value(name), name->size);
+}
+
+int
+ndn_packed_name_compare(const ndn_packed_name_t* lhs, const ndn_packed_name_t* rhs)
+{
+  // components are encoded in the shortest form, so equal names have equal bytes
+  if (lhs->size != rhs->size || lhs->components_size != rhs->components_size) return -1;
+  if (memcmp(ndn_packed_name_value(lhs), ndn_packed_name_value(rhs), lhs->size) != 0) return -1;
+  return 0;
+}
+
+int
+ndn_packed_name_is_prefix_of(const ndn_packed_name_t* lhs, const ndn_packed_name_t* rhs)
+{
+  if (lhs->components_size > rhs->components_size
+      || rhs->offsets[lhs->components_size] != lhs->size) {
+    return 1;
+  }
+  if (memcmp(ndn_packed_name_value(lhs), ndn_packed_name_value(rhs), lhs->size) != 0) return 1;
+  return 0;
+}
+
+uint32_t
+ndn_packed_name_hash(const ndn_packed_name_t* name)
+{
+  uint32_t hash = NDN_NAME_HASH_SEED;
+  uint32_t type = 0, size = 0;
+  const uint8_t* value = NULL;
+  for (uint32_t i = 0; i < name->components_size; i++) {
+    ndn_packed_name_get_component(name, i, &type, &value, &size);
+    hash = name_component_hash_append(hash, type, value, size);
+  }
+  return hash;
+}
+
+/************************************************************/
+/*  Definition of name arena                                */
+/************************************************************/
+
+#define NAME_ARENA_UNIT 16u
+
+// A free block starts with the links of its free list and its size class
+typedef struct name_arena_free_block {
+  uint32_t next;
+  uint32_t prev;
+  uint32_t k;
+} name_arena_free_block_t;
+
+// The smallest block size class holding size bytes
+static inline uint32_t
+name_arena_class(uint32_t size)
+{
+  uint32_t k = 0;
+  while ((NAME_ARENA_UNIT << k) < size) {
+    k ++;
+  }
+  return k;
+}
+
+static inline name_arena_free_block_t*
+name_arena_block(const ndn_name_arena_t* arena, uint32_t offset)
+{
+  return (name_arena_free_block_t*)(arena->memory + offset);
+}
+
+static inline bool
+name_arena_is_free(const ndn_name_arena_t* arena, uint32_t offset)
+{
+  uint32_t unit = offset / NAME_ARENA_UNIT;
+  return (arena->free_map[unit / 32] >> (unit % 32)) & 1;
+}
+
+static inline void
+name_arena_mark(ndn_name_arena_t* arena, uint32_t offset, bool is_free)
+{
+  uint32_t unit = offset / NAME_ARENA_UNIT;
+  if (is_free)
+    arena->free_map[unit / 32] |= 1u << (unit % 32);
+  else
+    arena->free_map[unit / 32] &= ~(1u << (unit % 32));
+}
+
+static void
+name_arena_push(ndn_name_arena_t* arena, uint32_t k, uint32_t offset)
+{
+  name_arena_free_block_t* block = name_arena_block(arena, offset);
+  block->next = arena->free_heads[k];
+  block->prev = NAME_ARENA_NIL;
+  block->k = k;
+  if (block->next != NAME_ARENA_NIL)
+    name_arena_block(arena, block->next)->prev = offset;
+  arena->free_heads[k] = offset;
+  name_arena_mark(arena, offset, true);
+}
+
+static void
+name_arena_unlink(ndn_name_arena_t* arena, uint32_t offset)
+{
+  name_arena_free_block_t* block = name_arena_block(arena, offset);
+  if (block->prev != NAME_ARENA_NIL)
+    name_arena_block(arena, block->prev)->next = block->next;
+  else
+    arena->free_heads[block->k] = block->next;
+  if (block->next != NAME_ARENA_NIL)
+    name_arena_block(arena, block->next)->prev = block->prev;
+  name_arena_mark(arena, offset, false);
+}
+
+// The class of the block starting at offset when an empty arena is cut into blocks
+static uint32_t
+name_arena_initial_class(const ndn_name_arena_t* arena, uint32_t offset)
+{
+  uint32_t k = NDN_NAME_ARENA_CLASSES - 1;
+  while (offset % (NAME_ARENA_UNIT << k) != 0 || offset + (NAME_ARENA_UNIT << k) > arena->size) {
+    k --;
+  }
+  return k;
+}
+
+// Return a block of class k at offset, merging it with its free buddies
+static void
+name_arena_release_block(ndn_name_arena_t* arena, uint32_t k, uint32_t offset)
+{
+  while (k + 1 < NDN_NAME_ARENA_CLASSES) {
+    uint32_t buddy = offset ^ (NAME_ARENA_UNIT << k);
+    if (buddy + (NAME_ARENA_UNIT << k) > arena->size || !name_arena_is_free(arena, buddy)
+        || name_arena_block(arena, buddy)->k != k) {
+      break;
+    }
+    name_arena_unlink(arena, buddy);
+    if (buddy < offset)
+      offset = buddy;
+    k ++;
+  }
+  name_arena_push(arena, k, offset);
+}
+
+void
+ndn_name_arena_init(ndn_name_arena_t* arena, void* memory, uint32_t bytes)
+{
+  arena->memory = (uint8_t*)memory;
+  arena->size = (bytes + NAME_ARENA_UNIT - 1) & ~(NAME_ARENA_UNIT - 1);
+  arena->free_map = (uint32_t*)(arena->memory + arena->size);
+  memset(arena->free_map, 0, sizeof(uint32_t) * ((bytes + 511) / 512));
+  for (uint32_t k = 0; k < NDN_NAME_ARENA_CLASSES; k++) {
+    arena->free_heads[k] = NAME_ARENA_NIL;
+  }
+
+  // cut the region into the largest blocks aligned to their size
+  uint32_t offset = 0;
+  while (offset < arena->size) {
+    uint32_t k = name_arena_initial_class(arena, offset);
+    name_arena_push(arena, k, offset);
+    offset += NAME_ARENA_UNIT << k;
+  }
+}
+
+void
+ndn_name_arena_plan_init(const ndn_name_arena_t* arena, uint32_t* free_counts)
+{
+  uint32_t offset = 0;
+  for (uint32_t k = 0; k < NDN_NAME_ARENA_CLASSES; k++) {
+    free_counts[k] = 0;
+  }
+  while (offset < arena->size) {
+    uint32_t k = name_arena_initial_class(arena, offset);
+    free_counts[k] ++;
+    offset += NAME_ARENA_UNIT << k;
+  }
+}
+
+bool
+ndn_name_arena_plan_alloc(uint32_t* free_counts, uint32_t size)
+{
+  if (size > NDN_NAME_ARENA_MAX_BLOCK) {
+    return false;
+  }
+  // the same choice as ndn_name_arena_alloc()
+  uint32_t k = name_arena_class(size);
+  uint32_t j = k;
+  while (j < NDN_NAME_ARENA_CLASSES && free_counts[j] == 0) {
+    j ++;
+  }
+  if (j == NDN_NAME_ARENA_CLASSES) {
+    return false;
+  }
+  free_counts[j] --;
+  while (j > k) {
+    j --;
+    free_counts[j] ++;
+  }
+  return true;
+}
+
+void*
+ndn_name_arena_alloc(ndn_name_arena_t* arena, uint32_t size)
+{
+  if (size > NDN_NAME_ARENA_MAX_BLOCK) {
+    return NULL;
+  }
+  uint32_t k = name_arena_class(size);
+
+  // take the smallest free block large enough
+  uint32_t j = k;
+  while (j < NDN_NAME_ARENA_CLASSES && arena->free_heads[j] == NAME_ARENA_NIL) {
+    j ++;
+  }
+  if (j == NDN_NAME_ARENA_CLASSES) {
+    return NULL;
+  }
+  uint32_t offset = arena->free_heads[j];
+  name_arena_unlink(arena, offset);
+
+  // split it, freeing its upper halves
+  while (j > k) {
+    j --;
+    name_arena_push(arena, j, offset + (NAME_ARENA_UNIT << j));
+  }
+  return arena->memory + offset;
+}
+
+void
+ndn_name_arena_free(ndn_name_arena_t* arena, void* block, uint32_t size)
+{
+  name_arena_release_block(arena, name_arena_class(size), (uint32_t)((uint8_t*)block - arena->memory));
+}
+
+ndn_packed_name_t*
+ndn_name_arena_copy(ndn_name_arena_t* arena, const ndn_packed_name_t* name)
+{
+  uint32_t size = ndn_packed_name_memory_size(name);
+  ndn_packed_name_t* copy = (ndn_packed_name_t*)ndn_name_arena_alloc(arena, size);
+  if (copy != NULL) {
+    memcpy(copy, name, size);
+  }
+  return copy;
+}
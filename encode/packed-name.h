@@ -0,0 +1,269 @@
+/*
+ * Copyright (C) 2019 Xinyu Ma
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#ifndef NDN_ENCODING_PACKED_NAME_H
+#define NDN_ENCODING_PACKED_NAME_H
+
+#include "name.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A Name packed into one contiguous block: the TLV-VALUE of the Name in wire format,
+ * preceded by its size, its number of components and the offset of each component.
+ * A packed name takes only the memory its components need, so tables keep a pointer to one
+ * instead of an ndn_name_t. It has no limit on the number and size of components other than
+ * the 16-bit offsets. Packed names are kept in caller buffers or allocated from an
+ * ndn_name_arena_t, and are never modified once made.
+ */
+typedef struct ndn_packed_name {
+  /**
+   * The size of the TLV-VALUE.
+   */
+  uint16_t size;
+  /**
+   * The number of name components.
+   */
+  uint16_t components_size;
+  /**
+   * The offset of each component TLV in the TLV-VALUE, and the TLV-VALUE size last.
+   * The TLV-VALUE follows.
+   */
+  uint16_t offsets[];
+} ndn_packed_name_t;
+
+/**
+ * The memory taken by a packed name.
+ * @param components_size Input. The number of name components.
+ * @param value_size Input. The size of the Name TLV-VALUE.
+ */
+#define NDN_PACKED_NAME_SIZE(components_size, value_size) \
+    (sizeof(ndn_packed_name_t) + sizeof(uint16_t) * ((components_size) + 1) + (value_size))
+
+/**
+ * The memory enough to pack any ndn_name_t.
+ */
+#define NDN_PACKED_NAME_BUFFER_SIZE \
+    NDN_PACKED_NAME_SIZE(NDN_NAME_COMPONENTS_SIZE, NDN_NAME_COMPONENTS_SIZE * NDN_NAME_COMPONENT_BLOCK_SIZE)
+
+/**
+ * Get the TLV-VALUE of a packed name.
+ * @param name. Input. The packed name.
+ */
+static inline const uint8_t*
+ndn_packed_name_value(const ndn_packed_name_t* name)
+{
+  return (const uint8_t*)&name->offsets[name->components_size + 1];
+}
+
+/**
+ * Get the memory taken by a packed name.
+ * @param name. Input. The packed name.
+ */
+static inline uint32_t
+ndn_packed_name_memory_size(const ndn_packed_name_t* name)
+{
+  return NDN_PACKED_NAME_SIZE(name->components_size, name->size);
+}
+
+/**
+ * Pack a Name.
+ * @param name. Input. The Name.
+ * @param buffer. Output. The memory to keep the packed name, aligned to 2 bytes.
+ * @param size. Input. The size of @c buffer, e.g. NDN_PACKED_NAME_BUFFER_SIZE.
+ * @return The packed name. NULL if @c buffer is too small.
+ */
+ndn_packed_name_t*
+ndn_packed_name_from_name(const ndn_name_t* name, void* buffer, uint32_t size);
+
+/**
+ * Unpack a packed name into a Name structure.
+ * @param packed. Input. The packed name.
+ * @param name. Output. The Name.
+ * @return 0 if there is no error. NDN_OVERSIZE if the name exceeds the limits of ndn_name_t.
+ */
+int
+ndn_packed_name_to_name(const ndn_packed_name_t* packed, ndn_name_t* name);
+
+/**
+ * Get a component of a packed name.
+ * @param name. Input. The packed name.
+ * @param index. Input. The index of the component, smaller than @c components_size.
+ * @param type. Output. The component type.
+ * @param value. Output. The component value.
+ * @param size. Output. The size of the component value.
+ */
+void
+ndn_packed_name_get_component(const ndn_packed_name_t* name, uint32_t index,
+                              uint32_t* type, const uint8_t** value, uint32_t* size);
+
+/**
+ * Probe the size of the Name TLV block of a packed name.
+ * @param name. Input. The packed name.
+ * @return the length of the expected Name TLV block.
+ */
+static inline uint32_t
+ndn_packed_name_probe_block_size(const ndn_packed_name_t* name)
+{
+  return encoder_probe_block_size(TLV_Name, name->size);
+}
+
+/**
+ * Encode a packed name into a Name TLV block.
+ * @param encoder. Output. The encoder to keep the encoded Name.
+ * @param name. Input. The packed name.
+ * @return 0 if there is no error.
+ */
+int
+ndn_packed_name_tlv_encode(ndn_encoder_t* encoder, const ndn_packed_name_t* name);
+
+/**
+ * Compare two packed names.
+ * @param lhs. Input. Left-hand-side packed name.
+ * @param rhs. Input. Right-hand-side packed name.
+ * @return 0 if @c lhs == @c rhs.
+ */
+int
+ndn_packed_name_compare(const ndn_packed_name_t* lhs, const ndn_packed_name_t* rhs);
+
+/**
+ * Check whether a packed name is a prefix of another.
+ * @param lhs. Input. Left-hand-side packed name.
+ * @param rhs. Input. Right-hand-side packed name.
+ * @return 0 if @c lhs is a prefix of @c rhs.
+ */
+int
+ndn_packed_name_is_prefix_of(const ndn_packed_name_t* lhs, const ndn_packed_name_t* rhs);
+
+/**
+ * Compute the hash of a packed name, equal to ndn_name_hash() of the same Name.
+ * @param name. Input. The packed name.
+ */
+uint32_t
+ndn_packed_name_hash(const ndn_packed_name_t* name);
+
+/**
+ * The number of block sizes of a name arena: 16, 32, ... bytes.
+ */
+#define NDN_NAME_ARENA_CLASSES 8
+
+/**
+ * The largest block of a name arena.
+ */
+#define NDN_NAME_ARENA_MAX_BLOCK (16u << (NDN_NAME_ARENA_CLASSES - 1))
+
+/**
+ * Arena of packed names.
+ * A buddy allocator over a caller-supplied region: blocks have power-of-2 sizes and are
+ * aligned to their size. A larger free block is split when no block of the requested size
+ * is left, and a released block merges back with its buddy when both are free, so the arena
+ * does not wear down into small blocks as names come and go.
+ */
+typedef struct ndn_name_arena {
+  /**
+   * The region blocks are carved from.
+   */
+  uint8_t* memory;
+  /**
+   * The size of @c memory, a multiple of 16 bytes.
+   */
+  uint32_t size;
+  /**
+   * One bit per 16 bytes of @c memory, set where a free block starts.
+   */
+  uint32_t* free_map;
+  /**
+   * The head of the free block list of each size. Free blocks keep the links of
+   * the list and their size class in their first bytes.
+   */
+  uint32_t free_heads[NDN_NAME_ARENA_CLASSES];
+} ndn_name_arena_t;
+
+/**
+ * The required memory to initialize a name arena.
+ * @param bytes Input. The number of bytes to keep packed names.
+ */
+#define NDN_NAME_ARENA_RESERVE_SIZE(bytes) \
+    ((((bytes) + 15) & ~(size_t)15) + sizeof(uint32_t) * (((bytes) + 511) / 512))
+
+/**
+ * Initialize an empty name arena.
+ * @pre NDN_NAME_ARENA_RESERVE_SIZE(bytes) bytes needed.
+ * @param arena. Output. The arena.
+ * @param memory. Input. The memory used to keep the packed names and the free map,
+ *        aligned to 4 bytes.
+ * @param bytes. Input. The number of bytes to keep packed names.
+ */
+void
+ndn_name_arena_init(ndn_name_arena_t* arena, void* memory, uint32_t bytes);
+
+/**
+ * Allocate a block from a name arena.
+ * @param arena. Input/Output. The arena.
+ * @param size. Input. The size of the block.
+ * @return The block. NULL if the arena is exhausted or @c size exceeds NDN_NAME_ARENA_MAX_BLOCK.
+ */
+void*
+ndn_name_arena_alloc(ndn_name_arena_t* arena, uint32_t size);
+
+/**
+ * Return a block to a name arena.
+ * @param arena. Input/Output. The arena.
+ * @param block. Input. The block obtained from ndn_name_arena_alloc().
+ * @param size. Input. The size it was allocated with.
+ */
+void
+ndn_name_arena_free(ndn_name_arena_t* arena, void* block, uint32_t size);
+
+/**
+ * Start planning allocations from a name arena as if it were emptied, without touching it,
+ * e.g. to check that a set of names fits before releasing the names it keeps.
+ * @param arena. Input. The arena.
+ * @param free_counts. Output. The number of free blocks of each size, NDN_NAME_ARENA_CLASSES
+ *        of them.
+ */
+void
+ndn_name_arena_plan_init(const ndn_name_arena_t* arena, uint32_t* free_counts);
+
+/**
+ * Plan an allocation started with ndn_name_arena_plan_init(). Allocations planned in a row
+ * succeed exactly when ndn_name_arena_alloc() would on the emptied arena.
+ * @param free_counts. Input/Output. The number of free blocks of each size.
+ * @param size. Input. The size of the block.
+ * @return true if the block can be allocated.
+ */
+bool
+ndn_name_arena_plan_alloc(uint32_t* free_counts, uint32_t size);
+
+/**
+ * Copy a packed name into a name arena.
+ * @param arena. Input/Output. The arena.
+ * @param name. Input. The packed name.
+ * @return The copy. NULL if the arena is exhausted.
+ */
+ndn_packed_name_t*
+ndn_name_arena_copy(ndn_name_arena_t* arena, const ndn_packed_name_t* name);
+
+/**
+ * Return a packed name to the name arena it was allocated from.
+ * @param arena. Input/Output. The arena.
+ * @param name. Input. The packed name.
+ */
+static inline void
+ndn_name_arena_release(ndn_name_arena_t* arena, ndn_packed_name_t* name)
+{
+  ndn_name_arena_free(arena, name, ndn_packed_name_memory_size(name));
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NDN_ENCODING_PACKED_NAME_H
@@ -65,6 +65,21 @@ enum {
   TLV_SignedInterestTimestamp = 61,
 };
 
+// NDNLPv2
+enum {
+  TLV_LpPacket = 100,
+  TLV_LpFragment = 80,
+  TLV_LpSequence = 81,
+  TLV_LpFragIndex = 82,
+  TLV_LpFragCount = 83,
+  TLV_LpNack = 800,
+  TLV_LpNackReason = 801,
+  TLV_LpIncomingFaceId = 812,
+  TLV_LpCongestionMark = 832,
+  TLV_LpAck = 836,
+  TLV_LpTxSequence = 840,
+};
+
 // App Support Specific
 enum {
   TLV_AC_KEY_TYPE = 128,
@@ -8,9 +8,18 @@
 
 #include "direct-face.h"
 #include "../forwarder/forwarder.h"
+#include "../encode/lp.h"
+#include <string.h>
 
 static ndn_direct_face_t direct_face;
 
+// Interest re-encoded from an expired name for the on_timeout callback
+static ndn_interest_t timeout_interest;
+static uint8_t timeout_buffer[NDN_NAME_MAX_BLOCK_SIZE + 32];
+
+void
+ndn_direct_face_on_interest_timeout(struct ndn_face_intf* self, const ndn_packed_name_t* name);
+
 /************************************************************/
 /*  Inherit Face Interfaces                                 */
 /************************************************************/
@@ -26,7 +35,7 @@ void
 ndn_direct_face_destroy(struct ndn_face_intf* self)
 {
   for (int i = 0; i < NDN_DIRECT_FACE_CB_ENTRY_SIZE; i++) {
-    direct_face.cb_entries[i].interest_name.components_size = NDN_FWD_INVALID_NAME_SIZE;
+    direct_face.cb_entries[i].interest_name = NULL;
   }
   self->state = NDN_FACE_STATE_DESTROYED;
   return;
@@ -40,7 +49,7 @@ ndn_direct_face_down(struct ndn_face_intf* self)
 }
 
 int
-ndn_direct_face_send(struct ndn_face_intf* self, const ndn_name_t* name,
+ndn_direct_face_send(struct ndn_face_intf* self, const ndn_packed_name_t* name,
                      const uint8_t* packet, uint32_t size)
 {
   (void)self;
@@ -51,6 +60,15 @@ ndn_direct_face_send(struct ndn_face_intf* self, const ndn_name_t* name,
 
   decoder_init(&decoder, packet, size);
   decoder_get_type(&decoder, &probe);
+  if (probe == TLV_LpPacket && bypass) {
+    // A Nack tells the application at once that the Interest cannot be satisfied
+    ndn_lp_packet_t lp_packet;
+    if (ndn_lp_packet_from_block(&lp_packet, packet, size) == 0 && lp_packet.enable_Nack) {
+      ndn_direct_face_on_interest_timeout(self, name);
+      return 0;
+    }
+    return 1;
+  }
   if (probe == TLV_Interest) {
     isInterest = 1;
   }
@@ -69,13 +87,19 @@ ndn_direct_face_send(struct ndn_face_intf* self, const ndn_name_t* name,
   }
 
   for (int i = 0; i < NDN_DIRECT_FACE_CB_ENTRY_SIZE; i++) {
+    if (direct_face.cb_entries[i].interest_name == NULL) {
+      continue;
+    }
     if (direct_face.cb_entries[i].is_prefix == isInterest && isInterest == 0
-        && ndn_name_compare(&direct_face.cb_entries[i].interest_name, name) == 0) {
-      direct_face.cb_entries[i].on_data(packet, size);
+        && ndn_packed_name_compare(direct_face.cb_entries[i].interest_name, name) == 0) {
+      // the Interest is satisfied, release the entry before the callback expresses new ones
+      ndn_on_data_callback on_data = direct_face.cb_entries[i].on_data;
+      direct_face.cb_entries[i].interest_name = NULL;
+      on_data(packet, size);
       return 0;
     }
     if (direct_face.cb_entries[i].is_prefix == isInterest && isInterest == 1
-        && ndn_name_is_prefix_of(&direct_face.cb_entries[i].interest_name, name) == 0) {
+        && ndn_packed_name_is_prefix_of(direct_face.cb_entries[i].interest_name, name) == 0) {
       direct_face.cb_entries[i].on_interest(packet, size);
       return 0;
     }
@@ -83,6 +107,34 @@ ndn_direct_face_send(struct ndn_face_intf* self, const ndn_name_t* name,
   return NDN_FWD_NO_MATCHED_CALLBACK;
 }
 
+void
+ndn_direct_face_on_interest_timeout(struct ndn_face_intf* self, const ndn_packed_name_t* name)
+{
+  (void)self;
+  for (int i = 0; i < NDN_DIRECT_FACE_CB_ENTRY_SIZE; i++) {
+    if (direct_face.cb_entries[i].interest_name != NULL && direct_face.cb_entries[i].is_prefix == 0
+        && ndn_packed_name_compare(direct_face.cb_entries[i].interest_name, name) == 0) {
+      ndn_interest_timeout_callback on_timeout = direct_face.cb_entries[i].on_timeout;
+      direct_face.cb_entries[i].interest_name = NULL;
+      if (on_timeout == NULL) {
+        return;
+      }
+
+      // The forwarder keeps the name only, so hand over an equivalent Interest
+      ndn_encoder_t encoder;
+      ndn_interest_init(&timeout_interest);
+      if (ndn_packed_name_to_name(name, &timeout_interest.name) != 0) {
+        return;
+      }
+      encoder_init(&encoder, timeout_buffer, sizeof(timeout_buffer));
+      if (ndn_interest_tlv_encode(&encoder, &timeout_interest) == 0) {
+        on_timeout(timeout_buffer, encoder.offset);
+      }
+      return;
+    }
+  }
+}
+
 ndn_direct_face_t*
 ndn_direct_face_construct(uint16_t face_id)
 {
@@ -90,13 +142,20 @@ ndn_direct_face_construct(uint16_t face_id)
   direct_face.intf.send = ndn_direct_face_send;
   direct_face.intf.down = ndn_direct_face_down;
   direct_face.intf.destroy = ndn_direct_face_destroy;
+  direct_face.intf.on_interest_timeout = ndn_direct_face_on_interest_timeout;
+  direct_face.intf.send_pktbuf = NULL;
+  direct_face.intf.send_fragment = NULL;
+  direct_face.intf.fec_parity = 0;
+  direct_face.intf.reliability = NULL;
   direct_face.intf.face_id = face_id;
   direct_face.intf.state = NDN_FACE_STATE_DESTROYED;
   direct_face.intf.type = NDN_FACE_TYPE_APP;
+  direct_face.intf.handle = NDN_FACE_HANDLE_NONE;
+  memset(&direct_face.intf.counters, 0, sizeof(direct_face.intf.counters));
 
   // init call back entries
   for (int i = 0; i < NDN_DIRECT_FACE_CB_ENTRY_SIZE; i++) {
-    direct_face.cb_entries[i].interest_name.components_size = NDN_FWD_INVALID_NAME_SIZE;
+    direct_face.cb_entries[i].interest_name = NULL;
   }
 
   return &direct_face;
@@ -108,8 +167,10 @@ ndn_direct_face_express_interest(const ndn_name_t* interest_name,
                                  ndn_on_data_callback on_data, ndn_interest_timeout_callback on_interest_timeout)
 {
   for (int i = 0; i < NDN_DIRECT_FACE_CB_ENTRY_SIZE; i++) {
-    if (direct_face.cb_entries[i].interest_name.components_size == NDN_FWD_INVALID_NAME_SIZE) {
-      direct_face.cb_entries[i].interest_name = *interest_name;
+    if (direct_face.cb_entries[i].interest_name == NULL) {
+      direct_face.cb_entries[i].interest_name
+        = ndn_packed_name_from_name(interest_name, direct_face.cb_entries[i].name_buffer,
+                                    sizeof(direct_face.cb_entries[i].name_buffer));
       direct_face.cb_entries[i].is_prefix = 0;
       direct_face.cb_entries[i].on_data = on_data;
       direct_face.cb_entries[i].on_timeout = on_interest_timeout;
@@ -127,8 +188,10 @@ ndn_direct_face_register_prefix(const ndn_name_t* prefix_name,
                                 ndn_on_interest_callback on_interest)
 {
   for (int i = 0; i < NDN_DIRECT_FACE_CB_ENTRY_SIZE; i++) {
-    if (direct_face.cb_entries[i].interest_name.components_size == NDN_FWD_INVALID_NAME_SIZE) {
-      direct_face.cb_entries[i].interest_name = *prefix_name;
+    if (direct_face.cb_entries[i].interest_name == NULL) {
+      direct_face.cb_entries[i].interest_name
+        = ndn_packed_name_from_name(prefix_name, direct_face.cb_entries[i].name_buffer,
+                                    sizeof(direct_face.cb_entries[i].name_buffer));
       direct_face.cb_entries[i].is_prefix = 1;
       direct_face.cb_entries[i].on_data = NULL;
       direct_face.cb_entries[i].on_timeout = NULL;
@@ -73,9 +73,14 @@ typedef int (*ndn_on_interest_callback)(const uint8_t* interest, uint32_t intere
  */
 typedef struct ndn_face_cb_entry {
   /**
-   * The interest name of callback entry.
+   * The interest name of callback entry, kept in @c name_buffer.
+   * NULL indicates an empty entry.
    */
-  ndn_name_t interest_name;
+  ndn_packed_name_t* interest_name;
+  /**
+   * The memory keeping @c interest_name.
+   */
+  uint16_t name_buffer[(NDN_PACKED_NAME_BUFFER_SIZE + 1) / sizeof(uint16_t)];
   /**
    * Flag to represent current callback entry is a registered prefix.
    */
@@ -11,6 +11,7 @@
 #include "dummy-face.h"
 #include "../encode/data.h"
 #include <stdio.h>
+#include <string.h>
 
 /************************************************************/
 /*  Inherit Face Interfaces                                 */
@@ -25,7 +26,7 @@ ndn_dummy_face_up(struct ndn_face_intf* self)
 }
 
 int
-ndn_dummy_face_send(struct ndn_face_intf* self, const ndn_name_t* name,
+ndn_dummy_face_send(struct ndn_face_intf* self, const ndn_packed_name_t* name,
                     const uint8_t* packet, uint32_t size)
 {
   (void)self;
@@ -60,8 +61,15 @@ ndn_dummy_face_construct(ndn_dummy_face_t* face, uint16_t face_id)
   face->intf.send = ndn_dummy_face_send;
   face->intf.down = ndn_dummy_face_down;
   face->intf.destroy = ndn_dummy_face_destroy;
+  face->intf.on_interest_timeout = NULL;
+  face->intf.send_pktbuf = NULL;
+  face->intf.send_fragment = NULL;
+  face->intf.fec_parity = 0;
+  face->intf.reliability = NULL;
   face->intf.face_id = face_id;
   face->intf.state = NDN_FACE_STATE_DESTROYED;
   face->intf.type = NDN_FACE_TYPE_NET;
+  face->intf.handle = NDN_FACE_HANDLE_NONE;
+  memset(&face->intf.counters, 0, sizeof(face->intf.counters));
   return face;
 }
@@ -0,0 +1,268 @@
+/*
+ * Copyright (C) 2019 Xinyu Ma
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include "ring-face.h"
+#include "../encode/fragmentation-support.h"
+#include "../util/ndn-lite-alarm.h"
+#include <stddef.h>
+#include <string.h>
+
+/************************************************************/
+/*  Inherit Face Interfaces                                 */
+/************************************************************/
+
+static int
+ndn_ring_face_up(struct ndn_face_intf* self)
+{
+  self->state = NDN_FACE_STATE_UP;
+  return 0;
+}
+
+static int
+ndn_ring_face_down(struct ndn_face_intf* self)
+{
+  self->state = NDN_FACE_STATE_DOWN;
+  return 0;
+}
+
+static void
+ndn_ring_face_destroy(struct ndn_face_intf* self)
+{
+  self->state = NDN_FACE_STATE_DESTROYED;
+}
+
+// Copy a packet into a frame of a ring
+static int
+ring_face_enqueue(ndn_ring_t* ring, const uint8_t* packet, uint32_t size)
+{
+  ndn_ring_face_frame_t* frame = NULL;
+  uint32_t pos = 0;
+  if (size > NDN_RING_FACE_FRAME_SIZE) {
+    return NDN_OVERSIZE;
+  }
+  if (ndn_ring_enqueue_reserve(ring, (void**)&frame, &pos, 1) == 0) {
+    return NDN_FWD_FACE_RING_FULL;
+  }
+  frame->size = size;
+  memcpy(frame->packet, packet, size);
+  ndn_ring_enqueue_commit(ring, pos, 1);
+  return 0;
+}
+
+static int
+ndn_ring_face_send(struct ndn_face_intf* self, const ndn_packed_name_t* name,
+                   const uint8_t* packet, uint32_t size)
+{
+  (void)name;
+  return ring_face_enqueue(&((ndn_ring_face_t*)self)->tx, packet, size);
+}
+
+/************************************************************/
+/*  Link Layer on the Driver Side                           */
+/************************************************************/
+
+static int
+ring_face_aggregator_send(ndn_lp_aggregator_t* aggregator, const uint8_t* frame, uint32_t size)
+{
+  ndn_ring_face_t* face = (ndn_ring_face_t*)((uint8_t*)aggregator - offsetof(ndn_ring_face_t, aggregator));
+  return face->link_send(face, frame, size);
+}
+
+// Send a frame on the link, in the frame being filled if the face aggregates
+static int
+ring_face_link_out(ndn_ring_face_t* self, const uint8_t* packet, uint32_t size)
+{
+  int ret_val = 0;
+  if (self->aggregator.frame == NULL) {
+    return self->link_send(self, packet, size);
+  }
+  // a fragment with the ndn-riot header fills its frame alone
+  if (size > NDN_FRAG_HDR_LEN && (packet[0] & NDN_FRAG_HB_MASK)) {
+    ret_val = ndn_lp_aggregator_flush(&self->aggregator);
+    if (ret_val != 0) return ret_val;
+    return self->link_send(self, packet, size);
+  }
+  ret_val = ndn_lp_aggregator_add(&self->aggregator, packet, size, ndn_alarm_micros_get_now());
+  if (ret_val == NDN_OVERSIZE) {
+    return self->link_send(self, packet, size);
+  }
+  return ret_val;
+}
+
+static int
+ring_face_reliability_send(ndn_lp_reliability_t* reliability, const uint8_t* frame, uint32_t size)
+{
+  ndn_ring_face_t* face = (ndn_ring_face_t*)((uint8_t*)reliability - offsetof(ndn_ring_face_t, reliability));
+  return ring_face_link_out(face, frame, size);
+}
+
+// Send a packet of the forwarder on the link, reliably if the face has reliability
+static int
+ring_face_transmit_packet(ndn_ring_face_t* self, const uint8_t* packet, uint32_t size)
+{
+  int ret_val = 0;
+  ndn_lp_packet_t lp_packet;
+  if (self->reliability.capacity == 0 || (size > NDN_FRAG_HDR_LEN && (packet[0] & NDN_FRAG_HB_MASK))) {
+    return ring_face_link_out(self, packet, size);
+  }
+  // a Nack is an LpPacket already
+  if (packet[0] != TLV_LpPacket || ndn_lp_packet_from_block(&lp_packet, packet, size) != NDN_SUCCESS) {
+    ndn_lp_packet_init(&lp_packet, packet, size);
+  }
+  ret_val = ndn_lp_reliability_send(&self->reliability, &lp_packet, ndn_alarm_millis_get_now());
+  if (ret_val == NDN_OVERSIZE) {
+    return ring_face_link_out(self, packet, size);
+  }
+  return ret_val;
+}
+
+// Hand a received packet to the forwarder, after its reliability fields
+static int
+ring_face_link_in(ndn_ring_face_t* self, const uint8_t* packet, uint32_t size)
+{
+  ndn_lp_packet_t lp_packet;
+  if (self->reliability.capacity > 0 && packet[0] == TLV_LpPacket
+      && ndn_lp_packet_from_block(&lp_packet, packet, size) == NDN_SUCCESS) {
+    // the packet is received even if its Ack cannot be sent now
+    ndn_lp_reliability_on_receive(&self->reliability, &lp_packet, ndn_alarm_millis_get_now());
+    if (lp_packet.fragment == NULL) {
+      // IDLE packet
+      return 0;
+    }
+  }
+  return ring_face_enqueue(&self->rx, packet, size);
+}
+
+/************************************************************/
+/*  Ring Face Functions                                     */
+/************************************************************/
+
+ndn_ring_face_t*
+ndn_ring_face_construct(ndn_ring_face_t* face, uint16_t face_id,
+                        void* rx_memory, uint32_t rx_capacity,
+                        void* tx_memory, uint32_t tx_capacity)
+{
+  if (ndn_ring_init(&face->rx, rx_memory, rx_capacity, sizeof(ndn_ring_face_frame_t), false) != 0
+      || ndn_ring_init(&face->tx, tx_memory, tx_capacity, sizeof(ndn_ring_face_frame_t), true) != 0) {
+    return NULL;
+  }
+  face->intf.up = ndn_ring_face_up;
+  face->intf.send = ndn_ring_face_send;
+  face->intf.down = ndn_ring_face_down;
+  face->intf.destroy = ndn_ring_face_destroy;
+  face->intf.on_interest_timeout = NULL;
+  face->intf.send_pktbuf = NULL;
+  face->intf.send_fragment = NULL;
+  face->intf.fec_parity = 0;
+  face->intf.reliability = NULL;
+  face->intf.face_id = face_id;
+  face->intf.state = NDN_FACE_STATE_DESTROYED;
+  face->intf.type = NDN_FACE_TYPE_NET;
+  face->intf.handle = NDN_FACE_HANDLE_NONE;
+  memset(&face->intf.counters, 0, sizeof(face->intf.counters));
+  face->link_send = NULL;
+  face->aggregator.frame = NULL;
+  face->reliability.capacity = 0;
+  return face;
+}
+
+void
+ndn_ring_face_set_aggregation(ndn_ring_face_t* face, ndn_ring_face_link_send_t link_send,
+                              uint8_t* frame, uint32_t mtu)
+{
+  face->link_send = link_send;
+  ndn_lp_aggregator_init(&face->aggregator, ring_face_aggregator_send, frame, mtu,
+                         NDN_LP_AGGREGATION_DELAY);
+}
+
+void
+ndn_ring_face_set_reliability(ndn_ring_face_t* face, ndn_ring_face_link_send_t link_send,
+                              void* memory, uint32_t capacity, uint32_t mtu)
+{
+  face->link_send = link_send;
+  ndn_lp_reliability_init(&face->reliability, ring_face_reliability_send, memory, capacity, mtu);
+}
+
+int
+ndn_ring_face_push(ndn_ring_face_t* self, const uint8_t* packet, uint32_t size)
+{
+  int ret_val = 0;
+  uint32_t offset = 0;
+  const uint8_t* next = NULL;
+  uint32_t next_size = 0;
+
+  if (size == 0 || (size > NDN_FRAG_HDR_LEN && (packet[0] & NDN_FRAG_HB_MASK))) {
+    return ring_face_enqueue(&self->rx, packet, size);
+  }
+  if (self->aggregator.frame == NULL) {
+    return ring_face_link_in(self, packet, size);
+  }
+  while ((ret_val = ndn_lp_frame_next(packet, size, &offset, &next, &next_size)) == 0) {
+    ret_val = ring_face_link_in(self, next, next_size);
+    if (ret_val != 0) return ret_val;
+  }
+  return (ret_val == NDN_FRAG_NO_MORE_FRAGS) ? 0 : ret_val;
+}
+
+uint32_t
+ndn_ring_face_pull(ndn_ring_face_t* self, uint8_t* buffer, uint32_t buffer_size)
+{
+  ndn_ring_face_frame_t* frame = NULL;
+  uint32_t size = 0;
+  if (ndn_ring_peek_burst(&self->tx, (void**)&frame, 1) == 0) {
+    return 0;
+  }
+  if (frame->size <= buffer_size) {
+    size = frame->size;
+    memcpy(buffer, frame->packet, size);
+  }
+  ndn_ring_release(&self->tx, 1);
+  return size;
+}
+
+uint32_t
+ndn_ring_face_transmit(ndn_ring_face_t* self)
+{
+  ndn_ring_face_frame_t* frames = NULL;
+  uint32_t count = ndn_ring_peek_burst(&self->tx, (void**)&frames, NDN_FWD_BURST_SIZE);
+  // a packet the link fails to send is lost, as on the link itself
+  for (uint32_t i = 0; i < count; i++) {
+    ring_face_transmit_packet(self, frames[i].packet, frames[i].size);
+  }
+  if (count > 0) {
+    ndn_ring_release(&self->tx, count);
+  }
+  if (self->reliability.capacity > 0) {
+    ndn_lp_reliability_poll(&self->reliability, ndn_alarm_millis_get_now());
+  }
+  if (self->aggregator.frame != NULL) {
+    ndn_lp_aggregator_poll(&self->aggregator, ndn_alarm_micros_get_now());
+  }
+  return count;
+}
+
+uint32_t
+ndn_ring_face_poll(ndn_ring_face_t* self)
+{
+  ndn_forwarder_rx_t burst[NDN_FWD_BURST_SIZE];
+  ndn_ring_face_frame_t* frames = NULL;
+  uint32_t count = ndn_ring_peek_burst(&self->rx, (void**)&frames, NDN_FWD_BURST_SIZE);
+  if (count == 0) {
+    return 0;
+  }
+  for (uint32_t i = 0; i < count; i++) {
+    burst[i].face = &self->intf;
+    burst[i].packet = frames[i].packet;
+    burst[i].size = frames[i].size;
+    burst[i].buf = NULL;
+  }
+  ndn_forwarder_process_burst(ndn_forwarder_get_instance(), burst, count);
+  // the frames are read in place, so they go back to the driver only now
+  ndn_ring_release(&self->rx, count);
+  return count;
+}
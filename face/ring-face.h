@@ -0,0 +1,214 @@
+/*
+ * Copyright (C) 2019 Xinyu Ma
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#ifndef FORWARDER_RING_FACE_H_
+#define FORWARDER_RING_FACE_H_
+
+#include "../forwarder/forwarder.h"
+#include "../encode/lp-aggregation.h"
+#include "../encode/lp-reliability.h"
+#include "../util/ring.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Ring Face is a face implementation for a driver running in its own thread,
+ * e.g. a UDP receiver, while the forwarder runs in another thread.
+ *
+ *  +--------+  rx ring   +--------+
+ *  | driver | ---------> |        |
+ *  | thread |  tx ring   |  fwd   |
+ *  |        | <--------- |        |
+ *  +--------+            +--------+
+ *
+ * Packets are copied into frames of the rings, so neither side waits for the other
+ * and no mutex is taken. The rx ring has a single producer, the driver. The tx ring
+ * accepts several producers, so all forwarding threads of a sharded forwarder can send.
+ * The driver may also hand the link layer to the face, see ndn_ring_face_set_aggregation()
+ * and ndn_ring_face_set_reliability().
+ * The link layer state is then kept on the driver side, so it is not shared by threads either.
+ *    APIs for the driver thread:
+ *      * ndn_ring_face_push
+ *      * ndn_ring_face_pull
+ *      * ndn_ring_face_transmit
+ *    APIs for the forwarder thread:
+ *      * ndn_ring_face_poll
+ */
+
+/**
+ * The max size of a packet passing a ring face.
+ */
+#define NDN_RING_FACE_FRAME_SIZE 1024
+
+/**
+ * A packet in a ring of a ring face.
+ */
+typedef struct ndn_ring_face_frame {
+  /**
+   * The size of the packet.
+   */
+  uint32_t size;
+  /**
+   * The wire format packet.
+   */
+  uint8_t packet[NDN_RING_FACE_FRAME_SIZE];
+} ndn_ring_face_frame_t;
+
+/**
+ * The required memory of a ring of a ring face.
+ * @param capacity Input. The max number of packets in the ring, a power of 2.
+ */
+#define NDN_RING_FACE_RESERVE_SIZE(capacity) \
+    NDN_RING_RESERVE_SIZE(capacity, sizeof(ndn_ring_face_frame_t))
+
+struct ndn_ring_face;
+
+/**
+ * The link sending function of the driver of a ring face.
+ * @param self Input. The ring face.
+ * @param frame Input. The frame to send on the link.
+ * @param size Input. The size of the frame.
+ * @return 0 if there is no error.
+ */
+typedef int (*ndn_ring_face_link_send_t)(struct ndn_ring_face* self, const uint8_t* frame, uint32_t size);
+
+/**
+ * The structure to represent a ring face.
+ */
+typedef struct ndn_ring_face {
+  /**
+   * The inherited interface abstraction.
+   */
+  ndn_face_intf_t intf;
+  /**
+   * The packets received by the driver, to the forwarder.
+   */
+  ndn_ring_t rx;
+  /**
+   * The packets sent by the forwarder, to the driver.
+   */
+  ndn_ring_t tx;
+  /**
+   * [optional] The link sending function of the driver, used by ndn_ring_face_transmit().
+   * NULL if the driver takes the packets with ndn_ring_face_pull().
+   */
+  ndn_ring_face_link_send_t link_send;
+  /**
+   * Packs the packets sent into frames. Unused while @c aggregator.frame is NULL.
+   */
+  ndn_lp_aggregator_t aggregator;
+  /**
+   * The NDNLPv2 reliability state of the link. Unused while @c reliability.capacity is 0.
+   */
+  ndn_lp_reliability_t reliability;
+} ndn_ring_face_t;
+
+/**
+ * Construct the ring face and initialize its state.
+ * @pre NDN_RING_FACE_RESERVE_SIZE(capacity) bytes needed for each ring, aligned to 4 bytes.
+ * @param face Output. The ring face to be constructed.
+ * @param face_id Input. The face id to identity the ring face.
+ * @param rx_memory Input. The memory used to keep the received packets.
+ * @param rx_capacity Input. The max number of received packets pending, a power of 2.
+ * @param tx_memory Input. The memory used to keep the sent packets.
+ * @param tx_capacity Input. The max number of sent packets pending, a power of 2.
+ * @return the pointer to the constructed ring face. NULL if a capacity is not a power of 2.
+ */
+ndn_ring_face_t*
+ndn_ring_face_construct(ndn_ring_face_t* face, uint16_t face_id,
+                        void* rx_memory, uint32_t rx_capacity,
+                        void* tx_memory, uint32_t tx_capacity);
+
+/**
+ * Let the ring face pack the packets sent into frames (see lp-aggregation.h), and split the
+ * frames received into packets.
+ * This function should be invoked right after ndn_ring_face_construct(). The driver then
+ * pushes whole frames, and sends with ndn_ring_face_transmit() instead of ndn_ring_face_pull().
+ * A packet waits at most NDN_LP_AGGREGATION_DELAY microseconds for others to share its frame.
+ * @param face Input/Output. The ring face.
+ * @param link_send Input. The link sending function of the driver.
+ * @param frame Input. The buffer used to fill a frame, of @c mtu bytes.
+ * @param mtu Input. The max size of a frame.
+ */
+void
+ndn_ring_face_set_aggregation(ndn_ring_face_t* face, ndn_ring_face_link_send_t link_send,
+                              uint8_t* frame, uint32_t mtu);
+
+/**
+ * Let the ring face send the packets with NDNLPv2 link reliability (see lp-reliability.h).
+ * This function should be invoked right after ndn_ring_face_construct(). The driver then
+ * sends with ndn_ring_face_transmit() instead of ndn_ring_face_pull(), and calls it often
+ * enough to run the retransmission timers.
+ * Received LpPackets give their TxSequence and Ack fields in ndn_ring_face_push(), and IDLE
+ * packets stop there. Fragments with the ndn-riot header are sent without reliability.
+ * With aggregation as well, the LpPackets are packed into frames.
+ * @pre NDN_LP_RELIABILITY_RESERVE_SIZE(capacity, mtu) bytes needed, aligned to 8 bytes.
+ * @param face Input/Output. The ring face.
+ * @param link_send Input. The link sending function of the driver.
+ * @param memory Input. The memory used to keep the LpPackets not yet acknowledged.
+ * @param capacity Input. The max number of LpPackets not yet acknowledged, at least 1.
+ * @param mtu Input. The max size of an LpPacket.
+ */
+void
+ndn_ring_face_set_reliability(ndn_ring_face_t* face, ndn_ring_face_link_send_t link_send,
+                              void* memory, uint32_t capacity, uint32_t mtu);
+
+/**
+ * Hand a received packet to the forwarder.
+ * This function is supposed to be invoked by the driver thread ONLY.
+ * @param self Input/Output. The ring face.
+ * @param packet Input. The wire format packet, or a frame of packets if the face aggregates.
+ *        It is copied.
+ * @param size Input. The size of the packet.
+ * @return 0 if there is no error. NDN_FWD_FACE_RING_FULL if the forwarder falls behind, the
+ *         rest of the frame is then dropped. NDN_WRONG_TLV_LENGTH if the frame ends with a
+ *         truncated packet.
+ */
+int
+ndn_ring_face_push(ndn_ring_face_t* self, const uint8_t* packet, uint32_t size);
+
+/**
+ * Take a packet sent by the forwarder.
+ * This function is supposed to be invoked by the driver thread ONLY.
+ * @param self Input/Output. The ring face.
+ * @param buffer Output. The buffer receiving the wire format packet.
+ * @param buffer_size Input. The size of @c buffer.
+ * @return The size of the packet. 0 if there is no packet, or it does not fit in @c buffer
+ *         and is dropped.
+ */
+uint32_t
+ndn_ring_face_pull(ndn_ring_face_t* self, uint8_t* buffer, uint32_t buffer_size);
+
+/**
+ * Send a burst of the packets sent by the forwarder with the link sending function, through
+ * the link layer of the face. The frame being filled is sent once it is due, and so are the
+ * retransmissions and the acks of a face with reliability.
+ * This function is supposed to be invoked by the driver thread ONLY, from its event loop.
+ * @param self Input/Output. The ring face, with a link sending function.
+ * @return The number of packets taken from the forwarder.
+ */
+uint32_t
+ndn_ring_face_transmit(ndn_ring_face_t* self);
+
+/**
+ * Let the forwarder process a burst of the packets pushed by the driver.
+ * The packets are read in place, without copying.
+ * This function is supposed to be invoked by the forwarder thread ONLY.
+ * @param self Input/Output. The ring face.
+ * @return The number of packets processed.
+ */
+uint32_t
+ndn_ring_face_poll(ndn_ring_face_t* self);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FORWARDER_RING_FACE_H_
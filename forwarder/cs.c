@@ -0,0 +1,287 @@
+/*
+ * Copyright (C) 2019 Xinyu Ma, Zhiyi Zhang
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include "cs.h"
+
+#define CS_NIL NDN_HASH_INDEX_EMPTY
+
+/************************************************************/
+/*  Definition of helper functions                          */
+/************************************************************/
+
+static void
+cs_lru_unlink(ndn_cs_t* cs, uint32_t i)
+{
+  ndn_cs_entry_t* entry = &cs->entries[i];
+  if (entry->lru_prev != CS_NIL)
+    cs->entries[entry->lru_prev].lru_next = entry->lru_next;
+  else
+    cs->lru_head = entry->lru_next;
+  if (entry->lru_next != CS_NIL)
+    cs->entries[entry->lru_next].lru_prev = entry->lru_prev;
+  else
+    cs->lru_tail = entry->lru_prev;
+}
+
+static void
+cs_lru_push_front(ndn_cs_t* cs, uint32_t i)
+{
+  ndn_cs_entry_t* entry = &cs->entries[i];
+  entry->lru_prev = CS_NIL;
+  entry->lru_next = cs->lru_head;
+  if (cs->lru_head != CS_NIL)
+    cs->entries[cs->lru_head].lru_prev = i;
+  else
+    cs->lru_tail = i;
+  cs->lru_head = i;
+}
+
+// The number of prefixes an entry is indexed under
+static inline uint32_t
+cs_prefix_count(uint32_t components_size)
+{
+  return (components_size < NDN_CS_PREFIX_DEPTH) ? components_size : NDN_CS_PREFIX_DEPTH;
+}
+
+// Index a new entry by its name and the prefixes of its name
+static void
+cs_index_entry(ndn_cs_t* cs, const ndn_name_view_t* name, uint32_t i)
+{
+  ndn_cs_entry_t* entry = &cs->entries[i];
+  ndn_hash_index_insert(&cs->index, entry->name_hash, i);
+  for (uint32_t d = 0; d < cs_prefix_count(name->components_size); d++) {
+    entry->prefix_hashes[d] = name->prefix_hashes[name->components_size - 1 - d];
+    ndn_hash_index_insert(&cs->prefix_index, entry->prefix_hashes[d], i);
+  }
+}
+
+static uint32_t
+cs_chunk_count(const ndn_cs_t* cs)
+{
+  return (uint32_t)((uint8_t*)cs->chunk_next - cs->chunks) / NDN_CS_CHUNK_SIZE;
+}
+
+/************************************************************/
+/*  Definition of CS APIs                                   */
+/************************************************************/
+
+void
+ndn_cs_init(ndn_cs_t* cs, void* memory, uint32_t capacity, uint32_t byte_budget)
+{
+  uint8_t* ptr = (uint8_t*)memory;
+  uint32_t chunk_count = NDN_CS_CHUNK_COUNT(byte_budget);
+
+  cs->entries = (ndn_cs_entry_t*)ptr;
+  ptr += sizeof(ndn_cs_entry_t) * capacity;
+  ndn_hash_index_init(&cs->index, ptr, capacity);
+  ptr += NDN_HASH_INDEX_RESERVE_SIZE(capacity);
+  ndn_hash_index_init(&cs->prefix_index, ptr, capacity * NDN_CS_PREFIX_DEPTH);
+  ptr += NDN_HASH_INDEX_RESERVE_SIZE(capacity * NDN_CS_PREFIX_DEPTH);
+  cs->chunks = ptr;
+  ptr += NDN_CS_CHUNK_SIZE * chunk_count;
+  cs->chunk_next = (uint32_t*)ptr;
+  ptr += sizeof(uint32_t) * chunk_count;
+  ndn_name_arena_init(&cs->names, ptr, capacity * NDN_FWD_NAME_BYTES_PER_ENTRY);
+
+  cs->capacity = capacity;
+  cs->free_head = CS_NIL;
+  for (uint32_t i = capacity; i > 0; i--) {
+    cs->entries[i - 1].name = NULL;
+    cs->entries[i - 1].name_hash = cs->free_head;
+    cs->entries[i - 1].buf = NULL;
+    cs->free_head = i - 1;
+  }
+  cs->lru_head = cs->lru_tail = CS_NIL;
+
+  cs->free_chunk_head = CS_NIL;
+  for (uint32_t i = chunk_count; i > 0; i--) {
+    cs->chunk_next[i - 1] = cs->free_chunk_head;
+    cs->free_chunk_head = i - 1;
+  }
+  cs->free_chunk_count = chunk_count;
+}
+
+void
+ndn_cs_remove(ndn_cs_t* cs, ndn_cs_entry_t* entry)
+{
+  uint32_t i = (uint32_t)(entry - cs->entries);
+  if (entry->name == NULL) {
+    return;
+  }
+  ndn_hash_index_remove(&cs->index, entry->name_hash, i);
+  for (uint32_t d = 0; d < cs_prefix_count(entry->name->components_size); d++) {
+    ndn_hash_index_remove(&cs->prefix_index, entry->prefix_hashes[d], i);
+  }
+  cs_lru_unlink(cs, i);
+
+  // release the buffer or chunks
+  if (entry->buf != NULL) {
+    ndn_pktbuf_unref(entry->buf);
+    entry->buf = NULL;
+  }
+  uint32_t chunk = entry->first_chunk;
+  while (chunk != CS_NIL) {
+    uint32_t next = cs->chunk_next[chunk];
+    cs->chunk_next[chunk] = cs->free_chunk_head;
+    cs->free_chunk_head = chunk;
+    cs->free_chunk_count ++;
+    chunk = next;
+  }
+
+  ndn_name_arena_release(&cs->names, entry->name);
+  entry->name = NULL;
+  entry->name_hash = cs->free_head;
+  cs->free_head = i;
+}
+
+// Take a free entry for a new Data, evicting LRU entries until @c needed chunks and
+// the name memory are also free. NULL if the name does not fit even in an empty CS.
+static ndn_cs_entry_t*
+cs_alloc_entry(ndn_cs_t* cs, const ndn_name_view_t* name, uint32_t size,
+               uint64_t fresh_until, uint32_t needed)
+{
+  // replace the old one
+  ndn_cs_entry_t* entry = ndn_cs_lookup(cs, name, false, false, 0);
+  if (entry != NULL) {
+    ndn_cs_remove(cs, entry);
+  }
+
+  // evict LRU entries until an entry, enough chunks and the name memory are available
+  uint32_t name_size = ndn_name_view_packed_size(name);
+  void* name_block = NULL;
+  while (cs->free_head == CS_NIL || cs->free_chunk_count < needed
+         || (name_block = ndn_name_arena_alloc(&cs->names, name_size)) == NULL) {
+    if (cs->lru_tail == CS_NIL) {
+      return NULL;
+    }
+    ndn_cs_remove(cs, &cs->entries[cs->lru_tail]);
+  }
+
+  entry = &cs->entries[cs->free_head];
+  cs->free_head = entry->name_hash;
+
+  entry->name = ndn_name_view_to_packed(name, name_block, name_size);
+  entry->name_hash = ndn_name_view_hash(name);
+  entry->size = size;
+  entry->fresh_until = fresh_until;
+  entry->first_chunk = CS_NIL;
+  entry->buf = NULL;
+  return entry;
+}
+
+int
+ndn_cs_insert_pktbuf(ndn_cs_t* cs, const ndn_name_view_t* name,
+                     ndn_pktbuf_t* buf, uint64_t fresh_until)
+{
+  if (cs->capacity == 0) {
+    return NDN_OVERSIZE;
+  }
+  ndn_cs_entry_t* entry = cs_alloc_entry(cs, name, buf->size, fresh_until, 0);
+  if (entry == NULL) {
+    return NDN_OVERSIZE;
+  }
+  ndn_pktbuf_ref(buf);
+  entry->buf = buf;
+
+  uint32_t i = (uint32_t)(entry - cs->entries);
+  cs_index_entry(cs, name, i);
+  cs_lru_push_front(cs, i);
+  return 0;
+}
+
+int
+ndn_cs_insert(ndn_cs_t* cs, const ndn_name_view_t* name,
+              const uint8_t* data, uint32_t size, uint64_t fresh_until)
+{
+  uint32_t needed = NDN_CS_CHUNK_COUNT(size);
+  if (needed > cs_chunk_count(cs) || cs->capacity == 0) {
+    return NDN_OVERSIZE;
+  }
+  ndn_cs_entry_t* entry = cs_alloc_entry(cs, name, size, fresh_until, needed);
+  if (entry == NULL) {
+    return NDN_OVERSIZE;
+  }
+  uint32_t i = (uint32_t)(entry - cs->entries);
+
+  // copy into chunks
+  uint32_t* link = &entry->first_chunk;
+  for (uint32_t offset = 0; offset < size; offset += NDN_CS_CHUNK_SIZE) {
+    uint32_t chunk = cs->free_chunk_head;
+    cs->free_chunk_head = cs->chunk_next[chunk];
+    cs->free_chunk_count --;
+    uint32_t len = (size - offset < NDN_CS_CHUNK_SIZE) ? size - offset : NDN_CS_CHUNK_SIZE;
+    memcpy(cs->chunks + chunk * NDN_CS_CHUNK_SIZE, data + offset, len);
+    *link = chunk;
+    link = &cs->chunk_next[chunk];
+  }
+  *link = CS_NIL;
+
+  cs_index_entry(cs, name, i);
+  cs_lru_push_front(cs, i);
+  return 0;
+}
+
+ndn_cs_entry_t*
+ndn_cs_lookup(ndn_cs_t* cs, const ndn_name_view_t* name,
+              bool can_be_prefix, bool must_be_fresh, uint64_t now)
+{
+  ndn_cs_entry_t* entry = NULL;
+  uint32_t name_hash = ndn_name_view_hash(name);
+
+  // exact match
+  uint32_t pos = ndn_hash_index_home(&cs->index, name_hash);
+  uint32_t i;
+  while ((i = ndn_hash_index_probe(&cs->index, name_hash, &pos)) != NDN_HASH_INDEX_EMPTY) {
+    if (ndn_name_view_equals(name, cs->entries[i].name)) {
+      if (!must_be_fresh || cs->entries[i].fresh_until > now)
+        entry = &cs->entries[i];
+      break;
+    }
+    pos = (pos + 1) & cs->index.mask;
+  }
+
+  // prefix match among the entries indexed under the Interest name
+  if (entry == NULL && can_be_prefix) {
+    pos = ndn_hash_index_home(&cs->prefix_index, name_hash);
+    while ((i = ndn_hash_index_probe(&cs->prefix_index, name_hash, &pos)) != NDN_HASH_INDEX_EMPTY) {
+      if (cs->entries[i].name->components_size > name->components_size
+          && ndn_name_view_is_prefix_of(name, cs->entries[i].name)
+          && (!must_be_fresh || cs->entries[i].fresh_until > now)) {
+        entry = &cs->entries[i];
+        break;
+      }
+      pos = (pos + 1) & cs->prefix_index.mask;
+    }
+  }
+
+  if (entry != NULL) {
+    i = (uint32_t)(entry - cs->entries);
+    cs_lru_unlink(cs, i);
+    cs_lru_push_front(cs, i);
+  }
+  return entry;
+}
+
+uint32_t
+ndn_cs_entry_copy(const ndn_cs_t* cs, const ndn_cs_entry_t* entry, uint8_t* buffer, uint32_t max_size)
+{
+  if (entry->size > max_size) {
+    return 0;
+  }
+  if (entry->buf != NULL) {
+    memcpy(buffer, entry->buf->data, entry->size);
+    return entry->size;
+  }
+  uint32_t chunk = entry->first_chunk;
+  for (uint32_t offset = 0; offset < entry->size; offset += NDN_CS_CHUNK_SIZE) {
+    uint32_t len = (entry->size - offset < NDN_CS_CHUNK_SIZE) ? entry->size - offset : NDN_CS_CHUNK_SIZE;
+    memcpy(buffer + offset, cs->chunks + chunk * NDN_CS_CHUNK_SIZE, len);
+    chunk = cs->chunk_next[chunk];
+  }
+  return entry->size;
+}
@@ -0,0 +1,225 @@
+/*
+ * Copyright (C) 2019 Xinyu Ma, Zhiyi Zhang
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#ifndef FORWARDER_CS_H_
+#define FORWARDER_CS_H_
+
+#include "../encode/name-view.h"
+#include "../util/hash-index.h"
+#include "../util/pktbuf.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup NDNFwdCS CS
+ * @brief Content Store
+ * @ingroup NDNFwd
+ * @{
+ */
+
+/**
+ * CS entry.
+ */
+typedef struct ndn_cs_entry {
+  /**
+   * The Data name, allocated from the name arena of the CS.
+   * NULL indicates an empty entry.
+   */
+  ndn_packed_name_t* name;
+  /**
+   * The hash of @c name. For an empty entry, it links to the next free entry.
+   */
+  uint32_t name_hash;
+  /**
+   * The size of the wire format Data.
+   */
+  uint32_t size;
+  /**
+   * The time (in milliseconds) before which the Data is fresh.
+   */
+  uint64_t fresh_until;
+  /**
+   * The first chunk keeping the wire format Data. Unused if @c buf is not NULL.
+   */
+  uint32_t first_chunk;
+  /**
+   * The packet buffer keeping the wire format Data, referenced by the entry.
+   * NULL if the Data is copied into chunks.
+   */
+  ndn_pktbuf_t* buf;
+  /**
+   * The hashes of the prefixes of @c name 1 to NDN_CS_PREFIX_DEPTH components shorter,
+   * under which the entry is indexed for CanBePrefix lookups.
+   */
+  uint32_t prefix_hashes[NDN_CS_PREFIX_DEPTH];
+  /**
+   * The previous (more recently used) entry in the LRU list.
+   */
+  uint32_t lru_prev;
+  /**
+   * The next (less recently used) entry in the LRU list.
+   */
+  uint32_t lru_next;
+} ndn_cs_entry_t;
+
+/**
+ * Content Store (CS) class.
+ * Data packets are copied into fixed-size chunks taken from a byte budget, or referenced
+ * in the packet buffers they are received in.
+ * When the entries, the chunks or the name memory run out, the least recently used entries
+ * are evicted.
+ */
+typedef struct ndn_cs {
+  /**
+   * The name hash index. Values are positions in @c entries.
+   */
+  ndn_hash_index_t index;
+  /**
+   * The prefix hash index, holding each entry under its @c prefix_hashes.
+   */
+  ndn_hash_index_t prefix_index;
+  /**
+   * The entry array.
+   */
+  ndn_cs_entry_t* entries;
+  /**
+   * The max number of entries.
+   */
+  uint32_t capacity;
+  /**
+   * The head of the free entry list.
+   */
+  uint32_t free_head;
+  /**
+   * The most recently used entry.
+   */
+  uint32_t lru_head;
+  /**
+   * The least recently used entry.
+   */
+  uint32_t lru_tail;
+  /**
+   * The chunk memory.
+   */
+  uint8_t* chunks;
+  /**
+   * The next chunk of each chunk.
+   */
+  uint32_t* chunk_next;
+  /**
+   * The head of the free chunk list.
+   */
+  uint32_t free_chunk_head;
+  /**
+   * The number of free chunks.
+   */
+  uint32_t free_chunk_count;
+  /**
+   * The arena of entry names.
+   */
+  ndn_name_arena_t names;
+} ndn_cs_t;
+
+/**
+ * The number of chunks needed to keep @c size bytes.
+ */
+#define NDN_CS_CHUNK_COUNT(size) (((size) + NDN_CS_CHUNK_SIZE - 1) / NDN_CS_CHUNK_SIZE)
+
+/**
+ * The required memory to initialize a CS.
+ * @param capacity Input. The max number of entries.
+ * @param byte_budget Input. The max number of bytes used to keep Data packets.
+ */
+#define NDN_CS_RESERVE_SIZE(capacity, byte_budget) \
+    (sizeof(ndn_cs_entry_t) * (capacity) + NDN_HASH_INDEX_RESERVE_SIZE(capacity) \
+     + NDN_HASH_INDEX_RESERVE_SIZE((capacity) * NDN_CS_PREFIX_DEPTH) \
+     + (sizeof(uint32_t) + NDN_CS_CHUNK_SIZE) * NDN_CS_CHUNK_COUNT(byte_budget) \
+     + NDN_NAME_ARENA_RESERVE_SIZE((capacity) * NDN_FWD_NAME_BYTES_PER_ENTRY))
+
+/**
+ * Initialize an empty CS.
+ * @pre NDN_CS_RESERVE_SIZE(capacity, byte_budget) bytes needed.
+ * @param cs Output. The CS to be inited.
+ * @param memory Input. The memory used to keep the CS. It should be aligned to 8 bytes.
+ * @param capacity Input. The max number of entries.
+ * @param byte_budget Input. The max number of bytes used to keep Data packets.
+ */
+void
+ndn_cs_init(ndn_cs_t* cs, void* memory, uint32_t capacity, uint32_t byte_budget);
+
+/**
+ * Insert a Data packet. An existing entry of the same name is replaced.
+ * @param cs Input/Output. The CS.
+ * @param name Input. The Data name, read from @c data.
+ * @param data Input. The wire format Data.
+ * @param size Input. The size of the wire format Data.
+ * @param fresh_until Input. The time (in milliseconds) before which the Data is fresh.
+ * @return 0 if there is no error. NDN_OVERSIZE if the Data is larger than the byte budget,
+ *         or its name larger than the name memory.
+ */
+int
+ndn_cs_insert(ndn_cs_t* cs, const ndn_name_view_t* name,
+              const uint8_t* data, uint32_t size, uint64_t fresh_until);
+
+/**
+ * Insert a Data packet kept in a packet buffer, by taking a reference instead of copying it.
+ * The buffer stays out of the byte budget, so its pool should have room for the CS
+ * capacity on top of the packets in flight. An existing entry of the same name is replaced.
+ * @param cs Input/Output. The CS.
+ * @param name Input. The Data name, read from @c buf.
+ * @param buf Input/Output. The packet buffer keeping exactly the wire format Data.
+ * @param fresh_until Input. The time (in milliseconds) before which the Data is fresh.
+ * @return 0 if there is no error. NDN_OVERSIZE if the name is larger than the name memory.
+ */
+int
+ndn_cs_insert_pktbuf(ndn_cs_t* cs, const ndn_name_view_t* name,
+                     ndn_pktbuf_t* buf, uint64_t fresh_until);
+
+/**
+ * Find a Data packet satisfying an Interest.
+ * A CanBePrefix Interest is matched through the prefix hash index, so it only finds Data
+ * up to NDN_CS_PREFIX_DEPTH components longer than its name, without scanning the CS.
+ * The returned entry becomes the most recently used one.
+ * @param cs Input/Output. The CS.
+ * @param name Input. The Interest name.
+ * @param can_be_prefix Input. Whether the Interest name may be a proper prefix of the Data name.
+ * @param must_be_fresh Input. Whether stale Data should be ignored.
+ * @param now Input. The current time in milliseconds.
+ * @return The CS entry. NULL if not found.
+ */
+ndn_cs_entry_t*
+ndn_cs_lookup(ndn_cs_t* cs, const ndn_name_view_t* name,
+              bool can_be_prefix, bool must_be_fresh, uint64_t now);
+
+/**
+ * Copy the wire format Data of an entry into a contiguous buffer.
+ * @param cs Input. The CS.
+ * @param entry Input. The CS entry.
+ * @param buffer Output. The buffer to keep the Data.
+ * @param max_size Input. The size of @c buffer.
+ * @return The size of the Data. 0 if @c buffer is too small.
+ */
+uint32_t
+ndn_cs_entry_copy(const ndn_cs_t* cs, const ndn_cs_entry_t* entry, uint8_t* buffer, uint32_t max_size);
+
+/**
+ * Delete a CS entry.
+ * @param cs Input/Output. The CS.
+ * @param entry Input. The CS entry.
+ */
+void
+ndn_cs_remove(ndn_cs_t* cs, ndn_cs_entry_t* entry);
+
+/*@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FORWARDER_CS_H_
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2019 Xinyu Ma, Zhiyi Zhang
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include "dead-nonce-list.h"
+#include <string.h>
+
+// Map a 32-bit hash onto a filter bit, which needs no power-of-2 filter size
+#define DNL_BIT_POSITION(hash) ((uint32_t)(((uint64_t)(hash) * NDN_DNL_FILTER_BITS) >> 32))
+
+// Derive the filter positions from two halves of a 64-bit mix (double hashing)
+static void
+dnl_positions(uint32_t name_hash, uint32_t nonce, uint32_t* positions)
+{
+  uint64_t x = ((uint64_t)name_hash << 32) | nonce;
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdULL;
+  x ^= x >> 33;
+  x *= 0xc4ceb9fe1a85ec53ULL;
+  x ^= x >> 33;
+  uint32_t h1 = (uint32_t)x;
+  uint32_t h2 = (uint32_t)(x >> 32) | 1;
+  for (int i = 0; i < NDN_DNL_HASH_COUNT; i++) {
+    positions[i] = DNL_BIT_POSITION(h1 + i * h2);
+  }
+}
+
+static void
+dnl_rotate(ndn_dead_nonce_list_t* dnl, uint64_t now)
+{
+  const uint64_t period = NDN_DNL_LIFETIME / 2;
+  if (now < dnl->rotated_at + period) {
+    return;
+  }
+  if (now >= dnl->rotated_at + 2 * period) {
+    // idle for a whole lifetime: both generations are stale
+    memset(dnl->filters, 0, sizeof(dnl->filters));
+  }
+  else {
+    dnl->current ^= 1;
+    memset(dnl->filters[dnl->current], 0, sizeof(dnl->filters[0]));
+  }
+  dnl->rotated_at = now;
+}
+
+void
+ndn_dnl_init(ndn_dead_nonce_list_t* dnl, uint64_t now)
+{
+  memset(dnl->filters, 0, sizeof(dnl->filters));
+  dnl->current = 0;
+  dnl->rotated_at = now;
+}
+
+void
+ndn_dnl_insert(ndn_dead_nonce_list_t* dnl, uint32_t name_hash, uint32_t nonce, uint64_t now)
+{
+  uint32_t positions[NDN_DNL_HASH_COUNT];
+  dnl_rotate(dnl, now);
+  dnl_positions(name_hash, nonce, positions);
+  uint8_t* filter = dnl->filters[dnl->current];
+  for (int i = 0; i < NDN_DNL_HASH_COUNT; i++) {
+    filter[positions[i] >> 3] |= (uint8_t)(1 << (positions[i] & 7));
+  }
+}
+
+bool
+ndn_dnl_has(ndn_dead_nonce_list_t* dnl, uint32_t name_hash, uint32_t nonce, uint64_t now)
+{
+  uint32_t positions[NDN_DNL_HASH_COUNT];
+  dnl_rotate(dnl, now);
+  dnl_positions(name_hash, nonce, positions);
+  for (int g = 0; g < 2; g++) {
+    const uint8_t* filter = dnl->filters[g];
+    int i;
+    for (i = 0; i < NDN_DNL_HASH_COUNT; i++) {
+      if (!(filter[positions[i] >> 3] & (1 << (positions[i] & 7))))
+        break;
+    }
+    if (i == NDN_DNL_HASH_COUNT)
+      return true;
+  }
+  return false;
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2019 Xinyu Ma, Zhiyi Zhang
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#ifndef FORWARDER_DEAD_NONCE_LIST_H_
+#define FORWARDER_DEAD_NONCE_LIST_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../ndn-constants.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup NDNFwdDNL Dead Nonce List
+ * @brief Recently satisfied or expired (Name, Nonce) pairs.
+ * @ingroup NDNFwd
+ *
+ * An Interest which comes back after its PIT entry is gone has looped.
+ * The list remembers (Name, Nonce) pairs for at least NDN_DNL_LIFETIME
+ * milliseconds in two Bloom filters: new pairs go to the current one, and
+ * the older one is cleared and becomes current every half lifetime.
+ * False positives drop a small fraction of new Interests, which consumers
+ * recover by retransmitting with a fresh Nonce. The filters are sized for
+ * NDN_DNL_EXPECTED_RATE Interests per second; the rate of false positives
+ * grows quickly beyond it.
+ * @{
+ */
+
+/**
+ * The number of hash functions of a filter.
+ */
+#define NDN_DNL_HASH_COUNT 3
+
+/**
+ * Dead nonce list class.
+ */
+typedef struct ndn_dead_nonce_list {
+  /**
+   * The two filter generations.
+   */
+  uint8_t filters[2][(NDN_DNL_FILTER_BITS + 7) / 8];
+  /**
+   * The index of the generation taking insertions.
+   */
+  uint8_t current;
+  /**
+   * The time (in milliseconds) the current generation started.
+   */
+  uint64_t rotated_at;
+} ndn_dead_nonce_list_t;
+
+/**
+ * Initialize a dead nonce list.
+ * @param dnl Output. The list.
+ * @param now Input. The current time in milliseconds.
+ */
+void
+ndn_dnl_init(ndn_dead_nonce_list_t* dnl, uint64_t now);
+
+/**
+ * Record a (Name, Nonce) pair.
+ * @param dnl Input/Output. The list.
+ * @param name_hash Input. The hash of the Interest name obtained from ndn_name_hash().
+ * @param nonce Input. The Nonce.
+ * @param now Input. The current time in milliseconds.
+ */
+void
+ndn_dnl_insert(ndn_dead_nonce_list_t* dnl, uint32_t name_hash, uint32_t nonce, uint64_t now);
+
+/**
+ * Check whether a (Name, Nonce) pair has been recorded recently.
+ * @param dnl Input/Output. The list.
+ * @param name_hash Input. The hash of the Interest name obtained from ndn_name_hash().
+ * @param nonce Input. The Nonce.
+ * @param now Input. The current time in milliseconds.
+ * @return true if the pair is (probably) in the list.
+ */
+bool
+ndn_dnl_has(ndn_dead_nonce_list_t* dnl, uint32_t name_hash, uint32_t nonce, uint64_t now);
+
+/*@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FORWARDER_DEAD_NONCE_LIST_H_
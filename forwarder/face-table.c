@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2019 Xinyu Ma, Zhiyi Zhang
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include "face-table.h"
+
+void
+ndn_face_table_init(ndn_face_table_t* table, void* memory, uint32_t capacity)
+{
+  if (capacity > 0xFFFF) {
+    capacity = 0xFFFF;
+  }
+  table->slots = (ndn_face_table_slot_t*)memory;
+  table->capacity = capacity;
+  table->count = 0;
+  for (uint32_t i = 0; i < capacity; i++) {
+    table->slots[i].face = NULL;
+    table->slots[i].generation = 1;
+    table->slots[i].next_free = (uint16_t)(i + 1);
+  }
+  table->free_head = 0;
+}
+
+ndn_face_handle_t
+ndn_face_table_register(ndn_face_table_t* table, ndn_face_intf_t* face)
+{
+  if (table->free_head >= table->capacity) {
+    return NDN_FACE_HANDLE_NONE;
+  }
+  uint32_t slot = table->free_head;
+  table->free_head = table->slots[slot].next_free;
+  table->slots[slot].face = face;
+  table->count ++;
+  face->face_id = (uint16_t)slot;
+  face->handle = ((ndn_face_handle_t)table->slots[slot].generation << 16) | slot;
+  return face->handle;
+}
+
+void
+ndn_face_table_unregister(ndn_face_table_t* table, ndn_face_handle_t handle)
+{
+  ndn_face_intf_t* face = ndn_face_table_get(table, handle);
+  if (face == NULL) {
+    return;
+  }
+  uint32_t slot = handle & 0xFFFF;
+  face->handle = NDN_FACE_HANDLE_NONE;
+  table->slots[slot].face = NULL;
+  // skip 0, so that no handle equals NDN_FACE_HANDLE_NONE
+  table->slots[slot].generation ++;
+  if (table->slots[slot].generation == 0) {
+    table->slots[slot].generation = 1;
+  }
+  table->slots[slot].next_free = (uint16_t)table->free_head;
+  table->free_head = slot;
+  table->count --;
+}
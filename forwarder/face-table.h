@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2019 Xinyu Ma, Zhiyi Zhang
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#ifndef FORWARDER_FACE_TABLE_H_
+#define FORWARDER_FACE_TABLE_H_
+
+#include "face.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup NDNFwdFaceTable Face Table
+ * @brief The faces known to the forwarder
+ * @ingroup NDNFwd
+ * @{
+ */
+
+/**
+ * A slot of the face table.
+ */
+typedef struct ndn_face_table_slot {
+  /**
+   * The registered face. NULL for a free slot.
+   */
+  ndn_face_intf_t* face;
+  /**
+   * The generation of the slot, increased every time its face is removed. Never 0.
+   */
+  uint16_t generation;
+  /**
+   * The next free slot, for a free slot.
+   */
+  uint16_t next_free;
+} ndn_face_table_slot_t;
+
+/**
+ * Face table class.
+ * The PIT and FIB keep the handle of a face next to its pointer. Removing a face only
+ * increases the generation of its slot, so every record of the face becomes stale at once
+ * and is skipped when it is next used, without scanning the tables.
+ */
+typedef struct ndn_face_table {
+  /**
+   * The slot array.
+   */
+  ndn_face_table_slot_t* slots;
+  /**
+   * The max number of faces, up to 65535.
+   */
+  uint32_t capacity;
+  /**
+   * The first free slot. @c capacity if the table is full.
+   */
+  uint32_t free_head;
+  /**
+   * The number of registered faces.
+   */
+  uint32_t count;
+} ndn_face_table_t;
+
+/**
+ * The required memory to initialize a face table.
+ * @param capacity Input. The max number of faces.
+ */
+#define NDN_FACE_TABLE_RESERVE_SIZE(capacity) \
+    (sizeof(ndn_face_table_slot_t) * (capacity))
+
+/**
+ * Initialize an empty face table.
+ * @pre NDN_FACE_TABLE_RESERVE_SIZE(capacity) bytes needed, aligned to a pointer.
+ * @param table Output. The face table.
+ * @param memory Input. The memory used to keep the slots.
+ * @param capacity Input. The max number of faces, up to 65535.
+ */
+void
+ndn_face_table_init(ndn_face_table_t* table, void* memory, uint32_t capacity);
+
+/**
+ * Register a face and assign its face ID and handle.
+ * @param table Input/Output. The face table.
+ * @param face Input/Output. The face. Its @c face_id and @c handle are set.
+ * @return The handle of the face. NDN_FACE_HANDLE_NONE if the table is full.
+ */
+ndn_face_handle_t
+ndn_face_table_register(ndn_face_table_t* table, ndn_face_intf_t* face);
+
+/**
+ * Remove a face. All handles of the face become stale.
+ * @param table Input/Output. The face table.
+ * @param handle Input. The handle of the face. Do nothing if it is stale already.
+ */
+void
+ndn_face_table_unregister(ndn_face_table_t* table, ndn_face_handle_t handle);
+
+/**
+ * Get the face of a handle in O(1).
+ * @param table Input. The face table.
+ * @param handle Input. The handle.
+ * @return The face. NULL if the handle is stale or NDN_FACE_HANDLE_NONE.
+ */
+static inline ndn_face_intf_t*
+ndn_face_table_get(const ndn_face_table_t* table, ndn_face_handle_t handle)
+{
+  uint32_t slot = handle & 0xFFFF;
+  if (slot >= table->capacity || table->slots[slot].generation != (handle >> 16)) {
+    return NULL;
+  }
+  return table->slots[slot].face;
+}
+
+/**
+ * Check whether a face recorded with a handle may still be used.
+ * Faces not registered (NDN_FACE_HANDLE_NONE) are managed by the application and always pass.
+ * @param table Input. The face table.
+ * @param handle Input. The handle recorded with the face.
+ */
+static inline bool
+ndn_face_table_is_alive(const ndn_face_table_t* table, ndn_face_handle_t handle)
+{
+  return handle == NDN_FACE_HANDLE_NONE || ndn_face_table_get(table, handle) != NULL;
+}
+
+/*@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FORWARDER_FACE_TABLE_H_
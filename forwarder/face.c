@@ -8,33 +8,391 @@
 
 #include "face.h"
 #include "../encode/data.h"
+#include "../encode/lp.h"
+#include "../encode/fragmentation-support.h"
+#include "../encode/fec.h"
+#include "../encode/lp-aggregation.h"
+#include "../encode/lp-reliability.h"
 #include "forwarder.h"
-#include <stdio.h>
+#include "../util/ndn-lite-alarm.h"
+#include "../util/trace.h"
+#include <string.h>
+
+// Overwrite the Nonce of a wire format Interest in place
+static void
+face_set_interest_nonce(uint8_t* interest, uint32_t size, uint32_t nonce)
+{
+  ndn_decoder_t decoder;
+  uint32_t type = 0;
+  uint32_t length = 0;
+  decoder_init(&decoder, interest, size);
+  if (decoder_get_type(&decoder, &type) != NDN_SUCCESS
+      || decoder_get_length(&decoder, &length) != NDN_SUCCESS)
+    return;
+  while (decoder.offset < size) {
+    if (decoder_get_type(&decoder, &type) != NDN_SUCCESS
+        || decoder_get_length(&decoder, &length) != NDN_SUCCESS)
+      return;
+    if (type == TLV_Nonce && length == 4 && decoder.offset + 4 <= size) {
+      interest[decoder.offset] = (uint8_t)(nonce >> 24);
+      interest[decoder.offset + 1] = (uint8_t)(nonce >> 16);
+      interest[decoder.offset + 2] = (uint8_t)(nonce >> 8);
+      interest[decoder.offset + 3] = (uint8_t)nonce;
+      return;
+    }
+    if (decoder_move_forward(&decoder, length) != NDN_SUCCESS)
+      return;
+  }
+}
 
 int
-ndn_face_receive(ndn_face_intf_t* self, const uint8_t* packet, uint32_t size)
+ndn_face_send_nack(ndn_face_intf_t* self, const ndn_packed_name_t* name, const uint8_t* interest, uint32_t size,
+                   uint32_t nonce, uint8_t reason, uint8_t* buffer, uint32_t buffer_size)
+{
+  int ret_val = 0;
+  ndn_encoder_t encoder;
+  ndn_lp_packet_t lp_packet;
+
+  ndn_lp_packet_init(&lp_packet, interest, size);
+  ndn_lp_packet_set_nack(&lp_packet, reason);
+  encoder_init(&encoder, buffer, buffer_size);
+  ret_val = ndn_lp_packet_tlv_encode(&encoder, &lp_packet);
+  if (ret_val != NDN_SUCCESS) return ret_val;
+  if (nonce != 0) {
+    face_set_interest_nonce(buffer + encoder.offset - size, size, nonce);
+  }
+  return ndn_face_send(self, name, buffer, encoder.offset);
+}
+
+int
+ndn_face_send_fragmented(ndn_face_intf_t* self, const ndn_packed_name_t* name,
+                         const uint8_t* packet, uint32_t size, uint32_t mtu,
+                         uint16_t frag_identifier, uint8_t* buffer)
 {
+  int ret_val = 0;
+  ndn_fragmenter_t fragmenter;
+  ndn_fragment_t fragment;
+  uint32_t fec_hdr_len = (self->fec_parity > 0) ? NDN_FEC_HDR_LEN : 0;
+  uint32_t unit = mtu - NDN_FRAG_HDR_LEN - fec_hdr_len;
+
+  if (mtu <= NDN_FRAG_HDR_LEN + fec_hdr_len || (fec_hdr_len > 0 && size > 0xFFFF)) {
+    return NDN_OVERSIZE;
+  }
+  if ((self->send_fragment == NULL || self->fec_parity > 0) && buffer == NULL) {
+    return NDN_FRAG_NO_MEM;
+  }
+  ndn_fragmenter_init(&fragmenter, packet, size, mtu - fec_hdr_len, frag_identifier);
+  if (fragmenter.total_frag_num > NDN_FRAG_MAX_SEQ_NUM + 1) {
+    return NDN_OVERSIZE;
+  }
+  if (self->state != NDN_FACE_STATE_UP)
+    self->up(self);
+  while (ndn_fragmenter_next(&fragmenter, &fragment) == 0) {
+    if (self->send_fragment != NULL) {
+      ret_val = self->send_fragment(self, name, fragment.header, NDN_FRAG_HDR_LEN,
+                                    fragment.payload, fragment.payload_size);
+    }
+    else {
+      ret_val = self->send(self, name, buffer, ndn_fragment_copy(&fragment, buffer));
+    }
+    if (ret_val != 0) return ret_val;
+  }
+
+  for (uint32_t j = 0; j < self->fec_parity; j++) {
+    uint8_t* header = buffer;
+    header[0] = NDN_FRAG_HB_MASK | NDN_FEC_PARITY_MASK | j;
+    header[1] = (frag_identifier >> 8) & 0xFF;
+    header[2] = frag_identifier & 0xFF;
+    header[3] = fragmenter.total_frag_num;
+    header[4] = (size >> 8) & 0xFF;
+    header[5] = size & 0xFF;
+    ndn_fec_encode(packet, size, unit, fragmenter.total_frag_num, j,
+                   buffer + NDN_FRAG_HDR_LEN + NDN_FEC_HDR_LEN);
+    if (self->send_fragment != NULL) {
+      ret_val = self->send_fragment(self, name, header, NDN_FRAG_HDR_LEN + NDN_FEC_HDR_LEN,
+                                    header + NDN_FRAG_HDR_LEN + NDN_FEC_HDR_LEN, unit);
+    }
+    else {
+      ret_val = self->send(self, name, buffer, mtu);
+    }
+    if (ret_val != 0) return ret_val;
+  }
+  return 0;
+}
+
+// Where ndn_face_reassemble() wants the whole packet received, instead of the forwarder
+typedef struct face_ingress {
+  // the buffer receiving a reassembled packet
+  uint8_t* buffer;
+  uint32_t buffer_size;
+  // the whole packet, NULL if none
+  const uint8_t* packet;
+  uint32_t size;
+} face_ingress_t;
+
+// Copy a reassembled packet to the ingress buffer, wrapped in an LpPacket if it is a Nack
+static int
+face_ingress_keep(face_ingress_t* ingress, const uint8_t* packet, uint32_t size,
+                  bool is_nack, uint8_t nack_reason)
+{
+  int ret_val = 0;
+  ndn_encoder_t encoder;
+  ndn_lp_packet_t lp_packet;
+
+  if (is_nack) {
+    ndn_lp_packet_init(&lp_packet, packet, size);
+    ndn_lp_packet_set_nack(&lp_packet, nack_reason);
+    encoder_init(&encoder, ingress->buffer, ingress->buffer_size);
+    ret_val = ndn_lp_packet_tlv_encode(&encoder, &lp_packet);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+    size = encoder.offset;
+  }
+  else {
+    if (size > ingress->buffer_size) return NDN_OVERSIZE;
+    memmove(ingress->buffer, packet, size);
+  }
+  ingress->packet = ingress->buffer;
+  ingress->size = size;
+  return 0;
+}
 
+// Hand a network layer packet to the forwarder, or to the ingress if any
+static int
+face_dispatch(ndn_face_intf_t* self, face_ingress_t* ingress, const uint8_t* packet, uint32_t size,
+              bool is_nack, uint8_t nack_reason)
+{
   int ret_val = -1;
-  
   ndn_decoder_t decoder;
   uint32_t probe = 0;
 
-  printf("face receive packet---");
-
+  if (ingress != NULL) {
+    return face_ingress_keep(ingress, packet, size, is_nack, nack_reason);
+  }
   decoder_init(&decoder, packet, size);
   ret_val = decoder_get_type(&decoder, &probe);
   if (ret_val != NDN_SUCCESS) return ret_val;
   if (probe == TLV_Data) {
-    printf("data packet\n");
-    return ndn_forwarder_on_incoming_data(ndn_forwarder_get_instance(), self, NULL, packet, size);
+    return ndn_forwarder_on_incoming_data(ndn_forwarder_get_instance(), self, packet, size);
+  }
+  else if (probe == TLV_Interest && is_nack) {
+    return ndn_forwarder_on_incoming_nack(ndn_forwarder_get_instance(), self, packet, size, nack_reason);
   }
   else if (probe == TLV_Interest) {
-    printf("interest packet\n");
-    return ndn_forwarder_on_incoming_interest(ndn_forwarder_get_instance(), self, NULL, packet, size);
+    return ndn_forwarder_on_incoming_interest(ndn_forwarder_get_instance(), self, packet, size);
+  }
+  return NDN_WRONG_TLV_TYPE;
+}
+
+// Reassemble an NDNLPv2 fragment. Fragments of a packet have consecutive Sequences,
+// so the Sequence of the first one identifies the packet.
+static int
+face_receive_lp_fragment(ndn_face_intf_t* self, face_ingress_t* ingress, const ndn_lp_packet_t* lp_packet)
+{
+  int ret_val = -1;
+  ndn_reassembly_t* table = &ndn_forwarder_get_instance()->reassembly;
+  ndn_reassembly_entry_t* entry = NULL;
+  uint32_t frag_index = lp_packet->enable_FragIndex ? lp_packet->frag_index : 0;
+
+  if (!lp_packet->enable_Sequence) {
+    return NDN_FRAG_MALFORMED;
+  }
+  ret_val = ndn_reassembly_add(table, self, lp_packet->sequence - frag_index, frag_index,
+                               lp_packet->frag_count, lp_packet->fragment, lp_packet->fragment_size,
+                               ndn_alarm_millis_get_now(), &entry);
+  if (ret_val != 0) return ret_val;
+  // the network layer headers come with the first fragment
+  if (frag_index == 0 && lp_packet->enable_Nack) {
+    entry->is_nack = true;
+    entry->nack_reason = lp_packet->nack_reason;
+  }
+  if (!ndn_reassembly_is_complete(entry)) return 0;
+  ret_val = face_dispatch(self, ingress, entry->buffer, entry->size, entry->is_nack, entry->nack_reason);
+  ndn_reassembly_remove(table, entry);
+  return ret_val;
+}
+
+// Unwrap an LpPacket, or a bare Interest or Data, and hand it to the forwarder.
+// The ingress gets a whole packet as received, LpPacket header included.
+static int
+face_receive_lp_packet(ndn_face_intf_t* self, face_ingress_t* ingress, const uint8_t* packet, uint32_t size)
+{
+  int ret_val = -1;
+  ndn_lp_packet_t lp_packet;
+
+  ret_val = ndn_lp_packet_from_block(&lp_packet, packet, size);
+  if (ret_val != NDN_SUCCESS) return ret_val;
+  if (self->reliability != NULL) {
+    // the packet is received even if its Ack cannot be sent now
+    ndn_lp_reliability_on_receive(self->reliability, &lp_packet, ndn_alarm_millis_get_now());
+  }
+  if (lp_packet.fragment == NULL) {
+    // IDLE packet
+    return 0;
+  }
+  if (lp_packet.enable_FragCount && lp_packet.frag_count > 1) {
+    return face_receive_lp_fragment(self, ingress, &lp_packet);
+  }
+  if (ingress != NULL) {
+    ingress->packet = packet;
+    ingress->size = size;
+    return 0;
+  }
+  return face_dispatch(self, NULL, lp_packet.fragment, lp_packet.fragment_size,
+                       lp_packet.enable_Nack, lp_packet.nack_reason);
+}
+
+// Reassemble a packet fragmented with the ndn-riot header (see fragmentation-support.h).
+// The Seq# is the fragment index and the MF bit marks the last fragment.
+// Parity fragments (see fec.h) carry the parity index instead.
+static int
+face_receive_riot_fragment(ndn_face_intf_t* self, face_ingress_t* ingress, const uint8_t* frag, uint32_t size)
+{
+  int ret_val = -1;
+  ndn_reassembly_t* table = &ndn_forwarder_get_instance()->reassembly;
+  ndn_reassembly_entry_t* entry = NULL;
+  ndn_decoder_t decoder;
+  uint32_t probe = 0;
+  uint32_t seq = frag[0] & NDN_FRAG_SEQ_MASK;
+  uint16_t id = ((uint16_t)frag[1] << 8) + (uint16_t)frag[2];
+
+  if (frag[0] & NDN_FEC_PARITY_MASK) {
+    if (size <= NDN_FRAG_HDR_LEN + NDN_FEC_HDR_LEN)
+      return NDN_FRAG_MALFORMED;
+    ret_val = ndn_reassembly_add_parity(table, self, id, frag[3], seq,
+                                        ((uint32_t)frag[4] << 8) + frag[5],
+                                        frag + NDN_FRAG_HDR_LEN + NDN_FEC_HDR_LEN,
+                                        size - NDN_FRAG_HDR_LEN - NDN_FEC_HDR_LEN,
+                                        ndn_alarm_millis_get_now(), &entry);
   }
   else {
-    // TODO: fragmentation support
+    ret_val = ndn_reassembly_add(table, self, id, seq, (frag[0] & NDN_FRAG_MF_MASK) ? seq + 1 : 0,
+                                 frag + NDN_FRAG_HDR_LEN, size - NDN_FRAG_HDR_LEN,
+                                 ndn_alarm_millis_get_now(), &entry);
   }
-  return 0;
+  if (ret_val != 0 || !ndn_reassembly_is_complete(entry)) return ret_val;
+  // the fragmented packet may be an LpPacket itself, but not another fragment
+  decoder_init(&decoder, entry->buffer, entry->size);
+  ret_val = decoder_get_type(&decoder, &probe);
+  if (ret_val == NDN_SUCCESS && probe != TLV_Interest && probe != TLV_Data && probe != TLV_LpPacket) {
+    ret_val = NDN_WRONG_TLV_TYPE;
+  }
+  if (ret_val == NDN_SUCCESS) {
+    ret_val = face_receive_lp_packet(self, ingress, entry->buffer, entry->size);
+  }
+  // the entry buffer is reused by the next fragments
+  if (ret_val == NDN_SUCCESS && ingress != NULL && ingress->packet == entry->buffer) {
+    ret_val = face_ingress_keep(ingress, entry->buffer, entry->size, false, 0);
+  }
+  ndn_reassembly_finish(table, entry);
+  return ret_val;
+}
+
+int
+ndn_face_receive(ndn_face_intf_t* self, const uint8_t* packet, uint32_t size)
+{
+
+  int ret_val = -1;
+  ndn_decoder_t decoder;
+  uint32_t probe = 0;
+
+  NDN_TRACE_DEBUG(NDN_TRACE_EVENT_FACE_RECEIVE, self->face_id, 0, (int32_t)size);
+
+  // no TLV type used on the link starts with the header bit
+  if (size > NDN_FRAG_HDR_LEN && (packet[0] & NDN_FRAG_HB_MASK)) {
+    return face_receive_riot_fragment(self, NULL, packet, size);
+  }
+
+  decoder_init(&decoder, packet, size);
+  ret_val = decoder_get_type(&decoder, &probe);
+  if (ret_val != NDN_SUCCESS) return ret_val;
+  if (probe != TLV_Interest && probe != TLV_Data && probe != TLV_LpPacket) {
+    return 0;
+  }
+
+  return face_receive_lp_packet(self, NULL, packet, size);
+}
+
+int
+ndn_face_reassemble(ndn_face_intf_t* self, const uint8_t* packet, uint32_t size,
+                    uint8_t* buffer, uint32_t buffer_size,
+                    const uint8_t** whole, uint32_t* whole_size)
+{
+  int ret_val = -1;
+  ndn_decoder_t decoder;
+  uint32_t probe = 0;
+  face_ingress_t ingress = {buffer, buffer_size, NULL, 0};
+
+  *whole = NULL;
+  *whole_size = 0;
+  if (size > NDN_FRAG_HDR_LEN && (packet[0] & NDN_FRAG_HB_MASK)) {
+    ret_val = face_receive_riot_fragment(self, &ingress, packet, size);
+  }
+  else {
+    decoder_init(&decoder, packet, size);
+    ret_val = decoder_get_type(&decoder, &probe);
+    if (ret_val != NDN_SUCCESS) return ret_val;
+    if (probe != TLV_Interest && probe != TLV_Data && probe != TLV_LpPacket) {
+      return 0;
+    }
+    ret_val = face_receive_lp_packet(self, &ingress, packet, size);
+  }
+  if (ret_val == 0) {
+    *whole = ingress.packet;
+    *whole_size = ingress.size;
+  }
+  return ret_val;
+}
+
+// Give the reliability fields of an LpPacket of a frame to the face reliability state.
+// Return true if the LpPacket is consumed, false if it carries a whole packet left to the burst.
+static bool
+face_receive_reliable(ndn_face_intf_t* self, const uint8_t* packet, uint32_t size)
+{
+  ndn_lp_packet_t lp_packet;
+  if (ndn_lp_packet_from_block(&lp_packet, packet, size) != NDN_SUCCESS) {
+    return true;
+  }
+  ndn_lp_reliability_on_receive(self->reliability, &lp_packet, ndn_alarm_millis_get_now());
+  if (lp_packet.fragment == NULL) {
+    // IDLE packet
+    return true;
+  }
+  if (lp_packet.enable_FragCount && lp_packet.frag_count > 1) {
+    face_receive_lp_fragment(self, NULL, &lp_packet);
+    return true;
+  }
+  return false;
+}
+
+int
+ndn_face_receive_frame(ndn_face_intf_t* self, const uint8_t* frame, uint32_t size)
+{
+  int ret_val = 0;
+  ndn_forwarder_rx_t burst[NDN_FWD_BURST_SIZE];
+  uint32_t count = 0;
+  uint32_t offset = 0;
+
+  // a fragment with the ndn-riot header fills its frame alone
+  if (size > NDN_FRAG_HDR_LEN && (frame[0] & NDN_FRAG_HB_MASK)) {
+    return ndn_face_receive(self, frame, size);
+  }
+  NDN_TRACE_DEBUG(NDN_TRACE_EVENT_FACE_RECEIVE, self->face_id, 0, (int32_t)size);
+  for (;;) {
+    ret_val = ndn_lp_frame_next(frame, size, &offset, &burst[count].packet, &burst[count].size);
+    if (ret_val == 0 && self->reliability != NULL && burst[count].packet[0] == TLV_LpPacket
+        && face_receive_reliable(self, burst[count].packet, burst[count].size)) {
+      continue;
+    }
+    if (ret_val == 0) {
+      burst[count].face = self;
+      burst[count].buf = NULL;
+      count ++;
+    }
+    if (count == NDN_FWD_BURST_SIZE || (ret_val != 0 && count > 0)) {
+      ndn_forwarder_process_burst(ndn_forwarder_get_instance(), burst, count);
+      count = 0;
+    }
+    if (ret_val != 0) break;
+  }
+  return (ret_val == NDN_FRAG_NO_MORE_FRAGS) ? 0 : ret_val;
 }
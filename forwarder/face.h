@@ -9,7 +9,9 @@
 #ifndef FORWARDER_FACE_H_
 #define FORWARDER_FACE_H_
 
-#include "../encode/name.h"
+#include "../encode/packed-name.h"
+#include "../util/counter.h"
+#include "../util/pktbuf.h"
 
 #define container_of(ptr, type, member) ({                \
   const typeof(((type *)0)->member) *__mptr = (ptr);      \
@@ -25,6 +27,52 @@ extern "C" {
  */
 
 struct ndn_face_intf;
+struct ndn_lp_reliability;
+
+/**
+ * A generation-checked reference to a face registered in the forwarder face table.
+ * The low 16 bits are the slot in the table and the high 16 bits the generation of the slot,
+ * so a handle kept after its face is removed never refers to a later face.
+ */
+typedef uint32_t ndn_face_handle_t;
+
+/**
+ * The handle of a face not registered in the face table.
+ */
+#define NDN_FACE_HANDLE_NONE 0
+
+/**
+ * The packet counters of a face.
+ * The forwarder counts the network layer packets it receives from and sends to a face.
+ * A face shared by several forwarding threads is counted by all of them, so each counter
+ * is updated atomically, but two counters read together may be a few packets apart.
+ */
+typedef struct ndn_face_counters {
+  /**
+   * The number of Interests received.
+   */
+  ndn_counter_t in_interests;
+  /**
+   * The number of Data received.
+   */
+  ndn_counter_t in_data;
+  /**
+   * The number of Nacks received.
+   */
+  ndn_counter_t in_nacks;
+  /**
+   * The number of Interests sent.
+   */
+  ndn_counter_t out_interests;
+  /**
+   * The number of Data sent.
+   */
+  ndn_counter_t out_data;
+  /**
+   * The number of Nacks sent.
+   */
+  ndn_counter_t out_nacks;
+} ndn_face_counters_t;
 
 /**
  * The interface up function.
@@ -44,7 +92,39 @@ typedef int (*ndn_face_intf_up)(struct ndn_face_intf* self);
  * @return 0 if there is no error.
  */
 typedef int (*ndn_face_intf_send)(struct ndn_face_intf* self,
-                                  const ndn_name_t* name, const uint8_t* packet, uint32_t size);
+                                  const ndn_packed_name_t* name, const uint8_t* packet, uint32_t size);
+
+/**
+ * The packet buffer sending function.
+ * Send out a packet kept in a packet buffer, without copying it. A face keeping the packet
+ * after the call, e.g. in an output queue, takes its own reference to @c buf.
+ * This function is optional: faces which do not support it set it to NULL, and are sent
+ * packet buffers through ndn_face_intf#send.
+ * @param self Input. The interface through which the packet will be sent.
+ * @param name [optional]Input. The name of the packet.
+ * @param buf Input. The packet buffer. It is shared, so it must not be modified.
+ * @return 0 if there is no error.
+ */
+typedef int (*ndn_face_intf_send_pktbuf)(struct ndn_face_intf* self,
+                                         const ndn_packed_name_t* name, ndn_pktbuf_t* buf);
+
+/**
+ * The fragment sending function.
+ * Send out one link layer fragment given in two pieces, the header and a slice of the
+ * original packet, e.g. with a scatter-gather write, so that the packet is not copied.
+ * This function is optional: faces which do not support it set it to NULL, and are sent
+ * fragments copied into a contiguous buffer through ndn_face_intf#send.
+ * @param self Input. The interface through which the fragment will be sent.
+ * @param name [optional]Input. The name of the fragmented packet.
+ * @param header Input. The fragmentation header.
+ * @param header_size Input. The size of the header.
+ * @param payload Input. The payload, a slice of the original packet.
+ * @param payload_size Input. The size of the payload.
+ * @return 0 if there is no error.
+ */
+typedef int (*ndn_face_intf_send_fragment)(struct ndn_face_intf* self, const ndn_packed_name_t* name,
+                                           const uint8_t* header, uint32_t header_size,
+                                           const uint8_t* payload, uint32_t payload_size);
 
 /**
  * The interface down function.
@@ -61,12 +141,22 @@ typedef int (*ndn_face_intf_down)(struct ndn_face_intf* self);
  */
 typedef void (*ndn_face_intf_destroy)(struct ndn_face_intf* self);
 
+/**
+ * The Interest timeout notifier.
+ * Tell the face that an Interest it has sent to the forwarder expired without Data.
+ * This function is optional: faces which do not care set it to NULL.
+ * @param self Input. The interface which sent the Interest.
+ * @param name Input. The name of the expired Interest.
+ */
+typedef void (*ndn_face_intf_on_interest_timeout)(struct ndn_face_intf* self, const ndn_packed_name_t* name);
+
 /**
  * Abstract NDN network face.
  * An abstract base class for all faces.
  * Derived classes should implement the function ndn_face_intf#up, ndn_face_intf#send,
  * ndn_face_intf#down, and ndn_face_intf#destroy with platform-specific APIs via assigning
- * function pointers in @c ndn_face_intf.
+ * function pointers in @c ndn_face_intf. ndn_face_intf#on_interest_timeout,
+ * ndn_face_intf#send_pktbuf and ndn_face_intf#send_fragment are optional.
  * @attention @c ndn_face_intf should always be the first member of any face class.
  */
 typedef struct ndn_face_intf {
@@ -74,6 +164,9 @@ typedef struct ndn_face_intf {
   ndn_face_intf_send send;
   ndn_face_intf_down down;
   ndn_face_intf_destroy destroy;
+  ndn_face_intf_on_interest_timeout on_interest_timeout;
+  ndn_face_intf_send_pktbuf send_pktbuf;
+  ndn_face_intf_send_fragment send_fragment;
 
   /**
    * Unique Face ID.
@@ -87,8 +180,42 @@ typedef struct ndn_face_intf {
    * The type of the face: NDN_FACE_TYPE_APP, NDN_FACE_TYPE_NET, NDN_FACE_TYPE_UNDEFINED
    */
   uint8_t type;
+  /**
+   * The number of parity fragments sent with each fragmented packet (see fec.h). 0 to send
+   * none, set by the face constructor.
+   */
+  uint8_t fec_parity;
+  /**
+   * The NDNLPv2 reliability state of the link (see lp-reliability.h), fed with the acks the
+   * face receives. NULL if the face does not send reliably, set by the face constructor.
+   */
+  struct ndn_lp_reliability* reliability;
+  /**
+   * The handle in the forwarder face table. NDN_FACE_HANDLE_NONE if not registered.
+   */
+  ndn_face_handle_t handle;
+  /**
+   * The packet counters, zeroed by the face constructor.
+   */
+  ndn_face_counters_t counters;
 } ndn_face_intf_t;
 
+/**
+ * Read the packet counters of a face. This function can be invoked from any thread.
+ * @param self Input. The face.
+ * @param counters Output. The counters.
+ */
+static inline void
+ndn_face_get_counters(const ndn_face_intf_t* self, ndn_face_counters_t* counters)
+{
+  counters->in_interests = ndn_counter_read(&self->counters.in_interests);
+  counters->in_data = ndn_counter_read(&self->counters.in_data);
+  counters->in_nacks = ndn_counter_read(&self->counters.in_nacks);
+  counters->out_interests = ndn_counter_read(&self->counters.out_interests);
+  counters->out_data = ndn_counter_read(&self->counters.out_data);
+  counters->out_nacks = ndn_counter_read(&self->counters.out_nacks);
+}
+
 /**
  * Turn on the interface.
  * This function is supposed to be invoked by the forwarder ONLY.
@@ -113,13 +240,88 @@ ndn_face_up(ndn_face_intf_t* self)
  * @return 0 if there is no error.
  */
 static inline int
-ndn_face_send(ndn_face_intf_t* self, const ndn_name_t* name, const uint8_t* packet, uint32_t size)
+ndn_face_send(ndn_face_intf_t* self, const ndn_packed_name_t* name, const uint8_t* packet, uint32_t size)
 {
   if (self->state != NDN_FACE_STATE_UP)
     self->up(self);
   return self->send(self, name, packet, size);
 }
 
+/**
+ * Send a packet kept in a packet buffer through the interface to the network.
+ * This function is supposed to be invoked by the forwarder ONLY.
+ * @param self Input. The interface through which the packet will be sent.
+ * @param name [optional]Input. The name of the packet.
+ * @param buf Input. The packet buffer. The caller keeps its reference.
+ * @return 0 if there is no error.
+ */
+static inline int
+ndn_face_send_pktbuf(ndn_face_intf_t* self, const ndn_packed_name_t* name, ndn_pktbuf_t* buf)
+{
+  if (self->state != NDN_FACE_STATE_UP)
+    self->up(self);
+  if (self->send_pktbuf != NULL)
+    return self->send_pktbuf(self, name, buf);
+  return self->send(self, name, buf->data, buf->size);
+}
+
+/**
+ * Set the number of parity fragments sent with each fragmented packet, so that the receiver
+ * rebuilds a packet with up to as many lost fragments. Both ends of the link must support it.
+ * @param self Input. The face.
+ * @param parity_count Input. The number of parity fragments, 0 to turn it off.
+ * @return 0 if there is no error. NDN_OVERSIZE if @c parity_count exceeds NDN_FEC_MAX_PARITY.
+ */
+static inline int
+ndn_face_set_fec_parity(ndn_face_intf_t* self, uint8_t parity_count)
+{
+  if (parity_count > NDN_FEC_MAX_PARITY)
+    return NDN_OVERSIZE;
+  self->fec_parity = parity_count;
+  return 0;
+}
+
+/**
+ * Send a packet through the interface in fragments with the ndn-riot header of
+ * fragmentation-support.h. Faces supporting ndn_face_intf#send_fragment are given every
+ * fragment in place; others are given a copy in @c buffer.
+ * When ndn_face_intf#fec_parity is set, the parity fragments of fec.h follow the data
+ * fragments, which are NDN_FEC_HDR_LEN bytes shorter so that all fragments fit in @c mtu.
+ * @param self Input. The interface through which the packet will be sent.
+ * @param name [optional]Input. The name of the packet.
+ * @param packet Input. The wire format packet buffer.
+ * @param size Input. The size of the wire format packet buffer.
+ * @param mtu Input. The max size of a fragment, including the header.
+ * @param frag_identifier Input. The identifier of the fragments.
+ * @param buffer Output. The memory of at least @c mtu bytes used to copy the fragments.
+ *        May be NULL if the face supports ndn_face_intf#send_fragment and sends no parity.
+ * @return 0 if there is no error.
+ */
+int
+ndn_face_send_fragmented(ndn_face_intf_t* self, const ndn_packed_name_t* name,
+                         const uint8_t* packet, uint32_t size, uint32_t mtu,
+                         uint16_t frag_identifier, uint8_t* buffer);
+
+/**
+ * Send a Nack of an Interest through the interface.
+ * The Interest is wrapped into an NDNLPv2 LpPacket with a Nack header.
+ * This function is supposed to be invoked by the forwarder ONLY.
+ * @param self Input. The interface through which the Nack will be sent.
+ * @param name [optional]Input. The name of the Interest.
+ * @param interest Input. The wire format Nacked Interest.
+ * @param size Input. The size of the wire format Interest.
+ * @param nonce Input. The Nonce the Nack carries, i.e. the one received from @c self.
+ *        0 to keep the Nonce of @c interest.
+ * @param reason Input. The Nack reason, e.g. NDN_LP_NACK_REASON_NO_ROUTE.
+ * @param buffer Output. The memory the LpPacket is encoded into, owned by the caller so that
+ *        forwarding threads do not share it.
+ * @param buffer_size Input. The size of @c buffer, e.g. NDN_LP_NACK_BUFFER_SIZE.
+ * @return 0 if there is no error.
+ */
+int
+ndn_face_send_nack(ndn_face_intf_t* self, const ndn_packed_name_t* name, const uint8_t* interest, uint32_t size,
+                   uint32_t nonce, uint8_t reason, uint8_t* buffer, uint32_t buffer_size);
+
 /**
  * Turn down the interface.
  * @param self Input. The interface to turn off.
@@ -145,6 +347,11 @@ ndn_face_destroy(ndn_face_intf_t* self)
 
 /**
  * Send Interest to the Forwarder (Forwarder receives)
+ * NDNLPv2 LpPackets are unwrapped here: a Nack is delivered to the forwarder as such,
+ * the TxSequence and Ack fields are given to ndn_face_intf#reliability, and IDLE packets are
+ * dropped. Fragments, either NDNLPv2 or with the ndn-riot header of
+ * fragmentation-support.h, are kept in the forwarder reassembly table until their packet is
+ * complete; they may arrive in any order.
  * @param self Input. The interface to transmit the packet to the forwarder.
  * @param packet Input. The wire format packet buffer.
  * @param size Input. The size of the wire format packet buffer.
@@ -153,6 +360,41 @@ ndn_face_destroy(ndn_face_intf_t* self)
 int
 ndn_face_receive(ndn_face_intf_t* self, const uint8_t* packet, uint32_t size);
 
+/**
+ * Do the link layer part of ndn_face_receive() only, and give back the whole packet instead of
+ * sending it to the Forwarder.
+ * With more than one forwarder shard, the dispatcher thread calls this function for each
+ * received packet before steering it with ndn_forwarder_shard_of(): the reassembly table and
+ * ndn_face_intf#reliability belong to no shard, so the forwarding threads do not touch them.
+ * IDLE packets and fragments of a packet not yet complete give no packet.
+ * @param self Input. The interface receiving the packet.
+ * @param packet Input. The wire format packet buffer.
+ * @param size Input. The size of the wire format packet buffer.
+ * @param buffer Output. The buffer receiving a reassembled packet, wrapped in an LpPacket if
+ *        it is a Nack.
+ * @param buffer_size Input. The size of @c buffer.
+ * @param whole Output. The whole packet: @c packet itself, @c buffer, or NULL if none.
+ * @param whole_size Output. The size of the whole packet, 0 if none.
+ * @return 0 if there is no error. NDN_OVERSIZE if a reassembled packet exceeds @c buffer.
+ */
+int
+ndn_face_reassemble(ndn_face_intf_t* self, const uint8_t* packet, uint32_t size,
+                    uint8_t* buffer, uint32_t buffer_size,
+                    const uint8_t** whole, uint32_t* whole_size);
+
+/**
+ * Send a frame of packets packed by an ndn_lp_aggregator_t to the Forwarder.
+ * The packets are processed together as bursts of ndn_forwarder_process_burst(), read in place.
+ * LpPackets carrying no whole packet, e.g. IDLE packets with an Ack, are handled on their own.
+ * @param self Input. The interface to transmit the packets to the forwarder.
+ * @param frame Input. The frame.
+ * @param size Input. The size of the frame.
+ * @return 0 if there is no error. NDN_WRONG_TLV_LENGTH if the frame ends with a truncated
+ *         packet, which is dropped.
+ */
+int
+ndn_face_receive_frame(ndn_face_intf_t* self, const uint8_t* frame, uint32_t size);
+
 /*@}*/
 
 #ifdef __cplusplus
@@ -0,0 +1,267 @@
+/*
+ * Copyright (C) 2018-2019 Zhiyi Zhang, Xinyu Ma
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include "fib.h"
+
+static void
+fib_reset(ndn_fib_t* fib)
+{
+  uint8_t* ptr = (uint8_t*)fib->entries + sizeof(ndn_fib_entry_t) * fib->capacity;
+  ndn_hash_index_init(&fib->index, ptr, fib->capacity);
+  ptr += NDN_HASH_INDEX_RESERVE_SIZE(fib->capacity);
+  ndn_name_arena_init(&fib->names, ptr, fib->capacity * NDN_FWD_NAME_BYTES_PER_ENTRY);
+  fib->free_head = NDN_HASH_INDEX_EMPTY;
+  for (uint32_t i = fib->capacity; i > 0; i--) {
+    fib->entries[i - 1].name_prefix = NULL;
+    fib->entries[i - 1].name_hash = fib->free_head;
+    fib->free_head = i - 1;
+  }
+  for (uint32_t i = 0; i <= NDN_NAME_VIEW_COMPONENTS_SIZE; i++) {
+    fib->length_count[i] = 0;
+  }
+}
+
+// Move the next-hop at pos to its place in the cost order
+static void
+fib_nexthop_sort(ndn_fib_entry_t* entry, uint8_t pos)
+{
+  ndn_fib_nexthop_t nexthop = entry->nexthops[pos];
+  while (pos > 0 && entry->nexthops[pos - 1].cost > nexthop.cost) {
+    entry->nexthops[pos] = entry->nexthops[pos - 1];
+    pos --;
+  }
+  while (pos + 1 < entry->nexthop_count && entry->nexthops[pos + 1].cost < nexthop.cost) {
+    entry->nexthops[pos] = entry->nexthops[pos + 1];
+    pos ++;
+  }
+  entry->nexthops[pos] = nexthop;
+}
+
+static void
+fib_add_nexthop(ndn_fib_entry_t* entry, ndn_face_intf_t* face, uint8_t cost)
+{
+  uint8_t pos;
+  for (pos = 0; pos < entry->nexthop_count; pos++) {
+    if (entry->nexthops[pos].face == face && entry->nexthops[pos].face_handle == face->handle)
+      break;
+  }
+  if (pos == entry->nexthop_count) {
+    if (entry->nexthop_count < NDN_FIB_MAX_NEXTHOPS) {
+      entry->nexthop_count ++;
+    }
+    else {
+      // replace the most expensive one
+      pos = entry->nexthop_count - 1;
+      if (cost >= entry->nexthops[pos].cost)
+        return;
+    }
+  }
+  entry->nexthops[pos].face = face;
+  entry->nexthops[pos].face_handle = face->handle;
+  entry->nexthops[pos].cost = cost;
+  fib_nexthop_sort(entry, pos);
+}
+
+void
+ndn_fib_init(ndn_fib_t* fib, void* memory, uint32_t capacity)
+{
+  fib->entries = (ndn_fib_entry_t*)memory;
+  fib->capacity = capacity;
+  fib_reset(fib);
+}
+
+ndn_fib_entry_t*
+ndn_fib_find_exact(ndn_fib_t* fib, const ndn_packed_name_t* name_prefix, uint32_t name_hash)
+{
+  uint32_t pos = ndn_hash_index_home(&fib->index, name_hash);
+  uint32_t i;
+  while ((i = ndn_hash_index_probe(&fib->index, name_hash, &pos)) != NDN_HASH_INDEX_EMPTY) {
+    if (ndn_packed_name_compare(fib->entries[i].name_prefix, name_prefix) == 0) {
+      return &fib->entries[i];
+    }
+    pos = (pos + 1) & fib->index.mask;
+  }
+  return NULL;
+}
+
+// Whether an entry has a next-hop on a face still in the face table
+static bool
+fib_entry_is_alive(const ndn_fib_entry_t* entry, const ndn_face_table_t* faces)
+{
+  for (uint8_t pos = 0; pos < entry->nexthop_count; pos++) {
+    if (ndn_face_table_is_alive(faces, entry->nexthops[pos].face_handle))
+      return true;
+  }
+  return false;
+}
+
+ndn_fib_entry_t*
+ndn_fib_lookup(ndn_fib_t* fib, const ndn_name_view_t* name, const ndn_face_table_t* faces, bool prune)
+{
+  for (uint32_t len = name->components_size + 1; len > 0; len--) {
+    if (fib->length_count[len - 1] == 0) {
+      continue;
+    }
+    uint32_t hash = name->prefix_hashes[len - 1];
+    uint32_t pos = ndn_hash_index_home(&fib->index, hash);
+    uint32_t i;
+    while ((i = ndn_hash_index_probe(&fib->index, hash, &pos)) != NDN_HASH_INDEX_EMPTY) {
+      if (ndn_name_view_prefix_equals(name, len - 1, fib->entries[i].name_prefix)) {
+        ndn_fib_entry_t* entry = &fib->entries[i];
+        // an entry left only with removed faces gives way to a shorter prefix
+        if (prune ? !ndn_fib_prune(fib, entry, faces) : fib_entry_is_alive(entry, faces)) {
+          return entry;
+        }
+        break;
+      }
+      pos = (pos + 1) & fib->index.mask;
+    }
+  }
+  return NULL;
+}
+
+ndn_fib_entry_t*
+ndn_fib_insert(ndn_fib_t* fib, const ndn_packed_name_t* name_prefix,
+               ndn_face_intf_t* face, uint8_t cost)
+{
+  if (name_prefix->components_size > NDN_NAME_VIEW_COMPONENTS_SIZE) {
+    return NULL;
+  }
+  uint32_t name_hash = ndn_packed_name_hash(name_prefix);
+
+  // already exists
+  ndn_fib_entry_t* entry = ndn_fib_find_exact(fib, name_prefix, name_hash);
+  if (entry != NULL) {
+    fib_add_nexthop(entry, face, cost);
+    return entry;
+  }
+
+  // find an unused fib entry
+  if (fib->free_head == NDN_HASH_INDEX_EMPTY) {
+    return NULL;
+  }
+  ndn_packed_name_t* copy = ndn_name_arena_copy(&fib->names, name_prefix);
+  if (copy == NULL) {
+    return NULL;
+  }
+  uint32_t i = fib->free_head;
+  entry = &fib->entries[i];
+  fib->free_head = entry->name_hash;
+
+  entry->name_prefix = copy;
+  entry->name_hash = name_hash;
+  entry->nexthop_count = 0;
+  fib_add_nexthop(entry, face, cost);
+  ndn_hash_index_insert(&fib->index, name_hash, i);
+  fib->length_count[name_prefix->components_size] ++;
+  return entry;
+}
+
+// Check that the routes fit in an empty FIB, before the FIB is emptied to load them.
+// Without merge, every route is counted as a new entry, which is enough most of the time
+// and avoids comparing all the prefixes with each other.
+static int
+fib_check_load(const ndn_fib_t* fib, const ndn_fib_route_t* routes, uint32_t count, bool merge,
+               void* buffer, uint32_t buffer_size)
+{
+  uint32_t free_counts[NDN_NAME_ARENA_CLASSES];
+  uint32_t entry_count = 0;
+  ndn_name_arena_plan_init(&fib->names, free_counts);
+  for (uint32_t i = 0; i < count; i++) {
+    uint32_t j = i;
+    if (merge) {
+      for (j = 0; j < i; j++) {
+        if (ndn_name_compare(routes[j].name_prefix, routes[i].name_prefix) == 0)
+          break;
+      }
+    }
+    if (j < i) {
+      // merged into the entry of an earlier route
+      continue;
+    }
+    const ndn_packed_name_t* name_prefix
+      = ndn_packed_name_from_name(routes[i].name_prefix, buffer, buffer_size);
+    if (name_prefix == NULL || name_prefix->components_size > NDN_NAME_VIEW_COMPONENTS_SIZE
+        || ++entry_count > fib->capacity
+        || !ndn_name_arena_plan_alloc(free_counts, ndn_packed_name_memory_size(name_prefix))) {
+      return NDN_FWD_FIB_FULL;
+    }
+  }
+  return 0;
+}
+
+int
+ndn_fib_load(ndn_fib_t* fib, const ndn_fib_route_t* routes, uint32_t count)
+{
+  uint16_t buffer[NDN_PACKED_NAME_BUFFER_SIZE / sizeof(uint16_t) + 1];
+  int ret = fib_check_load(fib, routes, count, false, buffer, sizeof(buffer));
+  if (ret != 0) {
+    ret = fib_check_load(fib, routes, count, true, buffer, sizeof(buffer));
+    if (ret != 0) return ret;
+  }
+  fib_reset(fib);
+  for (uint32_t i = 0; i < count; i++) {
+    const ndn_packed_name_t* name_prefix
+      = ndn_packed_name_from_name(routes[i].name_prefix, buffer, sizeof(buffer));
+    if (ndn_fib_insert(fib, name_prefix, routes[i].face, routes[i].cost) == NULL) {
+      return NDN_FWD_FIB_FULL;
+    }
+  }
+  return 0;
+}
+
+void
+ndn_fib_remove_nexthop(ndn_fib_t* fib, ndn_fib_entry_t* entry, const ndn_face_intf_t* face)
+{
+  for (uint8_t pos = 0; pos < entry->nexthop_count; pos++) {
+    if (entry->nexthops[pos].face == face) {
+      entry->nexthop_count --;
+      for (; pos < entry->nexthop_count; pos++) {
+        entry->nexthops[pos] = entry->nexthops[pos + 1];
+      }
+      break;
+    }
+  }
+  if (entry->nexthop_count == 0) {
+    ndn_fib_remove(fib, entry);
+  }
+}
+
+bool
+ndn_fib_prune(ndn_fib_t* fib, ndn_fib_entry_t* entry, const ndn_face_table_t* faces)
+{
+  uint8_t count = 0;
+  for (uint8_t pos = 0; pos < entry->nexthop_count; pos++) {
+    if (ndn_face_table_is_alive(faces, entry->nexthops[pos].face_handle)) {
+      entry->nexthops[count++] = entry->nexthops[pos];
+    }
+  }
+  entry->nexthop_count = count;
+  if (count == 0) {
+    ndn_fib_remove(fib, entry);
+    return true;
+  }
+  return false;
+}
+
+void
+ndn_fib_remove(ndn_fib_t* fib, ndn_fib_entry_t* entry)
+{
+  uint32_t i = (uint32_t)(entry - fib->entries);
+  if (entry->name_prefix == NULL) {
+    return;
+  }
+  ndn_hash_index_remove(&fib->index, entry->name_hash, i);
+  fib->length_count[entry->name_prefix->components_size] --;
+
+  ndn_name_arena_release(&fib->names, entry->name_prefix);
+  entry->name_prefix = NULL;
+  entry->nexthop_count = 0;
+  entry->name_hash = fib->free_head;
+  fib->free_head = i;
+}
@@ -10,7 +10,9 @@
 #define FORWARDER_FIB_H_
 
 #include "../encode/interest.h"
-#include "face.h"
+#include "../encode/name-view.h"
+#include "../util/hash-index.h"
+#include "face-table.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -22,42 +24,201 @@ extern "C" {
  * @{
  */
 
+/**
+ * FIB next-hop record.
+ */
+typedef struct ndn_fib_nexthop {
+  /**
+   * The next-hop face.
+   */
+  ndn_face_intf_t* face;
+  /**
+   * The handle of @c face when the route was added. The next-hop is stale once it no longer
+   * passes ndn_face_table_is_alive(), and @c face must not be dereferenced then.
+   */
+  ndn_face_handle_t face_handle;
+  /**
+   * The cost to the next-hop.
+   */
+  uint8_t cost;
+} ndn_fib_nexthop_t;
+
 /**
  * FIB entry.
  */
 typedef struct ndn_fib_entry {
   /**
-   * The name prefix.
-   * A name with <tt> ndn_name_t#components_size < 0 </tt> indicates an empty entry.
+   * The name prefix, allocated from the name arena of the FIB.
+   * NULL indicates an empty entry.
    */
-  ndn_name_t name_prefix;
+  ndn_packed_name_t* name_prefix;
 
   /**
-   * The next-hop record.
-   * @note Only one next-hop record per entry is allowed in NDN-Lite.
+   * The hash of @c name_prefix.
+   * For an empty entry, it links to the next free entry.
    */
-  ndn_face_intf_t* next_hop;
+  uint32_t name_hash;
 
   /**
-   * The cost to the next-hop.
+   * The next-hop records, sorted by cost in ascending order.
    */
-  uint8_t cost;
+  ndn_fib_nexthop_t nexthops[NDN_FIB_MAX_NEXTHOPS];
+
+  /**
+   * The number of next-hop records.
+   */
+  uint8_t nexthop_count;
 } ndn_fib_entry_t;
 
 /**
  * Forwarding Information Base (FIB) class.
+ * Prefixes are indexed by their hash. A lookup probes the prefixes of the Interest name
+ * from the longest to the shortest, skipping lengths that no entry has, so its cost is
+ * proportional to the name depth rather than to the table size.
+ */
+typedef struct ndn_fib {
+  /**
+   * The prefix hash index. Values are positions in @c entries.
+   */
+  ndn_hash_index_t index;
+  /**
+   * The entry array.
+   */
+  ndn_fib_entry_t* entries;
+  /**
+   * The head of the free entry list.
+   */
+  uint32_t free_head;
+  /**
+   * The max number of entries.
+   */
+  uint32_t capacity;
+  /**
+   * The number of entries per prefix length.
+   */
+  uint32_t length_count[NDN_NAME_VIEW_COMPONENTS_SIZE + 1];
+  /**
+   * The arena of entry prefixes.
+   */
+  ndn_name_arena_t names;
+} ndn_fib_t;
+
+/**
+ * A route used to bulk load the FIB.
+ */
+typedef struct ndn_fib_route {
+  /**
+   * The name prefix.
+   */
+  const ndn_name_t* name_prefix;
+  /**
+   * The next-hop face.
+   */
+  ndn_face_intf_t* face;
+  /**
+   * The cost to the next-hop.
+   */
+  uint8_t cost;
+} ndn_fib_route_t;
+
+/**
+ * The required memory to initialize a FIB holding up to @c capacity entries.
+ * @param capacity Input. The max number of FIB entries.
+ */
+#define NDN_FIB_RESERVE_SIZE(capacity) \
+    (sizeof(ndn_fib_entry_t) * (capacity) + NDN_HASH_INDEX_RESERVE_SIZE(capacity) \
+     + NDN_NAME_ARENA_RESERVE_SIZE((capacity) * NDN_FWD_NAME_BYTES_PER_ENTRY))
+
+/**
+ * Initialize an empty FIB.
+ * @pre NDN_FIB_RESERVE_SIZE(capacity) bytes needed.
+ * @param fib Output. The FIB to be inited.
+ * @param memory Input. The memory used to keep entries, index and prefixes.
+ *        It should be aligned to a pointer.
+ * @param capacity Input. The max number of FIB entries.
+ */
+void
+ndn_fib_init(ndn_fib_t* fib, void* memory, uint32_t capacity);
+
+/**
+ * Find the FIB entry whose prefix is exactly @c name_prefix.
+ * @param fib Input. The FIB.
+ * @param name_prefix Input. The name prefix.
+ * @param name_hash Input. The hash of @c name_prefix.
+ * @return The FIB entry. NULL if not found.
  */
-typedef ndn_fib_entry_t ndn_fib_t[NDN_FIB_MAX_SIZE];
+ndn_fib_entry_t*
+ndn_fib_find_exact(ndn_fib_t* fib, const ndn_packed_name_t* name_prefix, uint32_t name_hash);
+
+/**
+ * Longest prefix match, among the entries with a next-hop on a face still in the face table.
+ * The next-hops of removed faces are invalidated lazily here: with @c prune, they are removed
+ * from each entry matched, and an entry left without next-hop is deleted. Otherwise the FIB
+ * is only read, and an entry without live next-hop is skipped.
+ * @param fib Input/Output. The FIB.
+ * @param name Input. The Interest name.
+ * @param faces Input. The face table.
+ * @param prune Input. Whether the FIB may be modified.
+ * @return The FIB entry with the longest prefix of @c name. NULL if no entry matches.
+ */
+ndn_fib_entry_t*
+ndn_fib_lookup(ndn_fib_t* fib, const ndn_name_view_t* name, const ndn_face_table_t* faces, bool prune);
+
+/**
+ * Insert or update a route.
+ * If the entry already has @c face, its cost is updated. When the entry has
+ * NDN_FIB_MAX_NEXTHOPS next-hops, the most expensive one is replaced if @c cost is lower,
+ * otherwise the route is ignored.
+ * @param fib Input/Output. The FIB.
+ * @param name_prefix Input. The name prefix, copied into a new entry.
+ *        It has at most NDN_NAME_VIEW_COMPONENTS_SIZE components.
+ * @param face Input. The next-hop face.
+ * @param cost Input. The cost to the next-hop.
+ * @return The FIB entry. NULL if the FIB is out of entries or name memory, or the prefix
+ *         is too long.
+ */
+ndn_fib_entry_t*
+ndn_fib_insert(ndn_fib_t* fib, const ndn_packed_name_t* name_prefix,
+               ndn_face_intf_t* face, uint8_t cost);
+
+/**
+ * Replace the whole FIB content with a route set in one pass.
+ * @param fib Input/Output. The FIB.
+ * @param routes Input. The routes. Routes of the same prefix are merged as ndn_fib_insert() does.
+ * @param count Input. The number of routes.
+ * @return 0 if there is no error. NDN_FWD_FIB_FULL if the routes do not fit, and the FIB
+ *         is left unchanged.
+ */
+int
+ndn_fib_load(ndn_fib_t* fib, const ndn_fib_route_t* routes, uint32_t count);
+
+/**
+ * Remove a next-hop from a FIB entry. The entry is deleted when it has no next-hop left.
+ * @param fib Input/Output. The FIB.
+ * @param entry Input/Output. The FIB entry.
+ * @param face Input. The next-hop face to remove.
+ */
+void
+ndn_fib_remove_nexthop(ndn_fib_t* fib, ndn_fib_entry_t* entry, const ndn_face_intf_t* face);
+
+/**
+ * Remove the next-hops of an entry whose faces have been removed from the face table.
+ * The entry is deleted when it has no next-hop left.
+ * @param fib Input/Output. The FIB.
+ * @param entry Input/Output. The FIB entry.
+ * @param faces Input. The face table.
+ * @return true if the entry has been deleted.
+ */
+bool
+ndn_fib_prune(ndn_fib_t* fib, ndn_fib_entry_t* entry, const ndn_face_table_t* faces);
 
 /**
  * Delete a FIB entry.
+ * @param fib Input/Output. The FIB.
  * @param entry Input. The FIB entry.
  */
-static inline void
-fib_entry_delete(ndn_fib_entry_t* entry)
-{
-  entry->name_prefix.components_size = NDN_FWD_INVALID_NAME_SIZE;
-}
+void
+ndn_fib_remove(ndn_fib_t* fib, ndn_fib_entry_t* entry);
 
 /*@}*/
 
@@ -7,275 +7,1238 @@
  */
 
 #include "forwarder.h"
-#include "../util/memory-pool.h"
-#include "../encode/name.h"
+#include "../encode/name-view.h"
 #include "../encode/data.h"
-#include <stdio.h>
-
-#define NAME_POOL_LEN 4
-static uint8_t name_pool[NDN_MEMORY_POOL_RESERVE_SIZE(sizeof(ndn_name_t), NAME_POOL_LEN)];
+#include "../encode/lp.h"
+#include "../util/ndn-lite-alarm.h"
+#include "../util/trace.h"
+#include <string.h>
 
 static ndn_forwarder_t instance;
 
+static uint8_t pit_memory[NDN_PIT_RESERVE_SIZE(NDN_PIT_MAX_SIZE)] __attribute__((aligned(8)));
+static uint8_t face_table_memory[NDN_FACE_TABLE_RESERVE_SIZE(NDN_FACE_TABLE_MAX_SIZE)]
+  __attribute__((aligned(8)));
+static uint8_t fib_memory[NDN_FIB_RESERVE_SIZE(NDN_FIB_MAX_SIZE)] __attribute__((aligned(8)));
+static uint8_t strategy_choice_memory[NDN_STRATEGY_CHOICE_RESERVE_SIZE(NDN_STRATEGY_CHOICE_MAX_SIZE)]
+  __attribute__((aligned(8)));
+static uint8_t cs_memory[NDN_CS_RESERVE_SIZE(NDN_CS_MAX_SIZE, NDN_CS_BYTE_BUDGET)] __attribute__((aligned(8)));
+static uint8_t reassembly_memory[NDN_REASSEMBLY_RESERVE_SIZE(NDN_REASSEMBLY_MAX_SIZE, NDN_REASSEMBLY_BUFFER_SIZE)]
+  __attribute__((aligned(8)));
+
+// A Data to be returned downstream at the end of a burst
+typedef struct forwarder_tx {
+  ndn_face_intf_t* face;
+  const ndn_name_view_t* name;
+  const uint8_t* packet;
+  uint32_t size;
+  // the buffer keeping packet, NULL if none
+  ndn_pktbuf_t* buf;
+} forwarder_tx_t;
+
 ndn_forwarder_t*
 ndn_forwarder_get_instance(void)
 {
   return &instance;
 }
 
-static int
-forwarder_multicast_strategy(ndn_face_intf_t* face, ndn_name_t* name,
-                             const uint8_t* raw_interest, uint32_t size,
-                             const ndn_pit_entry_t* pit_entry);
-
 /************************************************************/
-/*  Definition of PIT table APIs                            */
+/*  Definition of packet parsing helpers                    */
 /************************************************************/
 
+// Skip the outer TL of a packet and read its Name in place.
+// The decoder is left at the element following the Name.
+static int
+forwarder_decode_name(ndn_decoder_t* decoder, const uint8_t* packet, uint32_t size, ndn_name_view_t* name)
+{
+  uint32_t probe = 0;
+  int ret = 0;
+  decoder_init(decoder, packet, size);
+  ret = decoder_get_type(decoder, &probe);
+  if (ret != NDN_SUCCESS) return ret;
+  ret = decoder_get_length(decoder, &probe);
+  if (ret != NDN_SUCCESS) return ret;
+  return ndn_name_view_tlv_decode(decoder, name);
+}
+
+// The Interest elements following the Name which the forwarder cares about.
+typedef struct forwarder_interest_options {
+  bool can_be_prefix;
+  bool must_be_fresh;
+  uint64_t lifetime;
+  // 0 if the Interest carries no Nonce
+  uint32_t nonce;
+  // the TLV-VALUE of the ForwardingHint, NULL if none
+  const uint8_t* forwarding_hint;
+  uint32_t forwarding_hint_size;
+  // the offset of the HopLimit value in the packet, 0 if the Interest carries no HopLimit
+  uint32_t hop_limit_offset;
+  uint8_t hop_limit;
+} forwarder_interest_options_t;
+
+// A packet of a burst between the stages
+typedef struct forwarder_burst_packet {
+  ndn_face_intf_t* face;
+  // the network layer packet, unwrapped from the LpPacket
+  const uint8_t* packet;
+  uint32_t size;
+  // the buffer keeping exactly packet, NULL if none
+  ndn_pktbuf_t* buf;
+  // TLV_Interest, TLV_Data, TLV_LpNack, 0 for packets taking the per-packet path,
+  // or TLV_Name for packets whose name fails to decode
+  uint32_t type;
+  uint8_t nack_reason;
+  int ret;
+  ndn_decoder_t decoder;
+  forwarder_interest_options_t options;
+} forwarder_burst_packet_t;
+
+// The working memory of a shard, so that shards driven by different threads share nothing
+typedef struct forwarder_scratch {
+  // CS entries are not contiguous, so a hit is reassembled here before sending
+  uint8_t cs_buffer[NDN_CS_MAX_DATA_SIZE];
+  uint8_t nack_buffer[NDN_LP_NACK_BUFFER_SIZE];
+  forwarder_tx_t tx_queue[NDN_FWD_TX_QUEUE_SIZE];
+  uint32_t tx_count;
+  bool tx_deferred;
+  forwarder_burst_packet_t burst[NDN_FWD_BURST_SIZE];
+  ndn_name_view_t burst_names[NDN_FWD_BURST_SIZE];
+  // an Interest whose HopLimit is decremented, when it cannot be patched in its own buffer
+  uint8_t interest_buffer[NDN_FWD_INTEREST_BUFFER_SIZE];
+  // the name handed to an application face, the only faces which need one
+  uint16_t app_name[NDN_FWD_APP_NAME_BUFFER_SIZE / sizeof(uint16_t)];
+  // counted since the last forwarder_publish_counters()
+  ndn_forwarder_counters_t counters;
+} forwarder_scratch_t;
+
+static forwarder_scratch_t scratch[NDN_FWD_MAX_SHARDS];
+
+static inline forwarder_scratch_t*
+forwarder_scratch(const ndn_forwarder_shard_t* shard)
+{
+  return &scratch[shard - instance.shards];
+}
+
+// Add the counts of a shard since the last call to its published counters.
+// Counting in the scratch keeps the shared cache line out of the per-packet path,
+// and the readers see the counters of a whole burst change at once.
 static void
-pit_table_init(void)
+forwarder_publish_counters(ndn_forwarder_shard_t* shard)
 {
-  for (uint8_t i = 0; i < NDN_PIT_MAX_SIZE; i++) {
-    instance.pit[i].interest_name.components_size = NDN_FWD_INVALID_NAME_SIZE;
+  ndn_counter_t* delta = (ndn_counter_t*)&forwarder_scratch(shard)->counters;
+  ndn_counter_t* counters = (ndn_counter_t*)&shard->counters;
+  uint32_t seq = __atomic_load_n(&shard->counters_seq, __ATOMIC_RELAXED);
+  __atomic_store_n(&shard->counters_seq, seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  for (uint32_t i = 0; i < sizeof(ndn_forwarder_counters_t) / sizeof(ndn_counter_t); i++) {
+    ndn_counter_add_local(&counters[i], (uint32_t)delta[i]);
+    delta[i] = 0;
   }
+  __atomic_store_n(&shard->counters_seq, seq + 2, __ATOMIC_RELEASE);
 }
 
-static ndn_pit_entry_t*
-pit_table_find_or_insert(ndn_name_t* name)
+// Read the published counters of a shard, retrying while they are being updated
+static void
+forwarder_read_counters(const ndn_forwarder_shard_t* shard, ndn_forwarder_counters_t* counters)
 {
-  // Find
-  for (uint8_t i = 0; i < NDN_PIT_MAX_SIZE; i++) {
-    if (ndn_name_compare(&instance.pit[i].interest_name, name) == 0) {
-      return &instance.pit[i];
+  const ndn_counter_t* src = (const ndn_counter_t*)&shard->counters;
+  ndn_counter_t* dst = (ndn_counter_t*)counters;
+  uint32_t seq = 0;
+  do {
+    seq = __atomic_load_n(&shard->counters_seq, __ATOMIC_ACQUIRE);
+    for (uint32_t i = 0; i < sizeof(ndn_forwarder_counters_t) / sizeof(ndn_counter_t); i++) {
+      dst[i] = ndn_counter_read(&src[i]);
     }
-  }
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  } while ((seq & 1) != 0 || __atomic_load_n(&shard->counters_seq, __ATOMIC_RELAXED) != seq);
+}
 
-  // Insert
-  for (uint8_t i = 0; i < NDN_PIT_MAX_SIZE; i++) {
-    if (instance.pit[i].interest_name.components_size == NDN_FWD_INVALID_NAME_SIZE) {
-      instance.pit[i].interest_name = *name;
-      instance.pit[i].incoming_face_size = 0;
-      return &instance.pit[i];
-    }
-  }
-  return NULL;
+// Map a name hash to a shard by its high bits. The name hash ends with a multiply-xorshift
+// round, so all its bits are well spread already; the low bits are left to the hash indexes
+// of the PIT and CS within a shard.
+static inline uint32_t
+forwarder_shard_index(uint32_t name_hash, uint32_t count)
+{
+  return (uint32_t)(((uint64_t)name_hash * count) >> 32);
 }
 
-/************************************************************/
-/*  Definition of FIB table APIs                            */
-/************************************************************/
+static inline ndn_forwarder_shard_t*
+forwarder_shard_of_hash(ndn_forwarder_t* self, uint32_t name_hash)
+{
+  return &self->shards[forwarder_shard_index(name_hash, self->shard_count)];
+}
 
-static void
-fib_table_init(void)
+// The shard whose PIT keeps an entry
+static ndn_forwarder_shard_t*
+forwarder_shard_of_entry(const ndn_pit_entry_t* entry)
 {
-  for (uint8_t i = 0; i < NDN_FIB_MAX_SIZE; i++) {
-    instance.fib[i].name_prefix.components_size = NDN_FWD_INVALID_NAME_SIZE;
+  for (uint32_t i = 1; i < instance.shard_count; i++) {
+    const ndn_pit_t* pit = &instance.shards[i].pit;
+    if (entry >= pit->entries && entry < pit->entries + pit->capacity)
+      return &instance.shards[i];
   }
+  return &instance.shards[0];
 }
 
-static ndn_fib_entry_t*
-fib_table_find(const ndn_name_t* name)
+// Read the Interest elements, with the decoder right after the Interest Name.
+static void
+forwarder_interest_options(ndn_decoder_t* decoder, forwarder_interest_options_t* options)
 {
-  for (uint8_t i = 0; i < NDN_FIB_MAX_SIZE; i++) {
-    if (ndn_name_is_prefix_of(&instance.fib[i].name_prefix, name) == 0) {
-      return &instance.fib[i];
+  uint32_t type = 0;
+  uint32_t length = 0;
+  options->can_be_prefix = false;
+  options->must_be_fresh = false;
+  options->lifetime = NDN_DEFAULT_INTEREST_LIFETIME;
+  options->nonce = 0;
+  options->forwarding_hint = NULL;
+  options->forwarding_hint_size = 0;
+  options->hop_limit_offset = 0;
+  options->hop_limit = 0;
+  while (decoder->offset < decoder->input_size) {
+    if (decoder_get_type(decoder, &type) != NDN_SUCCESS
+        || decoder_get_length(decoder, &length) != NDN_SUCCESS)
+      return;
+    if (type == TLV_CanBePrefix) {
+      options->can_be_prefix = true;
+    }
+    else if (type == TLV_MustBeFresh) {
+      options->must_be_fresh = true;
     }
+    else if (type == TLV_ForwardingHint) {
+      options->forwarding_hint = decoder->input_value + decoder->offset;
+      options->forwarding_hint_size = length;
+    }
+    else if (type == TLV_HopLimit && length == 1) {
+      options->hop_limit_offset = decoder->offset;
+      options->hop_limit = decoder->input_value[decoder->offset];
+    }
+    else if (type == TLV_Nonce) {
+      if (decoder_get_uint32_value(decoder, &options->nonce) != NDN_SUCCESS)
+        return;
+      continue;
+    }
+    else if (type == TLV_InterestLifetime) {
+      if (decoder_get_uint_value(decoder, length, &options->lifetime) != NDN_SUCCESS)
+        return;
+      continue;
+    }
+    if (decoder_move_forward(decoder, length) != NDN_SUCCESS)
+      return;
   }
-  return NULL;
 }
 
-// static ndn_fib_entry_t*
-// fib_table_find_by_face(const ndn_face_intf_t* face)
-// {
-//   for (uint8_t i = 0; i < NDN_FIB_MAX_SIZE; i++) {
-//     if (instance.fib[i].name_prefix.components_size != NDN_FWD_INVALID_NAME_SIZE
-//         && instance.fib[i].next_hop == face) {
-//       return &instance.fib[i];
-//     }
-//   }
-//   return NULL;
-// }
+// Read FreshnessPeriod, with the decoder right after the Data Name.
+// A Data without FreshnessPeriod has a freshness period of 0.
+static int
+forwarder_data_freshness(ndn_decoder_t* decoder, uint64_t* freshness_period)
+{
+  uint32_t type = 0;
+  uint32_t length = 0;
+  int ret = 0;
+  *freshness_period = 0;
+  if (decoder->offset >= decoder->input_size)
+    return 0;
+  ret = decoder_get_type(decoder, &type);
+  if (ret != NDN_SUCCESS) return ret;
+  ret = decoder_get_length(decoder, &length);
+  if (ret != NDN_SUCCESS) return ret;
+  if (type != TLV_MetaInfo)
+    return 0;
+  uint32_t end = decoder->offset + length;
+  while (decoder->offset < end) {
+    ret = decoder_get_type(decoder, &type);
+    if (ret != NDN_SUCCESS) return ret;
+    ret = decoder_get_length(decoder, &length);
+    if (ret != NDN_SUCCESS) return ret;
+    if (type == TLV_FreshnessPeriod)
+      return decoder_get_uint_value(decoder, length, freshness_period);
+    ret = decoder_move_forward(decoder, length);
+    if (ret != NDN_SUCCESS) return ret;
+  }
+  return 0;
+}
 
 /************************************************************/
 /*  Definition of forwarder APIs                            */
 /************************************************************/
 
-// Send data packet out
+// The name to give a face along with a packet. Only application faces look at it,
+// so the name is copied out of the packet for them alone.
+static const ndn_packed_name_t*
+forwarder_face_name(forwarder_scratch_t* work, const ndn_face_intf_t* face, const ndn_name_view_t* name)
+{
+  if (face->type != NDN_FACE_TYPE_APP) {
+    return NULL;
+  }
+  return ndn_name_view_to_packed(name, work->app_name, sizeof(work->app_name));
+}
+
+// Send data packet out, by reference if it is kept in a packet buffer
 static int
-ndn_forwarder_on_outgoing_data(ndn_face_intf_t* face, const ndn_name_t* name,
-                               const uint8_t* raw_data, uint32_t size)
+ndn_forwarder_on_outgoing_data(forwarder_scratch_t* work, ndn_face_intf_t* face, const ndn_packed_name_t* name,
+                               const uint8_t* raw_data, uint32_t size, ndn_pktbuf_t* buf)
 {
+  work->counters.out_data ++;
+  ndn_counter_add(&face->counters.out_data, 1);
+  if (buf != NULL) {
+    return ndn_face_send_pktbuf(face, name, buf);
+  }
   return ndn_face_send(face, name, raw_data, size);
 }
 
 // Send interest packet out
 static int
-ndn_forwarder_on_outgoing_interest(ndn_face_intf_t* face, const ndn_name_t* name,
-                                   const uint8_t* raw_interest, uint32_t size)
+ndn_forwarder_on_outgoing_interest(forwarder_scratch_t* work, ndn_face_intf_t* face,
+                                   const ndn_name_view_t* name, const uint8_t* raw_interest, uint32_t size)
+{
+  work->counters.out_interests ++;
+  ndn_counter_add(&face->counters.out_interests, 1);
+  return ndn_face_send(face, forwarder_face_name(work, face, name), raw_interest, size);
+}
+
+// Send a Nack out
+static int
+forwarder_send_nack(forwarder_scratch_t* work, ndn_face_intf_t* face, const ndn_name_view_t* name,
+                    const uint8_t* raw_interest, uint32_t size, uint32_t nonce, uint8_t reason)
+{
+  NDN_TRACE_DEBUG(NDN_TRACE_EVENT_NACK_OUT, face->face_id, ndn_name_view_hash(name), reason);
+  work->counters.out_nacks ++;
+  ndn_counter_add(&face->counters.out_nacks, 1);
+  return ndn_face_send_nack(face, forwarder_face_name(work, face, name), raw_interest, size, nonce, reason,
+                            work->nack_buffer, sizeof(work->nack_buffer));
+}
+
+// Send the queued Data, all packets of a face together
+static void
+forwarder_flush_tx(forwarder_scratch_t* work)
+{
+  forwarder_tx_t* tx_queue = work->tx_queue;
+  uint32_t tx_count = work->tx_count;
+  for (uint32_t i = 0; i < tx_count; i++) {
+    ndn_face_intf_t* face = tx_queue[i].face;
+    if (face == NULL)
+      continue;
+    for (uint32_t j = i; j < tx_count; j++) {
+      if (tx_queue[j].face == face) {
+        ndn_forwarder_on_outgoing_data(work, face, forwarder_face_name(work, face, tx_queue[j].name),
+                                       tx_queue[j].packet, tx_queue[j].size, tx_queue[j].buf);
+        tx_queue[j].face = NULL;
+      }
+    }
+  }
+  work->tx_count = 0;
+}
+
+// Send a Data downstream, or queue it while a burst is processed
+static int
+forwarder_return_data(forwarder_scratch_t* work, ndn_face_intf_t* face, const ndn_name_view_t* name,
+                      const uint8_t* raw_data, uint32_t size, ndn_pktbuf_t* buf)
+{
+  if (!work->tx_deferred) {
+    return ndn_forwarder_on_outgoing_data(work, face, forwarder_face_name(work, face, name),
+                                          raw_data, size, buf);
+  }
+  if (work->tx_count == NDN_FWD_TX_QUEUE_SIZE) {
+    forwarder_flush_tx(work);
+  }
+  forwarder_tx_t* tx = &work->tx_queue[work->tx_count];
+  tx->face = face;
+  tx->name = name;
+  tx->packet = raw_data;
+  tx->size = size;
+  tx->buf = buf;
+  work->tx_count ++;
+  return 0;
+}
+
+// Whether a wire format Interest carries a HopLimit of 0. The forwarder decrements the
+// HopLimit before the strategy sees the Interest, so it may then only reach applications.
+static bool
+forwarder_interest_out_of_hops(const uint8_t* raw_interest, uint32_t size)
+{
+  ndn_decoder_t decoder;
+  forwarder_interest_options_t options;
+  uint32_t probe = 0;
+  decoder_init(&decoder, raw_interest, size);
+  if (decoder_get_type(&decoder, &probe) != NDN_SUCCESS
+      || decoder_get_length(&decoder, &probe) != NDN_SUCCESS
+      || decoder_get_type(&decoder, &probe) != NDN_SUCCESS
+      || decoder_get_length(&decoder, &probe) != NDN_SUCCESS
+      || decoder_move_forward(&decoder, probe) != NDN_SUCCESS)
+    return false;
+  forwarder_interest_options(&decoder, &options);
+  return options.hop_limit_offset != 0 && options.hop_limit == 0;
+}
+
+int
+ndn_forwarder_forward_interest(ndn_face_intf_t* face, const ndn_name_view_t* name,
+                               const uint8_t* raw_interest, uint32_t size,
+                               ndn_pit_entry_t* pit_entry, uint32_t nonce, uint64_t now)
+{
+  ndn_forwarder_shard_t* shard = forwarder_shard_of_entry(pit_entry);
+  if (face->type != NDN_FACE_TYPE_APP && forwarder_interest_out_of_hops(raw_interest, size)) {
+    return NDN_FWD_HOP_LIMIT_EXCEEDED;
+  }
+  NDN_TRACE_DEBUG(NDN_TRACE_EVENT_INTEREST_OUT, face->face_id, pit_entry->name_hash, 0);
+  int ret = ndn_forwarder_on_outgoing_interest(forwarder_scratch(shard), face, name, raw_interest, size);
+  if (ret != 0) {
+    return ret;
+  }
+  ndn_pit_add_out_record(&shard->pit, pit_entry, face, nonce, now);
+  return 0;
+}
+
+// Remember the Nonces of a PIT entry which is going away, so that the same
+// Interest coming back later is recognized as a loop
+static void
+forwarder_pit_entry_to_dnl(ndn_forwarder_shard_t* shard, ndn_pit_entry_t* entry, uint64_t now)
 {
-  return ndn_face_send(face, name, raw_interest, size);
+  for (ndn_pit_face_record_t* record = entry->in_records; record != NULL; record = record->next) {
+    if (record->nonce != 0)
+      ndn_dnl_insert(&shard->dnl, entry->name_hash, record->nonce, now);
+  }
+  for (ndn_pit_face_record_t* record = entry->out_records; record != NULL; record = record->next) {
+    if (record->nonce != 0)
+      ndn_dnl_insert(&shard->dnl, entry->name_hash, record->nonce, now);
+  }
+}
+
+// Tell the downstream faces that the Interest expired
+static void
+forwarder_on_pit_expire(ndn_pit_t* pit, ndn_pit_entry_t* entry)
+{
+  ndn_forwarder_shard_t* shard = container_of(pit, ndn_forwarder_shard_t, pit);
+  uint64_t now = ndn_alarm_millis_get_now();
+  NDN_TRACE_DEBUG(NDN_TRACE_EVENT_PIT_EXPIRE, 0, entry->name_hash, 0);
+  forwarder_scratch(shard)->counters.pit_expired ++;
+  if (entry->strategy != NULL && entry->strategy->on_timeout != NULL) {
+    entry->strategy->on_timeout(&instance, entry, now);
+  }
+  forwarder_pit_entry_to_dnl(shard, entry, now);
+  for (ndn_pit_in_record_t* record = entry->in_records; record != NULL; record = record->next) {
+    if (!ndn_face_table_is_alive(&instance.face_table, record->face_handle))
+      continue;
+    if (record->face->on_interest_timeout != NULL) {
+      record->face->on_interest_timeout(record->face, entry->interest_name);
+    }
+  }
+  forwarder_publish_counters(shard);
+}
+
+// (Re)initialize the PIT of a shard, keeping the way its wheel is driven
+static void
+forwarder_shard_init_pit(ndn_forwarder_shard_t* shard, void* memory, uint32_t capacity)
+{
+  if (shard->pit.capacity > 0) {
+    ndn_timer_stop(&shard->pit.wheel.timer);
+  }
+  ndn_pit_init(&shard->pit, memory, capacity, forwarder_on_pit_expire);
+  if (instance.shard_count > 1 && shard < instance.shards + instance.shard_count) {
+    ndn_timer_wheel_set_manual(&shard->pit.wheel, true);
+  }
 }
 
 ndn_forwarder_t*
 ndn_forwarder_init(void)
 {
-  ndn_memory_pool_init(name_pool, sizeof(ndn_name_t), NAME_POOL_LEN);
-  pit_table_init();
-  fib_table_init();
+  instance.shard_count = 1;
+  for (uint32_t i = 0; i < NDN_FWD_MAX_SHARDS; i++) {
+    scratch[i].tx_count = 0;
+    scratch[i].tx_deferred = false;
+  }
+  forwarder_shard_init_pit(&instance.shards[0], pit_memory, NDN_PIT_MAX_SIZE);
+  ndn_face_table_init(&instance.face_table, face_table_memory, NDN_FACE_TABLE_MAX_SIZE);
+  ndn_reassembly_init(&instance.reassembly, reassembly_memory, NDN_REASSEMBLY_MAX_SIZE,
+                      NDN_REASSEMBLY_BUFFER_SIZE);
+  ndn_fib_init(&instance.fib, fib_memory, NDN_FIB_MAX_SIZE);
+  ndn_cs_init(&instance.shards[0].cs, cs_memory, NDN_CS_MAX_SIZE, NDN_CS_BYTE_BUDGET);
+  ndn_dnl_init(&instance.shards[0].dnl, ndn_alarm_millis_get_now());
+  ndn_strategy_choice_init(&instance.strategy_choice, strategy_choice_memory,
+                           NDN_STRATEGY_CHOICE_MAX_SIZE, &ndn_strategy_best_route);
   return &instance;
 }
 
 int
-ndn_forwarder_fib_insert(const ndn_name_t* name_prefix,
-                         ndn_face_intf_t* face, uint8_t cost)
+ndn_forwarder_set_pit_capacity(void* memory, uint32_t capacity)
+{
+  if (memory == NULL || capacity == 0) {
+    return NDN_FWD_NO_MEM;
+  }
+  forwarder_shard_init_pit(&instance.shards[0], memory, capacity);
+  return 0;
+}
+
+int
+ndn_forwarder_set_fib_capacity(void* memory, uint32_t capacity)
 {
-  // already exists
-  for (uint8_t i = 0; i < NDN_FIB_MAX_SIZE; i++) {
-    if (ndn_name_compare(&instance.fib[i].name_prefix, name_prefix) == 0
-        && instance.fib[i].next_hop == face) {
-      if (face->state != NDN_FACE_STATE_UP)
-        ndn_face_up(face);
-      return 0;
+  if (memory == NULL || capacity == 0) {
+    return NDN_FWD_NO_MEM;
+  }
+  ndn_fib_init(&instance.fib, memory, capacity);
+  return 0;
+}
+
+int
+ndn_forwarder_set_cs_capacity(void* memory, uint32_t capacity, uint32_t byte_budget)
+{
+  if (memory == NULL || capacity == 0) {
+    return NDN_FWD_NO_MEM;
+  }
+  ndn_cs_init(&instance.shards[0].cs, memory, capacity, byte_budget);
+  return 0;
+}
+
+int
+ndn_forwarder_setup_shard(uint32_t shard, void* pit_memory, uint32_t pit_capacity,
+                          void* cs_memory, uint32_t cs_capacity, uint32_t cs_byte_budget)
+{
+  if (shard >= NDN_FWD_MAX_SHARDS) {
+    return NDN_FWD_INVALID_SHARD;
+  }
+  if (pit_memory == NULL || pit_capacity == 0 || cs_memory == NULL || cs_capacity == 0) {
+    return NDN_FWD_NO_MEM;
+  }
+  forwarder_shard_init_pit(&instance.shards[shard], pit_memory, pit_capacity);
+  ndn_cs_init(&instance.shards[shard].cs, cs_memory, cs_capacity, cs_byte_budget);
+  ndn_dnl_init(&instance.shards[shard].dnl, ndn_alarm_millis_get_now());
+  return 0;
+}
+
+int
+ndn_forwarder_set_shard_count(uint32_t count)
+{
+  if (count == 0 || count > NDN_FWD_MAX_SHARDS) {
+    return NDN_FWD_INVALID_SHARD;
+  }
+  for (uint32_t i = 0; i < count; i++) {
+    if (instance.shards[i].pit.capacity == 0 || instance.shards[i].cs.capacity == 0) {
+      return NDN_FWD_INVALID_SHARD;
+    }
+  }
+  // the shard threads drive their own wheels, the single shard is driven by the timer scheduler
+  for (uint32_t i = 0; i < NDN_FWD_MAX_SHARDS; i++) {
+    if (instance.shards[i].pit.capacity > 0) {
+      ndn_timer_wheel_set_manual(&instance.shards[i].pit.wheel, count > 1);
     }
   }
+  instance.shard_count = count;
+  return 0;
+}
 
-  // find an unused fib entry
-  for (uint8_t i = 0; i < NDN_FIB_MAX_SIZE; i++) {
-    if (instance.fib[i].name_prefix.components_size == NDN_FWD_INVALID_NAME_SIZE) {
-      instance.fib[i].name_prefix = *name_prefix;
-      instance.fib[i].next_hop = face;
-      instance.fib[i].cost = cost;
-      ndn_face_up(face);
+// The shard of a received packet, or -1 for a fragment, an IDLE packet or a packet failing
+// to decode, which are left to ndn_face_receive()
+static int
+forwarder_steer(const uint8_t* packet, uint32_t size)
+{
+  ndn_lp_packet_t lp_packet;
+  ndn_decoder_t decoder;
+  ndn_name_view_t name;
+  if (ndn_lp_packet_from_block(&lp_packet, packet, size) != NDN_SUCCESS
+      || lp_packet.fragment == NULL
+      || (lp_packet.enable_FragCount && lp_packet.frag_count > 1)) {
+    return -1;
+  }
+  if (forwarder_decode_name(&decoder, lp_packet.fragment, lp_packet.fragment_size, &name) != 0) {
+    return 0;
+  }
+  return (int)forwarder_shard_index(ndn_name_view_hash(&name), instance.shard_count);
+}
 
-      printf("Forwarder: successfully insert FIB\n");
+uint32_t
+ndn_forwarder_shard_of(const uint8_t* packet, uint32_t size)
+{
+  int shard = 0;
+  if (instance.shard_count <= 1) {
+    return 0;
+  }
+  shard = forwarder_steer(packet, size);
+  return (shard < 0) ? 0 : (uint32_t)shard;
+}
+
+void
+ndn_forwarder_shard_advance(ndn_forwarder_t* self, uint32_t shard, uint64_t now)
+{
+  if (shard < self->shard_count) {
+    ndn_timer_wheel_advance(&self->shards[shard].pit.wheel, now);
+  }
+}
 
-      return 0;
+void
+ndn_forwarder_get_stats(ndn_forwarder_stats_t* stats)
+{
+  ndn_counter_t* total = (ndn_counter_t*)&stats->counters;
+  ndn_forwarder_counters_t counters;
+  uint32_t shard_count = __atomic_load_n(&instance.shard_count, __ATOMIC_RELAXED);
+
+  memset(stats, 0, sizeof(ndn_forwarder_stats_t));
+  for (uint32_t i = 0; i < shard_count; i++) {
+    const ndn_forwarder_shard_t* shard = &instance.shards[i];
+    forwarder_read_counters(shard, &counters);
+    for (uint32_t j = 0; j < sizeof(ndn_forwarder_counters_t) / sizeof(ndn_counter_t); j++) {
+      total[j] += ((const ndn_counter_t*)&counters)[j];
     }
+    stats->pit_entries += __atomic_load_n(&shard->pit.index.size, __ATOMIC_RELAXED);
+    stats->cs_entries += __atomic_load_n(&shard->cs.index.size, __ATOMIC_RELAXED);
   }
-  return NDN_FWD_FIB_FULL;
+  stats->fib_entries = __atomic_load_n(&instance.fib.index.size, __ATOMIC_RELAXED);
+  stats->faces = __atomic_load_n(&instance.face_table.count, __ATOMIC_RELAXED);
 }
 
 int
-ndn_forwarder_on_incoming_data(ndn_forwarder_t* self, ndn_face_intf_t* face, ndn_name_t *name,
-                               const uint8_t* raw_data, uint32_t size)
+ndn_forwarder_set_face_table_capacity(void* memory, uint32_t capacity)
 {
-  (void)face;
-  bool bypass = (name != NULL);
+  if (memory == NULL || capacity == 0) {
+    return NDN_FWD_NO_MEM;
+  }
+  ndn_face_table_init(&instance.face_table, memory, capacity);
+  return 0;
+}
 
-  // If no bypass data, we need to decode it manually
-  if (!bypass) {
-    // Allocate memory
-    name = (ndn_name_t*)ndn_memory_pool_alloc(name_pool);
-    if (!name) {
-      return NDN_FWD_NO_MEM;
-    }
-    // Decode name only
-    ndn_decoder_t decoder;
-    uint32_t probe = 0;
-    int ret = 0;
-    decoder_init(&decoder, raw_data, size);
-    ret = decoder_get_type(&decoder, &probe);
-    ret = decoder_get_length(&decoder, &probe);
-    ret = ndn_name_tlv_decode(&decoder, name);
-    if (ret < 0) {
-      ndn_memory_pool_free(name_pool, name);
-      return ret;
+int
+ndn_forwarder_set_reassembly_capacity(void* memory, uint32_t capacity, uint32_t buffer_size)
+{
+  if (memory == NULL || capacity == 0 || buffer_size == 0) {
+    return NDN_FWD_NO_MEM;
+  }
+  ndn_reassembly_init(&instance.reassembly, memory, capacity, buffer_size);
+  return 0;
+}
+
+ndn_face_handle_t
+ndn_forwarder_add_face(ndn_face_intf_t* face)
+{
+  if (ndn_face_table_get(&instance.face_table, face->handle) == face) {
+    return face->handle;
+  }
+  return ndn_face_table_register(&instance.face_table, face);
+}
+
+void
+ndn_forwarder_remove_face(ndn_face_intf_t* face)
+{
+  ndn_reassembly_remove_face(&instance.reassembly, face);
+  ndn_face_table_unregister(&instance.face_table, face->handle);
+}
+
+ndn_face_intf_t*
+ndn_forwarder_get_face(ndn_face_handle_t handle)
+{
+  return ndn_face_table_get(&instance.face_table, handle);
+}
+
+int
+ndn_forwarder_fib_insert(const ndn_name_t* name_prefix,
+                         ndn_face_intf_t* face, uint8_t cost)
+{
+  uint16_t buffer[NDN_PACKED_NAME_BUFFER_SIZE / sizeof(uint16_t) + 1];
+  const ndn_packed_name_t* packed = ndn_packed_name_from_name(name_prefix, buffer, sizeof(buffer));
+  uint32_t name_hash = ndn_packed_name_hash(packed);
+
+  if (ndn_forwarder_add_face(face) == NDN_FACE_HANDLE_NONE) {
+    return NDN_FWD_FACE_TABLE_FULL;
+  }
+  // Make room taken by removed faces
+  ndn_fib_entry_t* entry = ndn_fib_find_exact(&instance.fib, packed, name_hash);
+  if (entry != NULL) {
+    ndn_fib_prune(&instance.fib, entry, &instance.face_table);
+  }
+  if (ndn_fib_insert(&instance.fib, packed, face, cost) == NULL) {
+    return NDN_FWD_FIB_FULL;
+  }
+  if (face->state != NDN_FACE_STATE_UP)
+    ndn_face_up(face);
+  NDN_TRACE_INFO(NDN_TRACE_EVENT_FIB_INSERT, face->face_id, name_hash, cost);
+
+  return 0;
+}
+
+int
+ndn_forwarder_fib_load(const ndn_fib_route_t* routes, uint32_t count)
+{
+  for (uint32_t i = 0; i < count; i++) {
+    if (ndn_forwarder_add_face(routes[i].face) == NDN_FACE_HANDLE_NONE) {
+      return NDN_FWD_FACE_TABLE_FULL;
     }
   }
+  int ret = ndn_fib_load(&instance.fib, routes, count);
+  if (ret != 0) {
+    return ret;
+  }
+  for (uint32_t i = 0; i < count; i++) {
+    if (routes[i].face->state != NDN_FACE_STATE_UP)
+      ndn_face_up(routes[i].face);
+  }
+  return 0;
+}
+
+int
+ndn_forwarder_set_strategy(const ndn_name_t* name_prefix, const ndn_strategy_t* strategy)
+{
+  uint16_t buffer[NDN_PACKED_NAME_BUFFER_SIZE / sizeof(uint16_t) + 1];
+  return ndn_strategy_choice_set(&instance.strategy_choice,
+                                 ndn_packed_name_from_name(name_prefix, buffer, sizeof(buffer)),
+                                 strategy);
+}
+
+void
+ndn_forwarder_unset_strategy(const ndn_name_t* name_prefix)
+{
+  uint16_t buffer[NDN_PACKED_NAME_BUFFER_SIZE / sizeof(uint16_t) + 1];
+  ndn_strategy_choice_unset(&instance.strategy_choice,
+                            ndn_packed_name_from_name(name_prefix, buffer, sizeof(buffer)));
+}
+
+// Process a Data whose name has been read and hashed.
+// The decoder is left right after the Data Name. buf is the buffer keeping exactly raw_data, or NULL.
+static int
+forwarder_process_data(ndn_forwarder_t* self, ndn_forwarder_shard_t* shard, ndn_face_intf_t* face,
+                       const ndn_name_view_t* name, ndn_decoder_t* decoder,
+                       const uint8_t* raw_data, uint32_t size, ndn_pktbuf_t* buf)
+{
+  forwarder_scratch_t* work = forwarder_scratch(shard);
+  NDN_TRACE_DEBUG(NDN_TRACE_EVENT_DATA_IN, face->face_id, ndn_name_view_hash(name), (int32_t)size);
+  work->counters.in_data ++;
+  ndn_counter_add(&face->counters.in_data, 1);
 
   // Match with pit
-  for (uint8_t i = 0; i < NDN_PIT_MAX_SIZE; i++) {
-    if (ndn_name_compare(&self->pit[i].interest_name, name) == 0) {
-      // Send out data
-      for (uint8_t j = 0; j < self->pit[i].incoming_face_size; j++) {
-        ndn_forwarder_on_outgoing_data(self->pit[i].incoming_face[j], name, raw_data, size);
+  ndn_pit_entry_t* pit_entry = ndn_pit_find(&shard->pit, name);
+  if (pit_entry == NULL) {
+    work->counters.pit_misses ++;
+    return 0;
+  }
+  work->counters.pit_hits ++;
+  uint64_t now = ndn_alarm_millis_get_now();
+  // Cache the solicited Data
+  // the decoder moves on while parsing, so the freshness is parsed once for both ways
+  uint64_t freshness_period = 0;
+  if (forwarder_data_freshness(decoder, &freshness_period) == 0) {
+    if (buf != NULL)
+      ndn_cs_insert_pktbuf(&shard->cs, name, buf, now + freshness_period);
+    else if (size <= NDN_CS_MAX_DATA_SIZE)
+      ndn_cs_insert(&shard->cs, name, raw_data, size, now + freshness_period);
+  }
+  if (pit_entry->strategy != NULL && pit_entry->strategy->after_receive_data != NULL) {
+    pit_entry->strategy->after_receive_data(self, face, pit_entry, raw_data, size, now);
+  }
+  // Send out data
+  for (ndn_pit_in_record_t* record = pit_entry->in_records; record != NULL; record = record->next) {
+    if (!ndn_face_table_is_alive(&self->face_table, record->face_handle))
+      continue;
+    NDN_TRACE_DEBUG(NDN_TRACE_EVENT_DATA_OUT, record->face->face_id, ndn_name_view_hash(name), (int32_t)size);
+    forwarder_return_data(work, record->face, name, raw_data, size, buf);
+  }
+  // Delete PIT Entry
+  forwarder_pit_entry_to_dnl(shard, pit_entry, now);
+  ndn_pit_remove(&shard->pit, pit_entry);
+  return 0;
+}
+
+// Longest prefix match for an Interest. When no route matches its name, the Interest is
+// forwarded towards the first Delegation of its ForwardingHint which has a route; Delegations
+// are listed by Preference.
+static ndn_fib_entry_t*
+forwarder_fib_lookup(ndn_forwarder_t* self, const ndn_name_view_t* name,
+                     const forwarder_interest_options_t* options)
+{
+  // the FIB is shared by the forwarding threads, which only read it
+  bool prune = (self->shard_count <= 1);
+  ndn_fib_entry_t* entry = ndn_fib_lookup(&self->fib, name, &self->face_table, prune);
+  if (entry != NULL || options->forwarding_hint == NULL) {
+    return entry;
+  }
+
+  ndn_decoder_t decoder;
+  ndn_name_view_t delegation;
+  uint32_t type = 0;
+  uint32_t length = 0;
+  decoder_init(&decoder, options->forwarding_hint, options->forwarding_hint_size);
+  while (decoder.offset < decoder.input_size) {
+    if (decoder_get_type(&decoder, &type) != NDN_SUCCESS
+        || decoder_get_length(&decoder, &length) != NDN_SUCCESS
+        || length > decoder.input_size - decoder.offset)
+      return NULL;
+    uint32_t next = decoder.offset + length;
+    // skip the Preference, then read the Name
+    if (type == TLV_Delegation
+        && decoder_get_type(&decoder, &type) == NDN_SUCCESS && type == TLV_Preference
+        && decoder_get_length(&decoder, &length) == NDN_SUCCESS
+        && decoder_move_forward(&decoder, length) == NDN_SUCCESS
+        && ndn_name_view_tlv_decode(&decoder, &delegation) == 0) {
+      entry = ndn_fib_lookup(&self->fib, &delegation, &self->face_table, prune);
+      if (entry != NULL) {
+        return entry;
       }
-      // Delete PIT Entry
-      pit_entry_delete(&self->pit[i]);
-      break;
     }
+    decoder.offset = next;
   }
+  return NULL;
+}
 
-  // Free memory
-  if (!bypass) {
-    ndn_memory_pool_free(name_pool, name);
+// Take one hop off the HopLimit of an Interest, patching the byte in the wire format.
+// The packet is patched in place when it is alone in its buffer, otherwise in a copy.
+// raw_interest is updated to the packet to forward.
+static int
+forwarder_decrement_hop_limit(forwarder_scratch_t* work, const forwarder_interest_options_t* options,
+                              const uint8_t** raw_interest, uint32_t size, ndn_pktbuf_t* buf)
+{
+  if (buf != NULL && buf->data == *raw_interest && !ndn_pktbuf_is_shared(buf)) {
+    buf->data[options->hop_limit_offset] = options->hop_limit - 1;
+    return 0;
   }
-
+  if (size > sizeof(work->interest_buffer)) {
+    return NDN_OVERSIZE;
+  }
+  memcpy(work->interest_buffer, *raw_interest, size);
+  work->interest_buffer[options->hop_limit_offset] = options->hop_limit - 1;
+  *raw_interest = work->interest_buffer;
   return 0;
 }
 
-int
-ndn_forwarder_on_incoming_interest(ndn_forwarder_t* self, ndn_face_intf_t* face, ndn_name_t* name,
-                                   const uint8_t* raw_interest, uint32_t size)
+// Process an Interest whose name has been read and hashed
+static int
+forwarder_process_interest(ndn_forwarder_t* self, ndn_forwarder_shard_t* shard, ndn_face_intf_t* face,
+                           const ndn_name_view_t* name, const forwarder_interest_options_t* options,
+                           const uint8_t* raw_interest, uint32_t size, ndn_pktbuf_t* buf)
 {
-  printf("Forwarder: on Interest\n");
-
-  (void)self;
+  forwarder_scratch_t* work = forwarder_scratch(shard);
   int ret = 0;
-  bool bypass = (name != NULL);
-
-  // If no bypass interest, we need to decode it manually
-  if (!bypass) {
-    // Allocate memory
-    // A name is expensive, don't want to do it on stack
-    name = (ndn_name_t*)ndn_memory_pool_alloc(name_pool);
-    if (!name) {
-      return NDN_FWD_NO_MEM;
+  uint64_t now = ndn_alarm_millis_get_now();
+  uint32_t name_hash = ndn_name_view_hash(name);
+  NDN_TRACE_DEBUG(NDN_TRACE_EVENT_INTEREST_IN, face->face_id, name_hash, (int32_t)size);
+  work->counters.in_interests ++;
+  ndn_counter_add(&face->counters.in_interests, 1);
+
+  // Drop an Interest out of hops, unless an application sends it to a local producer
+  bool hop_limit_exhausted = false;
+  if (options->hop_limit_offset != 0) {
+    if (options->hop_limit == 0 && face->type != NDN_FACE_TYPE_APP) {
+      NDN_TRACE_INFO(NDN_TRACE_EVENT_DROP, face->face_id, name_hash, NDN_FWD_HOP_LIMIT_EXCEEDED);
+      work->counters.drop_hop_limit ++;
+      return NDN_FWD_HOP_LIMIT_EXCEEDED;
     }
+    if (options->hop_limit > 0) {
+      ret = forwarder_decrement_hop_limit(work, options, &raw_interest, size, buf);
+      if (ret != 0) {
+        NDN_TRACE_ERROR(NDN_TRACE_EVENT_DROP, face->face_id, name_hash, ret);
+        work->counters.drop_no_mem ++;
+        return ret;
+      }
+    }
+    hop_limit_exhausted = (options->hop_limit <= 1);
+  }
+
+  // Drop an Interest which looped back after its PIT entry is gone
+  if (options->nonce != 0 && ndn_dnl_has(&shard->dnl, name_hash, options->nonce, now)) {
+    NDN_TRACE_INFO(NDN_TRACE_EVENT_DROP, face->face_id, name_hash, NDN_FWD_DUPLICATE_NONCE);
+    work->counters.drop_dead_nonce ++;
+    return NDN_FWD_DUPLICATE_NONCE;
+  }
 
-    // Decode name only
-    uint32_t probe = 0;
-    ndn_decoder_t decoder;
-    decoder_init(&decoder, raw_interest, size);
-    ret = decoder_get_type(&decoder, &probe);
-    ret = decoder_get_length(&decoder, &probe);
-    ret = ndn_name_tlv_decode(&decoder, name);
-    if (ret != 0) {
-      ndn_memory_pool_free(name_pool, name);
-      return ret;
+  // Answer from CS
+  ndn_cs_entry_t* cs_entry = ndn_cs_lookup(&shard->cs, name, options->can_be_prefix, options->must_be_fresh, now);
+  if (cs_entry != NULL) {
+    work->counters.cs_hits ++;
+    NDN_TRACE_DEBUG(NDN_TRACE_EVENT_DATA_OUT, face->face_id, name_hash, (int32_t)cs_entry->size);
+    if (cs_entry->buf != NULL) {
+      return ndn_forwarder_on_outgoing_data(work, face, cs_entry->name, cs_entry->buf->data,
+                                            cs_entry->size, cs_entry->buf);
     }
+    uint32_t data_size = ndn_cs_entry_copy(&shard->cs, cs_entry, work->cs_buffer, sizeof(work->cs_buffer));
+    return ndn_forwarder_on_outgoing_data(work, face, cs_entry->name, work->cs_buffer, data_size, NULL);
   }
+  work->counters.cs_misses ++;
 
   // Insert into PIT
-  ndn_pit_entry_t* pit_entry = pit_table_find_or_insert(name);
+  ndn_pit_entry_t* pit_entry = ndn_pit_find_or_insert(&shard->pit, name);
   if (pit_entry == NULL) {
-    if (!bypass) {
-      ndn_memory_pool_free(name_pool, name);
-    }
+    NDN_TRACE_ERROR(NDN_TRACE_EVENT_DROP, face->face_id, name_hash, NDN_FWD_PIT_FULL);
+    work->counters.drop_pit_full ++;
+    forwarder_send_nack(work, face, name, raw_interest, size, 0, NDN_LP_NACK_REASON_CONGESTION);
     return NDN_FWD_PIT_FULL;
   }
-  pit_entry_add_incoming_face(pit_entry, face);
-
-  // Multicast Strategy
-  ret = forwarder_multicast_strategy(face, name, raw_interest, size, pit_entry);
-
-  // Reject PIT
+  // Drop a duplicate or looping Interest still pending
+  if (options->nonce != 0 && ndn_pit_entry_has_nonce(pit_entry, options->nonce)) {
+    NDN_TRACE_INFO(NDN_TRACE_EVENT_DROP, face->face_id, name_hash, NDN_FWD_DUPLICATE_NONCE);
+    work->counters.drop_duplicate_nonce ++;
+    forwarder_send_nack(work, face, name, raw_interest, size, 0, NDN_LP_NACK_REASON_DUPLICATE);
+    return NDN_FWD_DUPLICATE_NONCE;
+  }
+  ret = ndn_pit_add_in_record(&shard->pit, pit_entry, face, options->nonce, now);
   if (ret != 0) {
-    pit_entry_delete(pit_entry);
+    NDN_TRACE_ERROR(NDN_TRACE_EVENT_DROP, face->face_id, name_hash, ret);
+    work->counters.drop_no_mem ++;
+    if (pit_entry->in_records == NULL) {
+      ndn_pit_remove(&shard->pit, pit_entry);
+    }
+    return ret;
   }
+  ndn_pit_extend_expiry(&shard->pit, pit_entry, now + options->lifetime);
 
-  // Free memory
-  if (!bypass) {
-    ndn_memory_pool_free(name_pool, name);
+  // Aggregate with the Interest forwarded recently; a retransmission after
+  // the suppression interval is forwarded again
+  if (pit_entry->out_records != NULL
+      && now < ndn_pit_entry_last_forwarded(pit_entry) + NDN_FWD_RETX_SUPPRESSION_INTERVAL) {
+    return 0;
   }
 
+  // Strategy
+  pit_entry->strategy = ndn_strategy_choice_lookup(&self->strategy_choice, name);
+  ret = pit_entry->strategy->after_receive_interest(self, face, name, raw_interest, size, pit_entry,
+                                                    forwarder_fib_lookup(self, name, options),
+                                                    options->nonce, now);
+
+  // Reject PIT, unless an earlier Interest is still pending upstream
+  if (ret != 0 && pit_entry->out_records == NULL) {
+    if (ret == NDN_FWD_HOP_LIMIT_EXCEEDED || hop_limit_exhausted) {
+      // the last hop is used up: a Nack for each such Interest would only add to a flood
+      ret = NDN_FWD_HOP_LIMIT_EXCEEDED;
+      NDN_TRACE_INFO(NDN_TRACE_EVENT_DROP, face->face_id, name_hash, ret);
+      work->counters.drop_hop_limit ++;
+    }
+    else {
+      NDN_TRACE_INFO(NDN_TRACE_EVENT_DROP, face->face_id, name_hash, ret);
+      work->counters.drop_rejected ++;
+      forwarder_send_nack(work, face, name, raw_interest, size, 0, NDN_LP_NACK_REASON_NO_ROUTE);
+    }
+    ndn_pit_remove(&shard->pit, pit_entry);
+  }
   return ret;
 }
 
+// Process a Nack whose Interest name has been read and hashed
 static int
-forwarder_multicast_strategy(ndn_face_intf_t* face, ndn_name_t* name,
-                             const uint8_t* raw_interest, uint32_t size,
-                             const ndn_pit_entry_t* pit_entry)
+forwarder_process_nack(ndn_forwarder_t* self, ndn_forwarder_shard_t* shard, ndn_face_intf_t* face,
+                       const ndn_name_view_t* name, const forwarder_interest_options_t* options,
+                       const uint8_t* raw_interest, uint32_t size, uint8_t reason)
 {
-  (void)pit_entry;
-  ndn_fib_entry_t* fib_entry;
-  fib_entry = fib_table_find(name);
-  if (fib_entry && fib_entry->next_hop && fib_entry->next_hop != face) {
-    ndn_forwarder_on_outgoing_interest(fib_entry->next_hop, name, raw_interest, size);
+  forwarder_scratch_t* work = forwarder_scratch(shard);
+  uint64_t now = ndn_alarm_millis_get_now();
+  NDN_TRACE_DEBUG(NDN_TRACE_EVENT_NACK_IN, face->face_id, ndn_name_view_hash(name), reason);
+  work->counters.in_nacks ++;
+  ndn_counter_add(&face->counters.in_nacks, 1);
+
+  // Accept the Nack only if it answers the Interest sent to the face
+  ndn_pit_entry_t* pit_entry = ndn_pit_find(&shard->pit, name);
+  ndn_pit_out_record_t* out_record = NULL;
+  if (pit_entry != NULL) {
+    for (out_record = pit_entry->out_records; out_record != NULL; out_record = out_record->next) {
+      if (ndn_pit_record_is_face(out_record, face))
+        break;
+    }
   }
-  else {
-    // TODO: Send Nack
-    return NDN_FWD_INTEREST_REJECTED;
+  if (out_record == NULL || out_record->nonce != options->nonce) {
+    work->counters.pit_misses ++;
+    return 0;
+  }
+  work->counters.pit_hits ++;
+  out_record->nack_reason = (reason != NDN_LP_NACK_REASON_NONE) ? reason : NDN_LP_NACK_REASON_NO_ROUTE;
+
+  if (pit_entry->strategy != NULL && pit_entry->strategy->on_nack != NULL) {
+    // the Nacked Interest is the one sent upstream, its HopLimit already decremented
+    pit_entry->strategy->on_nack(self, face, name, raw_interest, size, pit_entry,
+                                 forwarder_fib_lookup(self, name, options), reason, now);
+  }
+
+  // Return the least severe Nack downstream once every upstream has Nacked
+  uint8_t least_reason = 0xFF;
+  for (out_record = pit_entry->out_records; out_record != NULL; out_record = out_record->next) {
+    if (out_record->nack_reason == NDN_LP_NACK_REASON_NONE)
+      break;
+    if (out_record->nack_reason < least_reason)
+      least_reason = out_record->nack_reason;
+  }
+  if (out_record == NULL) {
+    for (ndn_pit_in_record_t* record = pit_entry->in_records; record != NULL; record = record->next) {
+      if (!ndn_face_table_is_alive(&self->face_table, record->face_handle))
+        continue;
+      forwarder_send_nack(work, record->face, name, raw_interest, size, record->nonce, least_reason);
+    }
+    forwarder_pit_entry_to_dnl(shard, pit_entry, now);
+    ndn_pit_remove(&shard->pit, pit_entry);
   }
   return 0;
 }
+
+int
+ndn_forwarder_on_incoming_data(ndn_forwarder_t* self, ndn_face_intf_t* face,
+                               const uint8_t* raw_data, uint32_t size)
+{
+  int ret = 0;
+  ndn_decoder_t decoder;
+  ndn_name_view_t name;
+  ndn_forwarder_shard_t* shard = &self->shards[0];
+
+  ret = forwarder_decode_name(&decoder, raw_data, size, &name);
+  if (ret == 0) {
+    shard = forwarder_shard_of_hash(self, ndn_name_view_hash(&name));
+    ret = forwarder_process_data(self, shard, face, &name, &decoder, raw_data, size, NULL);
+  }
+  else {
+    NDN_TRACE_INFO(NDN_TRACE_EVENT_DROP, face->face_id, 0, ret);
+    forwarder_scratch(shard)->counters.drop_malformed ++;
+  }
+  forwarder_publish_counters(shard);
+  return ret;
+}
+
+int
+ndn_forwarder_on_incoming_interest(ndn_forwarder_t* self, ndn_face_intf_t* face,
+                                   const uint8_t* raw_interest, uint32_t size)
+{
+  int ret = 0;
+  ndn_decoder_t decoder;
+  ndn_name_view_t name;
+  ndn_forwarder_shard_t* shard = &self->shards[0];
+
+  // The name is read in place, hashing all prefixes once for DNL, CS, PIT and FIB
+  ret = forwarder_decode_name(&decoder, raw_interest, size, &name);
+  if (ret == 0) {
+    forwarder_interest_options_t options;
+    forwarder_interest_options(&decoder, &options);
+    shard = forwarder_shard_of_hash(self, ndn_name_view_hash(&name));
+    ret = forwarder_process_interest(self, shard, face, &name, &options, raw_interest, size, NULL);
+  }
+  else {
+    NDN_TRACE_INFO(NDN_TRACE_EVENT_DROP, face->face_id, 0, ret);
+    forwarder_scratch(shard)->counters.drop_malformed ++;
+  }
+  forwarder_publish_counters(shard);
+  return ret;
+}
+
+int
+ndn_forwarder_on_incoming_nack(ndn_forwarder_t* self, ndn_face_intf_t* face,
+                               const uint8_t* raw_interest, uint32_t size, uint8_t reason)
+{
+  int ret = 0;
+  ndn_decoder_t decoder;
+  ndn_name_view_t name;
+  ndn_forwarder_shard_t* shard = &self->shards[0];
+
+  ret = forwarder_decode_name(&decoder, raw_interest, size, &name);
+  if (ret == 0) {
+    forwarder_interest_options_t options;
+    forwarder_interest_options(&decoder, &options);
+    shard = forwarder_shard_of_hash(self, ndn_name_view_hash(&name));
+    ret = forwarder_process_nack(self, shard, face, &name, &options, raw_interest, size, reason);
+  }
+  else {
+    NDN_TRACE_INFO(NDN_TRACE_EVENT_DROP, face->face_id, 0, ret);
+    forwarder_scratch(shard)->counters.drop_malformed ++;
+  }
+  forwarder_publish_counters(shard);
+  return ret;
+}
+
+// Prefetch the entry a hash probably refers to. The slot should be in cache already.
+static inline void
+forwarder_prefetch_entry(const ndn_hash_index_t* index, const void* entries, uint32_t entry_size,
+                         uint32_t hash)
+{
+  uint32_t pos = ndn_hash_index_home(index, hash);
+  uint32_t i = ndn_hash_index_probe(index, hash, &pos);
+  if (i != NDN_HASH_INDEX_EMPTY) {
+#if defined(__GNUC__)
+    __builtin_prefetch((const uint8_t*)entries + (size_t)i * entry_size);
+#endif
+  }
+}
+
+// The longest prefix length of a name which the FIB may have
+static uint32_t
+forwarder_fib_first_length(const ndn_fib_t* fib, const ndn_name_view_t* name)
+{
+  uint32_t len = name->components_size;
+  while (len > 0 && fib->length_count[len] == 0) {
+    len --;
+  }
+  return len;
+}
+
+// The buffer keeping exactly the network layer packet of a received one, NULL if none
+static ndn_pktbuf_t*
+forwarder_burst_buf(const ndn_forwarder_rx_t* rx, const uint8_t* packet, uint32_t size)
+{
+  ndn_pktbuf_t* buf = rx->buf;
+  if (buf == NULL || packet < buf->data || packet + size > buf->data + buf->size) {
+    return NULL;
+  }
+  if (packet == buf->data && size == buf->size) {
+    return buf;
+  }
+  // strip the LpPacket header, unless others see the buffer
+  if (ndn_pktbuf_is_shared(buf)
+      || ndn_pktbuf_narrow(buf, (uint32_t)(packet - buf->data), size) != 0) {
+    return NULL;
+  }
+  return buf;
+}
+
+// Stage 1: unwrap, read the name and hash it
+static void
+forwarder_burst_decode(forwarder_burst_packet_t* pkt, ndn_name_view_t* name,
+                       const ndn_forwarder_rx_t* rx)
+{
+  ndn_lp_packet_t lp_packet;
+  uint32_t probe = 0;
+
+  pkt->face = rx->face;
+  pkt->buf = NULL;
+  pkt->type = 0;
+  pkt->ret = 0;
+  if (ndn_lp_packet_from_block(&lp_packet, rx->packet, rx->size) != NDN_SUCCESS
+      || lp_packet.fragment == NULL
+      || (lp_packet.enable_FragCount && lp_packet.frag_count > 1)) {
+    // left to ndn_face_receive()
+    return;
+  }
+  pkt->packet = lp_packet.fragment;
+  pkt->size = lp_packet.fragment_size;
+  pkt->buf = forwarder_burst_buf(rx, pkt->packet, pkt->size);
+  pkt->nack_reason = lp_packet.enable_Nack ? lp_packet.nack_reason : NDN_LP_NACK_REASON_NONE;
+  decoder_init(&pkt->decoder, pkt->packet, pkt->size);
+  if (decoder_get_type(&pkt->decoder, &probe) != NDN_SUCCESS
+      || (probe != TLV_Interest && probe != TLV_Data)
+      || (lp_packet.enable_Nack && probe != TLV_Interest)) {
+    return;
+  }
+  pkt->ret = forwarder_decode_name(&pkt->decoder, pkt->packet, pkt->size, name);
+  if (pkt->ret != 0) {
+    pkt->type = TLV_Name;
+    return;
+  }
+  pkt->type = lp_packet.enable_Nack ? TLV_LpNack : probe;
+  if (probe == TLV_Interest) {
+    forwarder_interest_options(&pkt->decoder, &pkt->options);
+  }
+}
+
+uint32_t
+ndn_forwarder_shard_process_burst(ndn_forwarder_t* self, uint32_t shard_index,
+                                  const ndn_forwarder_rx_t* packets, uint32_t count)
+{
+  uint32_t succeeded = 0;
+  if (shard_index >= self->shard_count) {
+    return 0;
+  }
+  ndn_forwarder_shard_t* shard = &self->shards[shard_index];
+  forwarder_scratch_t* work = forwarder_scratch(shard);
+  forwarder_burst_packet_t* burst = work->burst;
+  ndn_name_view_t* burst_names = work->burst_names;
+
+  for (uint32_t base = 0; base < count; base += NDN_FWD_BURST_SIZE) {
+    uint32_t n = (count - base < NDN_FWD_BURST_SIZE) ? count - base : NDN_FWD_BURST_SIZE;
+
+    // Stage 1: decode and hash all packets
+    for (uint32_t i = 0; i < n; i++) {
+      forwarder_burst_decode(&burst[i], &burst_names[i], &packets[base + i]);
+    }
+
+    // Stage 2: prefetch the table slots of all packets
+    for (uint32_t i = 0; i < n; i++) {
+      const ndn_name_view_t* name = &burst_names[i];
+      if (burst[i].type == TLV_Interest) {
+        ndn_hash_index_prefetch(&shard->cs.index, ndn_name_view_hash(name));
+        ndn_hash_index_prefetch(&shard->pit.index, ndn_name_view_hash(name));
+        ndn_hash_index_prefetch(&self->fib.index,
+                                name->prefix_hashes[forwarder_fib_first_length(&self->fib, name)]);
+      }
+      else if (burst[i].type == TLV_Data || burst[i].type == TLV_LpNack) {
+        ndn_hash_index_prefetch(&shard->pit.index, ndn_name_view_hash(name));
+      }
+    }
+
+    // Stage 3: prefetch the entries the slots point to
+    for (uint32_t i = 0; i < n; i++) {
+      const ndn_name_view_t* name = &burst_names[i];
+      if (burst[i].type == TLV_Interest || burst[i].type == TLV_Data || burst[i].type == TLV_LpNack) {
+        uint32_t hash = ndn_name_view_hash(name);
+        forwarder_prefetch_entry(&shard->pit.index, shard->pit.entries, sizeof(ndn_pit_entry_t), hash);
+      }
+      if (burst[i].type == TLV_Interest) {
+        uint32_t hash = ndn_name_view_hash(name);
+        forwarder_prefetch_entry(&shard->cs.index, shard->cs.entries, sizeof(ndn_cs_entry_t), hash);
+        hash = name->prefix_hashes[forwarder_fib_first_length(&self->fib, name)];
+        forwarder_prefetch_entry(&self->fib.index, self->fib.entries, sizeof(ndn_fib_entry_t), hash);
+      }
+    }
+
+    // Stage 4: process, queueing the Data returned downstream
+    work->tx_deferred = true;
+    for (uint32_t i = 0; i < n; i++) {
+      forwarder_burst_packet_t* pkt = &burst[i];
+      const ndn_name_view_t* name = &burst_names[i];
+      if (pkt->type == TLV_Interest) {
+        pkt->ret = forwarder_process_interest(self, shard, pkt->face, name, &pkt->options,
+                                              pkt->packet, pkt->size, pkt->buf);
+      }
+      else if (pkt->type == TLV_Data) {
+        pkt->ret = forwarder_process_data(self, shard, pkt->face, name, &pkt->decoder,
+                                          pkt->packet, pkt->size, pkt->buf);
+      }
+      else if (pkt->type == TLV_LpNack) {
+        pkt->ret = forwarder_process_nack(self, shard, pkt->face, name, &pkt->options,
+                                          pkt->packet, pkt->size, pkt->nack_reason);
+      }
+      else if (pkt->type == 0 && self->shard_count > 1) {
+        // the reassembly table belongs to no shard: the dispatcher should have used
+        // ndn_face_reassemble()
+        NDN_TRACE_INFO(NDN_TRACE_EVENT_DROP, pkt->face->face_id, 0, NDN_WRONG_TLV_TYPE);
+        work->counters.drop_malformed ++;
+        pkt->ret = NDN_WRONG_TLV_TYPE;
+      }
+      else if (pkt->type == 0) {
+        // the name given to the faces lives only during the call
+        work->tx_deferred = false;
+        pkt->ret = ndn_face_receive(pkt->face, packets[base + i].packet, packets[base + i].size);
+        work->tx_deferred = true;
+      }
+      else if (pkt->type == TLV_Name) {
+        NDN_TRACE_INFO(NDN_TRACE_EVENT_DROP, pkt->face->face_id, 0, pkt->ret);
+        work->counters.drop_malformed ++;
+      }
+      if (pkt->ret == 0)
+        succeeded ++;
+    }
+
+    // Stage 5: send grouped by face
+    forwarder_flush_tx(work);
+    work->tx_deferred = false;
+    forwarder_publish_counters(shard);
+  }
+  return succeeded;
+}
+
+uint32_t
+ndn_forwarder_process_burst(ndn_forwarder_t* self, const ndn_forwarder_rx_t* packets, uint32_t count)
+{
+  ndn_forwarder_rx_t group[NDN_FWD_BURST_SIZE];
+  int shard_of[NDN_FWD_BURST_SIZE];
+  uint32_t succeeded = 0;
+
+  if (self->shard_count <= 1) {
+    return ndn_forwarder_shard_process_burst(self, 0, packets, count);
+  }
+  // Without forwarding threads, run each shard in turn on its own packets
+  for (uint32_t base = 0; base < count; base += NDN_FWD_BURST_SIZE) {
+    uint32_t n = (count - base < NDN_FWD_BURST_SIZE) ? count - base : NDN_FWD_BURST_SIZE;
+    // No shard runs concurrently, so fragments are reassembled here and each packet they
+    // complete goes to its own shard
+    for (uint32_t i = 0; i < n; i++) {
+      shard_of[i] = forwarder_steer(packets[base + i].packet, packets[base + i].size);
+      if (shard_of[i] < 0
+          && ndn_face_receive(packets[base + i].face, packets[base + i].packet, packets[base + i].size) == 0)
+        succeeded ++;
+    }
+    for (uint32_t shard = 0; shard < self->shard_count; shard++) {
+      uint32_t m = 0;
+      for (uint32_t i = 0; i < n; i++) {
+        if (shard_of[i] == (int)shard)
+          group[m++] = packets[base + i];
+      }
+      if (m > 0)
+        succeeded += ndn_forwarder_shard_process_burst(self, shard, group, m);
+    }
+  }
+  return succeeded;
+}
@@ -11,7 +11,12 @@
 
 #include "pit.h"
 #include "fib.h"
+#include "cs.h"
+#include "dead-nonce-list.h"
+#include "strategy-choice.h"
 #include "face.h"
+#include "face-table.h"
+#include "reassembly.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -26,22 +31,203 @@ extern "C" {
  * @{
  */
 
+/**
+ * The packet counters of the forwarder, or of one of its shards.
+ */
+typedef struct ndn_forwarder_counters {
+  /**
+   * The number of Interests received.
+   */
+  ndn_counter_t in_interests;
+  /**
+   * The number of Data received.
+   */
+  ndn_counter_t in_data;
+  /**
+   * The number of Nacks received.
+   */
+  ndn_counter_t in_nacks;
+  /**
+   * The number of Interests sent.
+   */
+  ndn_counter_t out_interests;
+  /**
+   * The number of Data sent, including those answered from the CS.
+   */
+  ndn_counter_t out_data;
+  /**
+   * The number of Nacks sent.
+   */
+  ndn_counter_t out_nacks;
+  /**
+   * The number of Data and Nacks matching a PIT entry.
+   */
+  ndn_counter_t pit_hits;
+  /**
+   * The number of Data and Nacks matching no PIT entry, i.e. unsolicited.
+   */
+  ndn_counter_t pit_misses;
+  /**
+   * The number of PIT entries expired without Data.
+   */
+  ndn_counter_t pit_expired;
+  /**
+   * The number of Interests answered from the CS.
+   */
+  ndn_counter_t cs_hits;
+  /**
+   * The number of Interests not found in the CS.
+   */
+  ndn_counter_t cs_misses;
+  /**
+   * The number of Interests dropped because the PIT is full (NDN_FWD_PIT_FULL).
+   */
+  ndn_counter_t drop_pit_full;
+  /**
+   * The number of packets dropped for lack of working memory or PIT records (NDN_FWD_NO_MEM).
+   */
+  ndn_counter_t drop_no_mem;
+  /**
+   * The number of Interests the strategy could not forward (NDN_FWD_INTEREST_REJECTED).
+   */
+  ndn_counter_t drop_rejected;
+  /**
+   * The number of looping or duplicate Interests dropped while still pending in the PIT
+   * (NDN_FWD_DUPLICATE_NONCE).
+   */
+  ndn_counter_t drop_duplicate_nonce;
+  /**
+   * The number of Interests dropped because the Dead Nonce List has their (Name, Nonce) pair
+   * (NDN_FWD_DUPLICATE_NONCE). It includes the false positives of the list.
+   */
+  ndn_counter_t drop_dead_nonce;
+  /**
+   * The number of packets dropped because their name fails to decode, or because they are
+   * fragments or IDLE packets reaching a forwarding thread.
+   */
+  ndn_counter_t drop_malformed;
+  /**
+   * The number of Interests dropped because they arrived with a HopLimit of 0, or used up
+   * their last hop with no application to reach (NDN_FWD_HOP_LIMIT_EXCEEDED). No Nack is sent.
+   */
+  ndn_counter_t drop_hop_limit;
+} ndn_forwarder_counters_t;
+
+/**
+ * A snapshot of the forwarder statistics, see ndn_forwarder_get_stats().
+ */
+typedef struct ndn_forwarder_stats {
+  /**
+   * The packet counters, summed over the shards.
+   */
+  ndn_forwarder_counters_t counters;
+  /**
+   * The number of PIT entries in use.
+   */
+  uint32_t pit_entries;
+  /**
+   * The number of cached Data packets.
+   */
+  uint32_t cs_entries;
+  /**
+   * The number of FIB entries.
+   */
+  uint32_t fib_entries;
+  /**
+   * The number of registered faces.
+   */
+  uint32_t faces;
+} ndn_forwarder_stats_t;
+
+/**
+ * The per-thread part of the forwarder.
+ * A shard keeps the Interests and Data whose exact names hash to it, so it can be
+ * driven by one thread without any locking.
+ */
+typedef struct ndn_forwarder_shard {
+  /**
+   * The pending Interest table (PIT).
+   */
+  ndn_pit_t pit;
+  /**
+   * The content store (CS).
+   */
+  ndn_cs_t cs;
+  /**
+   * The dead nonce list (DNL).
+   */
+  ndn_dead_nonce_list_t dnl;
+  /**
+   * The packet counters of the shard. They are written only by the thread driving the shard,
+   * under @c counters_seq.
+   */
+  ndn_forwarder_counters_t counters;
+  /**
+   * The sequence number guarding @c counters, odd while they are being updated.
+   */
+  uint32_t counters_seq;
+} ndn_forwarder_shard_t;
+
 /**
  * NDN-Lite forwarder.
- * We will support content support in future versions.
  * The NDN forwarder is a singleton in an application.
+ * By default it has a single shard and is driven by the thread running the timer scheduler.
+ * A multi-core gateway can set up to NDN_FWD_MAX_SHARDS shards, each driven by its own
+ * forwarding thread, see ndn_forwarder_set_shard_count().
  */
 typedef struct ndn_forwarder {
   /**
-   * The forwarding information base (FIB).
+   * The face table, shared by all shards.
+   */
+  ndn_face_table_t face_table;
+  /**
+   * The packets being reassembled from fragments, used by ndn_face_receive() only.
+   */
+  ndn_reassembly_t reassembly;
+  /**
+   * The forwarding information base (FIB), shared by all shards.
    */
   ndn_fib_t fib;
   /**
-   * The pending Interest table (PIT).
+   * The strategy choice table, shared by all shards.
    */
-  ndn_pit_t pit;
+  ndn_strategy_choice_t strategy_choice;
+  /**
+   * The shards.
+   */
+  ndn_forwarder_shard_t shards[NDN_FWD_MAX_SHARDS];
+  /**
+   * The number of shards in use.
+   */
+  uint32_t shard_count;
 } ndn_forwarder_t;
 
+/**
+ * A packet received by a face, handed to ndn_forwarder_process_burst().
+ */
+typedef struct ndn_forwarder_rx {
+  /**
+   * The face the packet came from.
+   */
+  ndn_face_intf_t* face;
+  /**
+   * The wire format packet: an Interest, a Data or an NDNLPv2 LpPacket.
+   */
+  const uint8_t* packet;
+  /**
+   * The size of the wire format packet.
+   */
+  uint32_t size;
+  /**
+   * [optional] The packet buffer keeping @c packet, or NULL.
+   * With a buffer, a Data is cached and sent to the faces supporting ndn_face_intf#send_pktbuf
+   * by reference, without any copy. The forwarder takes its own references, so the caller
+   * releases its reference after ndn_forwarder_process_burst() returns. An LpPacket in a
+   * buffer not shared is narrowed to the network layer packet in place.
+   */
+  ndn_pktbuf_t* buf;
+} ndn_forwarder_rx_t;
+
 /**
  * Get a running instance of forwarder.
  * @return the pointer to the forwarder instance.
@@ -57,32 +243,230 @@ ndn_forwarder_get_instance(void);
 ndn_forwarder_t*
 ndn_forwarder_init(void);
 
+/**
+ * Replace the PIT storage of the first shard with caller-supplied memory of a different capacity.
+ * This function should be invoked right after ndn_forwarder_init(), before any packet
+ * is received. All pending entries are dropped.
+ * @pre NDN_PIT_RESERVE_SIZE(capacity) bytes needed, aligned to a pointer.
+ * @param memory Input. The memory used to keep the PIT.
+ * @param capacity Input. The max number of PIT entries.
+ * @return 0 if there is no error.
+ */
+int
+ndn_forwarder_set_pit_capacity(void* memory, uint32_t capacity);
+
+/**
+ * Replace the CS storage of the first shard with caller-supplied memory of a different size.
+ * This function should be invoked right after ndn_forwarder_init(). All cached Data are dropped.
+ * @pre NDN_CS_RESERVE_SIZE(capacity, byte_budget) bytes needed, aligned to 8 bytes.
+ * @param memory Input. The memory used to keep the CS.
+ * @param capacity Input. The max number of cached Data packets.
+ * @param byte_budget Input. The max number of bytes used to keep cached Data packets.
+ * @return 0 if there is no error.
+ */
+int
+ndn_forwarder_set_cs_capacity(void* memory, uint32_t capacity, uint32_t byte_budget);
+
+/**
+ * Give a shard its PIT and CS storage.
+ * The first shard has static storage, the others must be set up before
+ * ndn_forwarder_set_shard_count() puts them in use.
+ * @pre NDN_PIT_RESERVE_SIZE(pit_capacity) bytes of @c pit_memory needed, aligned to a pointer.
+ * @pre NDN_CS_RESERVE_SIZE(cs_capacity, cs_byte_budget) bytes of @c cs_memory needed, aligned to 8 bytes.
+ * @param shard Input. The shard index, smaller than NDN_FWD_MAX_SHARDS.
+ * @param pit_memory Input. The memory used to keep the PIT of the shard.
+ * @param pit_capacity Input. The max number of PIT entries of the shard.
+ * @param cs_memory Input. The memory used to keep the CS of the shard.
+ * @param cs_capacity Input. The max number of cached Data packets of the shard.
+ * @param cs_byte_budget Input. The max number of bytes used to keep cached Data packets of the shard.
+ * @return 0 if there is no error.
+ */
+int
+ndn_forwarder_setup_shard(uint32_t shard, void* pit_memory, uint32_t pit_capacity,
+                          void* cs_memory, uint32_t cs_capacity, uint32_t cs_byte_budget);
+
+/**
+ * Split the forwarding state into @c count shards.
+ * This function should be invoked after ndn_forwarder_setup_shard() of every shard in use and
+ * before any packet is received.
+ *
+ * With more than one shard, the forwarder expects one forwarding thread per shard:
+ * - A dispatcher passes each received packet to ndn_face_reassemble(), picks the shard of
+ *   the whole packet it gives with ndn_forwarder_shard_of(), and hands it to that shard's
+ *   thread, e.g. through a ring. A forwarding thread drops fragments and IDLE packets.
+ * - Each thread calls ndn_forwarder_shard_process_burst() and ndn_forwarder_shard_advance()
+ *   for its own shard only. The PIT timers of the shards are not run by the timer scheduler.
+ * - The FIB and the strategy choice table are shared and only read by the threads. They should
+ *   be modified only while the threads are paused.
+ * - The faces must accept ndn_face_send() from all forwarding threads.
+ * - ndn_face_receive() and the per-packet receiving functions must not be used concurrently
+ *   with the forwarding threads.
+ * @param count Input. The number of shards, from 1 to NDN_FWD_MAX_SHARDS.
+ * @return 0 if there is no error. NDN_FWD_INVALID_SHARD if the count is out of range or
+ *         some shard is not set up.
+ */
+int
+ndn_forwarder_set_shard_count(uint32_t count);
+
+/**
+ * Get the shard a received packet belongs to.
+ * Packets are steered by a hash of their exact name, so a Data, a Nack and the Interest they
+ * answer always go to the same shard.
+ * This function only reads the packet, so it can be invoked from any thread.
+ * @param packet Input. The wire format packet: an Interest, a Data or an NDNLPv2 LpPacket,
+ *        given by ndn_face_reassemble().
+ * @param size Input. The size of the wire format packet.
+ * @return The shard index. Packets without a name go to shard 0.
+ */
+uint32_t
+ndn_forwarder_shard_of(const uint8_t* packet, uint32_t size);
+
+/**
+ * Get a snapshot of the forwarder statistics.
+ * The counters of each shard are consistent with each other, i.e. they are read between two
+ * bursts of that shard. The table occupancy is read right after the counters.
+ * This function can be invoked from any thread.
+ * @param stats Output. The statistics.
+ */
+void
+ndn_forwarder_get_stats(ndn_forwarder_stats_t* stats);
+
+/**
+ * Replace the face table storage with caller-supplied memory of a different capacity.
+ * This function should be invoked right after ndn_forwarder_init(), before any face is added.
+ * @pre NDN_FACE_TABLE_RESERVE_SIZE(capacity) bytes needed, aligned to a pointer.
+ * @param memory Input. The memory used to keep the face table.
+ * @param capacity Input. The max number of faces, up to 65535.
+ * @return 0 if there is no error.
+ */
+int
+ndn_forwarder_set_face_table_capacity(void* memory, uint32_t capacity);
+
+/**
+ * Replace the reassembly table storage with caller-supplied memory of a different size,
+ * e.g. to receive packets larger than NDN_REASSEMBLY_BUFFER_SIZE.
+ * This function should be invoked right after ndn_forwarder_init(), before any packet
+ * is received. All partly received packets are dropped.
+ * @pre NDN_REASSEMBLY_RESERVE_SIZE(capacity, buffer_size) bytes needed, aligned to 8 bytes.
+ * @param memory Input. The memory used to keep the reassembly table.
+ * @param capacity Input. The max number of packets reassembled at the same time.
+ * @param buffer_size Input. The largest packet.
+ * @return 0 if there is no error.
+ */
+int
+ndn_forwarder_set_reassembly_capacity(void* memory, uint32_t capacity, uint32_t buffer_size);
+
+/**
+ * Register a face to the forwarder, assigning its face ID and handle.
+ * Faces given to ndn_forwarder_fib_insert() are registered automatically.
+ * A registered face can be removed at any time by ndn_forwarder_remove_face().
+ * @param face Input/Output. The face.
+ * @return The handle of the face. NDN_FACE_HANDLE_NONE if the face table is full.
+ */
+ndn_face_handle_t
+ndn_forwarder_add_face(ndn_face_intf_t* face);
+
+/**
+ * Remove a face from the forwarder, e.g. right before destroying it.
+ * The PIT records and FIB next-hops of the face are not scanned: they become stale and are
+ * skipped or dropped when next used. The packets being reassembled from the face are dropped.
+ * After this call, the face memory can be freed.
+ * With more than one shard, it should be invoked only while the forwarding threads are paused.
+ * @param face Input/Output. The face.
+ */
+void
+ndn_forwarder_remove_face(ndn_face_intf_t* face);
+
+/**
+ * Get a registered face by its handle.
+ * @param handle Input. The handle.
+ * @return The face. NULL if the face has been removed.
+ */
+ndn_face_intf_t*
+ndn_forwarder_get_face(ndn_face_handle_t handle);
+
 /**
  * Add FIB entry into the FIB.
  * This function should be invoked before sending a packet through the specific face.
  * @param name_prefix Input. The FIB's name prefix.
  * @param face Input/Output. The face instance to send the packet out.
  * @param cost The cost of sending a packet through the @param face. When more than one faces
- *        can be used to send a packet, the face with lower cost will be used.
- * @return 0 if there is no error.
+ *        can be used to send a packet, the face with lower cost will be used, and the others
+ *        are tried in cost order when it is down or fails to send.
+ * @return 0 if there is no error. NDN_FWD_FACE_TABLE_FULL if the face cannot be registered.
  */
 int
 ndn_forwarder_fib_insert(const ndn_name_t* name_prefix,
                          ndn_face_intf_t* face, uint8_t cost);
 
+/**
+ * Replace the FIB storage with caller-supplied memory of a different capacity.
+ * This function should be invoked right after ndn_forwarder_init(). All routes are dropped.
+ * @pre NDN_FIB_RESERVE_SIZE(capacity) bytes needed, aligned to a pointer.
+ * @param memory Input. The memory used to keep the FIB.
+ * @param capacity Input. The max number of FIB entries.
+ * @return 0 if there is no error.
+ */
+int
+ndn_forwarder_set_fib_capacity(void* memory, uint32_t capacity);
+
+/**
+ * Replace all FIB entries with a route set in one pass.
+ * This is much cheaper than calling ndn_forwarder_fib_insert() for each of thousands of routes.
+ * @param routes Input. The routes to load.
+ * @param count Input. The number of routes.
+ * @return 0 if there is no error. NDN_FWD_FIB_FULL if the routes do not fit, and the FIB is
+ *         left unchanged.
+ */
+int
+ndn_forwarder_fib_load(const ndn_fib_route_t* routes, uint32_t count);
+
+/**
+ * Choose the strategy forwarding the Interests under a name prefix.
+ * Names matching no prefix are forwarded by ndn_strategy_best_route.
+ * @param name_prefix Input. The name prefix.
+ * @param strategy Input. The strategy. It must stay alive while it is chosen.
+ * @return 0 if there is no error. NDN_FWD_STRATEGY_CHOICE_FULL if too many prefixes have a strategy.
+ */
+int
+ndn_forwarder_set_strategy(const ndn_name_t* name_prefix, const ndn_strategy_t* strategy);
+
+/**
+ * Remove the strategy choice of a name prefix, so that it follows its parent prefix.
+ * @param name_prefix Input. The name prefix.
+ */
+void
+ndn_forwarder_unset_strategy(const ndn_name_t* name_prefix);
+
+/**
+ * Send an Interest to an upstream face and record it in the PIT entry.
+ * This function is supposed to be invoked by strategies ONLY.
+ * @param face Input/Output. The upstream face.
+ * @param name Input. The Interest name, read from @c raw_interest.
+ * @param raw_interest Input. The wire format Interest.
+ * @param size Input. The size of the wire format Interest.
+ * @param pit_entry Input/Output. The PIT entry of the Interest.
+ * @param nonce Input. The Nonce of the Interest.
+ * @param now Input. The current time in milliseconds.
+ * @return 0 if there is no error. NDN_FWD_HOP_LIMIT_EXCEEDED if @c raw_interest carries a
+ *         HopLimit of 0 and @c face is not an application face.
+ */
+int
+ndn_forwarder_forward_interest(ndn_face_intf_t* face, const ndn_name_view_t* name,
+                               const uint8_t* raw_interest, uint32_t size,
+                               ndn_pit_entry_t* pit_entry, uint32_t nonce, uint64_t now);
+
 /**
  * Let the forwarder receive a Data packet.
  * This function is supposed to be invoked by face implementation ONLY.
  * @param self Input/Output. The forwarder to receive the Data packet.
  * @param face Input. The face instance who transmits the packet to the forwarder.
- * @param name [optional] Input. The name of the packet. If name == NULL, the forwarder
- *        will decode the packet name by itself.
  * @param raw_data Input. The wire format Data received by the @param face.
  * @param size Input. The size of the wire format Data.
  * @return 0 if there is no error.
  */
 int
-ndn_forwarder_on_incoming_data(ndn_forwarder_t* self, ndn_face_intf_t* face, ndn_name_t *name,
+ndn_forwarder_on_incoming_data(ndn_forwarder_t* self, ndn_face_intf_t* face,
                                const uint8_t *raw_data, uint32_t size);
 
 /**
@@ -90,16 +474,72 @@ ndn_forwarder_on_incoming_data(ndn_forwarder_t* self, ndn_face_intf_t* face, ndn
  * This function is supposed to be invoked by face implementation ONLY.
  * @param self Input/Output. The forwarder to receive the Interest packet.
  * @param face Input. The face instance who transmits the packet to the forwarder.
- * @param name [optional] Input. The name of the packet. If name == NULL, the forwarder
- *        will decode the packet name by itself.
  * @param raw_data Input. The wire format Interest received by the @param face.
  * @param size Input. The size of the wire format Interest.
  * @return 0 if there is no error.
  */
 int
-ndn_forwarder_on_incoming_interest(ndn_forwarder_t* self, ndn_face_intf_t* face, ndn_name_t *name,
+ndn_forwarder_on_incoming_interest(ndn_forwarder_t* self, ndn_face_intf_t* face,
                                    const uint8_t *raw_interest, uint32_t size);
 
+/**
+ * Let the forwarder receive a burst of packets from one or more faces.
+ * This is equivalent to calling ndn_face_receive() for each packet, but the packets go through
+ * each stage together: all names are decoded and hashed first, then the PIT, CS and FIB slots
+ * of all packets are prefetched, then the packets are processed and the Data returned
+ * downstream are sent grouped by face. Busy faces should prefer this function.
+ * With more than one shard, each packet is processed by its own shard in the calling thread,
+ * and each packet reassembled from fragments goes to its own shard as well.
+ * This function is supposed to be invoked by face implementation ONLY.
+ * @param self Input/Output. The forwarder to receive the packets.
+ * @param packets Input. The received packets. They must stay valid until the function returns.
+ * @param count Input. The number of packets.
+ * @return The number of packets processed without error.
+ */
+uint32_t
+ndn_forwarder_process_burst(ndn_forwarder_t* self, const ndn_forwarder_rx_t* packets, uint32_t count);
+
+/**
+ * Let one shard of the forwarder receive a burst of packets.
+ * This is ndn_forwarder_process_burst() for packets all steered to @c shard by
+ * ndn_forwarder_shard_of(). It should be invoked by the thread driving the shard ONLY.
+ * With more than one shard, fragments and IDLE packets are dropped: the dispatcher handles them
+ * with ndn_face_reassemble() beforehand.
+ * @param self Input/Output. The forwarder to receive the packets.
+ * @param shard Input. The shard index.
+ * @param packets Input. The received packets. They must stay valid until the function returns.
+ * @param count Input. The number of packets.
+ * @return The number of packets processed without error.
+ */
+uint32_t
+ndn_forwarder_shard_process_burst(ndn_forwarder_t* self, uint32_t shard,
+                                  const ndn_forwarder_rx_t* packets, uint32_t count);
+
+/**
+ * Expire the PIT entries of a shard, when the forwarder has more than one shard.
+ * It should be invoked periodically by the thread driving the shard ONLY,
+ * e.g. every NDN_PIT_TIMER_TICK milliseconds.
+ * @param self Input/Output. The forwarder.
+ * @param shard Input. The shard index.
+ * @param now Input. The current time in milliseconds.
+ */
+void
+ndn_forwarder_shard_advance(ndn_forwarder_t* self, uint32_t shard, uint64_t now);
+
+/**
+ * Let the forwarder receive a Nack.
+ * This function is supposed to be invoked by face implementation ONLY.
+ * @param self Input/Output. The forwarder to receive the Nack.
+ * @param face Input. The face instance who transmits the Nack to the forwarder.
+ * @param raw_interest Input. The wire format Nacked Interest, without the LpPacket wrapper.
+ * @param size Input. The size of the wire format Interest.
+ * @param reason Input. The Nack reason.
+ * @return 0 if there is no error.
+ */
+int
+ndn_forwarder_on_incoming_nack(ndn_forwarder_t* self, ndn_face_intf_t* face,
+                               const uint8_t* raw_interest, uint32_t size, uint8_t reason);
+
 /*@}*/
 
 #ifdef __cplusplus
@@ -8,18 +8,182 @@
 
 #include "pit.h"
 
-int
-pit_entry_add_incoming_face(ndn_pit_entry_t* entry, ndn_face_intf_t* face)
+static void
+pit_release_records(ndn_pit_t* pit, ndn_pit_face_record_t* record)
 {
-  for (uint8_t i = 0; i < entry->incoming_face_size; i ++) {
-    if (entry->incoming_face[i] == face) {
+  while (record != NULL) {
+    ndn_pit_face_record_t* next = record->next;
+    ndn_memory_pool_free(pit->record_pool, record);
+    record = next;
+  }
+}
+
+static void
+pit_on_wheel_expire(ndn_timer_wheel_t* wheel, ndn_timer_wheel_node_t* node)
+{
+  ndn_pit_t* pit = container_of(wheel, ndn_pit_t, wheel);
+  ndn_pit_entry_t* entry = container_of(node, ndn_pit_entry_t, expiry);
+  if (pit->on_expire != NULL) {
+    pit->on_expire(pit, entry);
+  }
+  ndn_pit_remove(pit, entry);
+}
+
+void
+ndn_pit_init(ndn_pit_t* pit, void* memory, uint32_t capacity, ndn_pit_expire_callback on_expire)
+{
+  uint8_t* ptr = (uint8_t*)memory;
+
+  pit->entries = (ndn_pit_entry_t*)ptr;
+  ptr += sizeof(ndn_pit_entry_t) * capacity;
+  ndn_hash_index_init(&pit->index, ptr, capacity);
+  ptr += NDN_HASH_INDEX_RESERVE_SIZE(capacity);
+  pit->record_pool = ptr;
+  ndn_memory_pool_init(pit->record_pool, sizeof(ndn_pit_face_record_t),
+                       capacity * NDN_PIT_RECORDS_PER_ENTRY);
+  ptr += NDN_MEMORY_POOL_RESERVE_SIZE(sizeof(ndn_pit_face_record_t),
+                                      capacity * NDN_PIT_RECORDS_PER_ENTRY);
+  ndn_name_arena_init(&pit->names, ptr, capacity * NDN_FWD_NAME_BYTES_PER_ENTRY);
+
+  ndn_timer_wheel_init(&pit->wheel, NDN_PIT_TIMER_TICK, pit_on_wheel_expire);
+  pit->on_expire = on_expire;
+
+  pit->capacity = capacity;
+  pit->free_head = NDN_HASH_INDEX_EMPTY;
+  for (uint32_t i = capacity; i > 0; i--) {
+    pit->entries[i - 1].interest_name = NULL;
+    pit->entries[i - 1].name_hash = pit->free_head;
+    ndn_timer_wheel_node_init(&pit->entries[i - 1].expiry);
+    pit->free_head = i - 1;
+  }
+}
+
+ndn_pit_entry_t*
+ndn_pit_find(ndn_pit_t* pit, const ndn_name_view_t* name)
+{
+  uint32_t name_hash = ndn_name_view_hash(name);
+  uint32_t pos = ndn_hash_index_home(&pit->index, name_hash);
+  uint32_t i;
+  while ((i = ndn_hash_index_probe(&pit->index, name_hash, &pos)) != NDN_HASH_INDEX_EMPTY) {
+    if (ndn_name_view_equals(name, pit->entries[i].interest_name)) {
+      return &pit->entries[i];
+    }
+    pos = (pos + 1) & pit->index.mask;
+  }
+  return NULL;
+}
+
+ndn_pit_entry_t*
+ndn_pit_find_or_insert(ndn_pit_t* pit, const ndn_name_view_t* name)
+{
+  // Find
+  ndn_pit_entry_t* entry = ndn_pit_find(pit, name);
+  if (entry != NULL) {
+    return entry;
+  }
+
+  // Insert
+  if (pit->free_head == NDN_HASH_INDEX_EMPTY) {
+    return NULL;
+  }
+  uint32_t size = ndn_name_view_packed_size(name);
+  void* name_block = ndn_name_arena_alloc(&pit->names, size);
+  if (name_block == NULL) {
+    return NULL;
+  }
+  uint32_t i = pit->free_head;
+  entry = &pit->entries[i];
+  pit->free_head = entry->name_hash;
+
+  entry->interest_name = ndn_name_view_to_packed(name, name_block, size);
+  entry->name_hash = ndn_name_view_hash(name);
+  entry->incoming_face_size = 0;
+  entry->in_records = NULL;
+  entry->out_records = NULL;
+  entry->strategy = NULL;
+  ndn_hash_index_insert(&pit->index, entry->name_hash, i);
+  return entry;
+}
+
+void
+ndn_pit_remove(ndn_pit_t* pit, ndn_pit_entry_t* entry)
+{
+  uint32_t i = (uint32_t)(entry - pit->entries);
+  if (entry->interest_name == NULL) {
+    return;
+  }
+  ndn_hash_index_remove(&pit->index, entry->name_hash, i);
+  ndn_timer_wheel_cancel(&pit->wheel, &entry->expiry);
+
+  pit_release_records(pit, entry->in_records);
+  pit_release_records(pit, entry->out_records);
+  entry->in_records = NULL;
+  entry->out_records = NULL;
+  entry->incoming_face_size = 0;
+
+  ndn_name_arena_release(&pit->names, entry->interest_name);
+  entry->interest_name = NULL;
+  entry->name_hash = pit->free_head;
+  pit->free_head = i;
+}
+
+static int
+pit_update_record(ndn_pit_t* pit, ndn_pit_face_record_t** list, ndn_face_intf_t* face,
+                  uint32_t nonce, uint64_t now)
+{
+  ndn_pit_face_record_t* record;
+  for (record = *list; record != NULL; record = record->next) {
+    if (ndn_pit_record_is_face(record, face)) {
+      record->nonce = nonce;
+      record->last_time = now;
+      record->nack_reason = 0;
       return 0;
     }
   }
-  if (entry->incoming_face_size == NDN_MAX_FACE_PER_PIT_ENTRY) {
+  record = (ndn_pit_face_record_t*)ndn_memory_pool_alloc(pit->record_pool);
+  if (record == NULL) {
     return NDN_FWD_PIT_ENTRY_FACE_LIST_FULL;
   }
-  entry->incoming_face[entry->incoming_face_size] = face;
-  entry->incoming_face_size ++;
+  record->face = face;
+  record->face_handle = face->handle;
+  record->nonce = nonce;
+  record->last_time = now;
+  record->nack_reason = 0;
+  record->next = *list;
+  *list = record;
+  return 1;
+}
+
+int
+ndn_pit_add_in_record(ndn_pit_t* pit, ndn_pit_entry_t* entry, ndn_face_intf_t* face,
+                      uint32_t nonce, uint64_t now)
+{
+  int ret = pit_update_record(pit, &entry->in_records, face, nonce, now);
+  if (ret < 0) {
+    return ret;
+  }
+  entry->incoming_face_size += ret;
   return 0;
 }
+
+int
+ndn_pit_add_out_record(ndn_pit_t* pit, ndn_pit_entry_t* entry, ndn_face_intf_t* face,
+                       uint32_t nonce, uint64_t now)
+{
+  int ret = pit_update_record(pit, &entry->out_records, face, nonce, now);
+  return (ret < 0) ? ret : 0;
+}
+
+bool
+ndn_pit_entry_has_nonce(const ndn_pit_entry_t* entry, uint32_t nonce)
+{
+  for (const ndn_pit_face_record_t* record = entry->in_records; record != NULL; record = record->next) {
+    if (record->nonce == nonce)
+      return true;
+  }
+  for (const ndn_pit_face_record_t* record = entry->out_records; record != NULL; record = record->next) {
+    if (record->nonce == nonce)
+      return true;
+  }
+  return false;
+}
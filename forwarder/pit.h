@@ -10,6 +10,10 @@
 #define FORWARDER_PIT_H_
 
 #include "../encode/interest.h"
+#include "../encode/name-view.h"
+#include "../util/hash-index.h"
+#include "../util/memory-pool.h"
+#include "../util/timer-wheel.h"
 #include "face.h"
 
 #ifdef __cplusplus
@@ -22,53 +26,266 @@ extern "C" {
  * @{
  */
 
+/**
+ * The average number of in-records and out-records reserved per PIT entry.
+ * Records are shared by all entries, so an entry may hold more than this.
+ */
+#define NDN_PIT_RECORDS_PER_ENTRY (NDN_MAX_FACE_PER_PIT_ENTRY + 1)
+
+/**
+ * PIT face record.
+ * An in-record is a downstream face waiting for the Data;
+ * an out-record is an upstream face the Interest has been forwarded to.
+ */
+typedef struct ndn_pit_face_record {
+  /**
+   * The face.
+   */
+  ndn_face_intf_t* face;
+  /**
+   * The handle of @c face when the record was made. The record is stale once it no longer
+   * passes ndn_face_table_is_alive(), and @c face must not be dereferenced then.
+   */
+  ndn_face_handle_t face_handle;
+  /**
+   * The Nonce of the last Interest received from (in-record) or sent to (out-record) the face.
+   */
+  uint32_t nonce;
+  /**
+   * The time (in milliseconds) the last Interest was received or sent.
+   */
+  uint64_t last_time;
+  /**
+   * The reason of the Nack received for an out-record. 0 if not Nacked.
+   */
+  uint8_t nack_reason;
+  /**
+   * The next record of the same list.
+   */
+  struct ndn_pit_face_record* next;
+} ndn_pit_face_record_t;
+
+typedef ndn_pit_face_record_t ndn_pit_in_record_t;
+typedef ndn_pit_face_record_t ndn_pit_out_record_t;
+
+/**
+ * Check whether a record refers to a face, and not to an earlier face removed
+ * from the face table whose memory has been reused.
+ * @param record Input. The record.
+ * @param face Input. The face.
+ */
+static inline bool
+ndn_pit_record_is_face(const ndn_pit_face_record_t* record, const ndn_face_intf_t* face)
+{
+  return record->face == face && record->face_handle == face->handle;
+}
+
+struct ndn_strategy;
+
 /**
  * PIT entry.
  */
 typedef struct ndn_pit_entry {
   /**
-   * The name of representative Interest.
-   * A name with components_size < 0 indicates an empty entry.
+   * The name of representative Interest, allocated from the name arena of the PIT.
+   * NULL indicates an empty entry.
    */
-  ndn_name_t interest_name;
+  ndn_packed_name_t* interest_name;
 
   /**
-   * Collection of incoming faces.
+   * The hash of @c interest_name.
    */
-  ndn_face_intf_t* incoming_face[NDN_MAX_FACE_PER_PIT_ENTRY];
+  uint32_t name_hash;
 
   /**
    * The count of incoming faces.
    */
-  uint8_t incoming_face_size;
+  uint16_t incoming_face_size;
+
+  /**
+   * Collection of incoming faces.
+   */
+  ndn_pit_in_record_t* in_records;
+
+  /**
+   * Collection of faces the Interest has been forwarded to.
+   */
+  ndn_pit_out_record_t* out_records;
+
+  /**
+   * The strategy which forwarded the Interest last.
+   */
+  const struct ndn_strategy* strategy;
 
   /**
-   * @todo How to timeout?
+   * The expiry timer, scheduled at the largest InterestLifetime received.
    */
+  ndn_timer_wheel_node_t expiry;
 } ndn_pit_entry_t;
 
+struct ndn_pit;
+
+/**
+ * The callback invoked when a PIT entry expires, before it is deleted.
+ * @param pit Input. The PIT.
+ * @param entry Input. The expired PIT entry.
+ */
+typedef void (*ndn_pit_expire_callback)(struct ndn_pit* pit, ndn_pit_entry_t* entry);
+
 /**
  * PIT class.
+ * Entries are kept in a caller-supplied array and indexed by name hash.
  */
-typedef ndn_pit_entry_t ndn_pit_t[NDN_PIT_MAX_SIZE];
+typedef struct ndn_pit {
+  /**
+   * The name hash index. Values are positions in @c entries.
+   */
+  ndn_hash_index_t index;
+  /**
+   * The entry array.
+   */
+  ndn_pit_entry_t* entries;
+  /**
+   * The head of the free entry list, linked through @c entries[i].name_hash.
+   */
+  uint32_t free_head;
+  /**
+   * The max number of entries.
+   */
+  uint32_t capacity;
+  /**
+   * The memory pool of in-records and out-records.
+   */
+  void* record_pool;
+  /**
+   * The arena of entry names.
+   */
+  ndn_name_arena_t names;
+  /**
+   * The wheel expiring entries.
+   */
+  ndn_timer_wheel_t wheel;
+  /**
+   * The callback invoked when an entry expires. May be NULL.
+   */
+  ndn_pit_expire_callback on_expire;
+} ndn_pit_t;
+
+/**
+ * The required memory to initialize a PIT holding up to @c capacity entries.
+ * @param capacity Input. The max number of PIT entries.
+ */
+#define NDN_PIT_RESERVE_SIZE(capacity) \
+    (sizeof(ndn_pit_entry_t) * (capacity) \
+     + NDN_HASH_INDEX_RESERVE_SIZE(capacity) \
+     + NDN_MEMORY_POOL_RESERVE_SIZE(sizeof(ndn_pit_face_record_t), \
+                                    (capacity) * NDN_PIT_RECORDS_PER_ENTRY) \
+     + NDN_NAME_ARENA_RESERVE_SIZE((capacity) * NDN_FWD_NAME_BYTES_PER_ENTRY))
+
+/**
+ * Initialize a PIT.
+ * @pre NDN_PIT_RESERVE_SIZE(capacity) bytes needed.
+ * @param pit Output. The PIT to be inited.
+ * @param memory Input. The memory used to keep entries, index, face records and names.
+ *        It should be aligned to a pointer.
+ * @param capacity Input. The max number of PIT entries.
+ * @param on_expire Input. The callback invoked when an entry expires. May be NULL.
+ */
+void
+ndn_pit_init(ndn_pit_t* pit, void* memory, uint32_t capacity, ndn_pit_expire_callback on_expire);
+
+/**
+ * Find the PIT entry of a name.
+ * @param pit Input. The PIT.
+ * @param name Input. The Interest name.
+ * @return The PIT entry. NULL if not found.
+ */
+ndn_pit_entry_t*
+ndn_pit_find(ndn_pit_t* pit, const ndn_name_view_t* name);
+
+/**
+ * Find the PIT entry of a name, or insert a new one if not found.
+ * @param pit Input/Output. The PIT.
+ * @param name Input. The Interest name, copied into a new entry.
+ * @return The PIT entry. NULL if the PIT is out of entries or name memory.
+ */
+ndn_pit_entry_t*
+ndn_pit_find_or_insert(ndn_pit_t* pit, const ndn_name_view_t* name);
+
+/**
+ * Make a PIT entry live at least until @c expire_time.
+ * An entry never expires earlier because of a shorter-lived Interest.
+ * @param pit Input/Output. The PIT.
+ * @param entry Input/Output. The PIT entry.
+ * @param expire_time Input. The time (in milliseconds) at which the entry expires.
+ */
+static inline void
+ndn_pit_extend_expiry(ndn_pit_t* pit, ndn_pit_entry_t* entry, uint64_t expire_time)
+{
+  if (!ndn_timer_wheel_node_is_scheduled(&entry->expiry)
+      || entry->expiry.expire_time < expire_time) {
+    ndn_timer_wheel_schedule(&pit->wheel, &entry->expiry, expire_time);
+  }
+}
+
+/**
+ * Delete a PIT entry and release its face records.
+ * @param pit Input/Output. The PIT.
+ * @param entry Input. The PIT entry.
+ */
+void
+ndn_pit_remove(ndn_pit_t* pit, ndn_pit_entry_t* entry);
 
 /**
- * Add an incoming face to a PIT entry.
+ * Add an incoming face to a PIT entry, or update its Nonce if the face is already there.
+ * @param pit Input/Output. The PIT which owns the record memory.
  * @param entry Input. The PIT entry.
  * @param face Input. The incoming face.
+ * @param nonce Input. The Nonce of the received Interest.
+ * @param now Input. The current time in milliseconds.
  * @return 0 if there is no error.
  */
 int
-pit_entry_add_incoming_face(ndn_pit_entry_t* entry, ndn_face_intf_t* face);
+ndn_pit_add_in_record(ndn_pit_t* pit, ndn_pit_entry_t* entry, ndn_face_intf_t* face,
+                      uint32_t nonce, uint64_t now);
 
 /**
- * Delete a PIT entry.
+ * Add an outgoing face to a PIT entry, or update its Nonce if the face is already there.
+ * @param pit Input/Output. The PIT which owns the record memory.
  * @param entry Input. The PIT entry.
+ * @param face Input. The outgoing face.
+ * @param nonce Input. The Nonce of the sent Interest.
+ * @param now Input. The current time in milliseconds.
+ * @return 0 if there is no error.
  */
-static inline void
-pit_entry_delete(ndn_pit_entry_t* entry)
+int
+ndn_pit_add_out_record(ndn_pit_t* pit, ndn_pit_entry_t* entry, ndn_face_intf_t* face,
+                       uint32_t nonce, uint64_t now);
+
+/**
+ * Check whether a Nonce has been seen by a PIT entry, in either direction.
+ * An Interest carrying such a Nonce is a duplicate or has looped back.
+ * @param entry Input. The PIT entry.
+ * @param nonce Input. The Nonce.
+ * @return true if one of the records holds @c nonce.
+ */
+bool
+ndn_pit_entry_has_nonce(const ndn_pit_entry_t* entry, uint32_t nonce);
+
+/**
+ * Get the last time the Interest of a PIT entry was forwarded.
+ * @param entry Input. The PIT entry.
+ * @return The time in milliseconds. 0 if the Interest has not been forwarded.
+ */
+static inline uint64_t
+ndn_pit_entry_last_forwarded(const ndn_pit_entry_t* entry)
 {
-  entry->interest_name.components_size = NDN_FWD_INVALID_NAME_SIZE;
+  uint64_t last = 0;
+  for (const ndn_pit_out_record_t* record = entry->out_records; record != NULL; record = record->next) {
+    if (record->last_time > last)
+      last = record->last_time;
+  }
+  return last;
 }
 
 /*@}*/
@@ -0,0 +1,326 @@
+/*
+ * Copyright (C) 2019 Xinyu Ma, Zhiyi Zhang
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include "reassembly.h"
+#include "../encode/fec.h"
+#include <string.h>
+
+static inline bool
+reassembly_has_frag(const ndn_reassembly_entry_t* entry, uint32_t index)
+{
+  return (entry->bitmap[index / 32] >> (index % 32)) & 1;
+}
+
+// Whether a fragment at or after index has been received
+static bool
+reassembly_has_frag_from(const ndn_reassembly_entry_t* entry, uint32_t index)
+{
+  for (uint32_t i = index / 32; i < NDN_REASSEMBLY_BITMAP_WORDS; i++) {
+    uint32_t word = entry->bitmap[i];
+    if (i == index / 32)
+      word &= ~((1u << (index % 32)) - 1);
+    if (word != 0)
+      return true;
+  }
+  return false;
+}
+
+// Whether an entry is dropped before another one to make room: delivered packets first,
+// then the packet which has waited longest for a fragment
+static inline bool
+reassembly_evicts_before(const ndn_reassembly_entry_t* entry, const ndn_reassembly_entry_t* other)
+{
+  if (entry->is_done != other->is_done)
+    return entry->is_done;
+  return entry->expiry < other->expiry;
+}
+
+// Find the entry of a packet, making a new one if none. Expired entries are freed on the way.
+static ndn_reassembly_entry_t*
+reassembly_find_or_insert(ndn_reassembly_t* table, ndn_face_intf_t* face, uint64_t identifier, uint64_t now)
+{
+  ndn_reassembly_entry_t* found = NULL;
+  ndn_reassembly_entry_t* victim = NULL;
+  for (uint32_t i = 0; i < table->capacity; i++) {
+    ndn_reassembly_entry_t* entry = &table->entries[i];
+    if (entry->face != NULL && entry->expiry <= now) {
+      entry->face = NULL;
+    }
+    if (entry->face == NULL) {
+      if (victim == NULL || victim->face != NULL)
+        victim = entry;
+    }
+    else if (entry->face == face && entry->identifier == identifier) {
+      found = entry;
+    }
+    else if (victim == NULL || (victim->face != NULL && reassembly_evicts_before(entry, victim))) {
+      victim = entry;
+    }
+  }
+  if (found != NULL || victim == NULL) {
+    return found;
+  }
+
+  victim->face = face;
+  victim->identifier = identifier;
+  victim->size = 0;
+  victim->frag_count = 0;
+  victim->received = 0;
+  victim->unit = 0;
+  victim->last_size = 0;
+  victim->parity_received = 0;
+  victim->fec_size = 0;
+  memset(victim->bitmap, 0, sizeof(victim->bitmap));
+  victim->is_done = false;
+  victim->is_nack = false;
+  victim->nack_reason = 0;
+  return victim;
+}
+
+// Set the block size of a packet, moving the last fragment waiting at the end to its place
+static int
+reassembly_set_unit(ndn_reassembly_t* table, ndn_reassembly_entry_t* entry, uint32_t unit)
+{
+  entry->unit = unit;
+  if (entry->frag_count > 1 && reassembly_has_frag(entry, entry->frag_count - 1)) {
+    uint32_t last_offset = (entry->frag_count - 1) * unit;
+    if (entry->last_size > unit)
+      return NDN_FRAG_MALFORMED;
+    if (last_offset + entry->last_size > table->buffer_size)
+      return NDN_OVERSIZE;
+    memmove(entry->buffer + last_offset, entry->buffer + table->buffer_size - entry->last_size,
+            entry->last_size);
+  }
+  return 0;
+}
+
+// Copy a fragment to its place in the entry buffer
+static int
+reassembly_place(ndn_reassembly_t* table, ndn_reassembly_entry_t* entry, uint32_t index,
+                 const uint8_t* payload, uint32_t size)
+{
+  int ret = 0;
+  bool is_last = (entry->frag_count != 0 && index == entry->frag_count - 1);
+  uint32_t offset = 0;
+  if (is_last) {
+    if (entry->unit != 0 && size > entry->unit) {
+      return NDN_FRAG_MALFORMED;
+    }
+    entry->last_size = size;
+    if (entry->unit != 0 || index == 0) {
+      offset = index * entry->unit;
+    }
+    else {
+      // wait at the end until the place is known
+      if (size > table->buffer_size)
+        return NDN_OVERSIZE;
+      offset = table->buffer_size - size;
+    }
+  }
+  else {
+    if (size == 0 || (entry->unit != 0 && size != entry->unit)) {
+      return NDN_FRAG_MALFORMED;
+    }
+    if (entry->unit == 0) {
+      ret = reassembly_set_unit(table, entry, size);
+      if (ret != 0) return ret;
+    }
+    offset = index * entry->unit;
+  }
+  if (offset + size > table->buffer_size) {
+    return NDN_OVERSIZE;
+  }
+  memcpy(entry->buffer + offset, payload, size);
+  return 0;
+}
+
+// Rebuild the lost data fragments once enough parity fragments are received
+static void
+reassembly_recover(ndn_reassembly_entry_t* entry)
+{
+  uint32_t lost[NDN_FEC_MAX_PARITY];
+  uint32_t parities[NDN_FEC_MAX_PARITY];
+  uint32_t lost_count = 0;
+  uint32_t parity_count = 0;
+  uint32_t n = entry->frag_count;
+
+  if (entry->parity_received == 0 || entry->received + entry->parity_received < n
+      || entry->frag_count - entry->received > NDN_FEC_MAX_PARITY) {
+    return;
+  }
+  for (uint32_t i = 0; i < n; i++) {
+    if (!reassembly_has_frag(entry, i))
+      lost[lost_count++] = i;
+  }
+  for (uint32_t j = 0; j < NDN_FEC_MAX_PARITY && n + j < NDN_REASSEMBLY_MAX_FRAGS; j++) {
+    if (reassembly_has_frag(entry, n + j))
+      parities[parity_count++] = j;
+  }
+  // the blocks are encoded with the last one padded with zeros
+  if (reassembly_has_frag(entry, n - 1)) {
+    memset(entry->buffer + (n - 1) * entry->unit + entry->last_size, 0, entry->unit - entry->last_size);
+  }
+  if (ndn_fec_decode(entry->buffer, entry->unit, n, lost, lost_count, parities, parity_count) != 0) {
+    return;
+  }
+  for (uint32_t m = 0; m < lost_count; m++) {
+    entry->bitmap[lost[m] / 32] |= 1u << (lost[m] % 32);
+  }
+  entry->received = n;
+  entry->last_size = entry->fec_size - (n - 1) * entry->unit;
+}
+
+void
+ndn_reassembly_init(ndn_reassembly_t* table, void* memory, uint32_t capacity, uint32_t buffer_size)
+{
+  uint8_t* buffers = (uint8_t*)memory + sizeof(ndn_reassembly_entry_t) * capacity;
+  uint32_t stride = (buffer_size + NDN_REASSEMBLY_PARITY_SIZE + 7) & ~7u;
+  table->entries = (ndn_reassembly_entry_t*)memory;
+  table->capacity = capacity;
+  table->buffer_size = buffer_size;
+  table->parity_dropped = 0;
+  for (uint32_t i = 0; i < capacity; i++) {
+    table->entries[i].face = NULL;
+    table->entries[i].buffer = buffers + (size_t)i * stride;
+  }
+}
+
+int
+ndn_reassembly_add(ndn_reassembly_t* table, ndn_face_intf_t* face, uint64_t identifier,
+                   uint32_t index, uint32_t frag_count, const uint8_t* payload, uint32_t size,
+                   uint64_t now, ndn_reassembly_entry_t** result)
+{
+  int ret = 0;
+  *result = NULL;
+  ndn_reassembly_entry_t* entry = reassembly_find_or_insert(table, face, identifier, now);
+  if (entry == NULL) {
+    return NDN_FRAG_NO_MEM;
+  }
+  if (entry->is_done) {
+    // a late fragment of a delivered packet
+    *result = entry;
+    return 0;
+  }
+  entry->expiry = now + NDN_REASSEMBLY_TIMEOUT;
+
+  if (index >= NDN_REASSEMBLY_MAX_FRAGS || frag_count > NDN_REASSEMBLY_MAX_FRAGS) {
+    ret = NDN_OVERSIZE;
+  }
+  else if (frag_count != 0 && ((entry->frag_count != 0 && frag_count != entry->frag_count)
+                               || index >= frag_count)) {
+    ret = NDN_FRAG_MALFORMED;
+  }
+  else if (entry->frag_count != 0 && index >= entry->frag_count) {
+    ret = NDN_FRAG_MALFORMED;
+  }
+  if (ret == 0 && frag_count != 0 && entry->frag_count == 0) {
+    // a fragment received earlier may lie past the last one
+    if (reassembly_has_frag_from(entry, frag_count)) {
+      ret = NDN_FRAG_MALFORMED;
+    }
+    entry->frag_count = frag_count;
+  }
+  if (ret != 0) {
+    ndn_reassembly_remove(table, entry);
+    return ret;
+  }
+  *result = entry;
+  if (reassembly_has_frag(entry, index)) {
+    // a duplicate
+    return 0;
+  }
+
+  ret = reassembly_place(table, entry, index, payload, size);
+  if (ret != 0) {
+    *result = NULL;
+    ndn_reassembly_remove(table, entry);
+    return ret;
+  }
+  entry->bitmap[index / 32] |= 1u << (index % 32);
+  entry->received ++;
+  if (!ndn_reassembly_is_complete(entry)) {
+    reassembly_recover(entry);
+  }
+  if (ndn_reassembly_is_complete(entry)) {
+    entry->size = (entry->frag_count - 1) * entry->unit + entry->last_size;
+  }
+  return 0;
+}
+
+int
+ndn_reassembly_add_parity(ndn_reassembly_t* table, ndn_face_intf_t* face, uint64_t identifier,
+                          uint32_t frag_count, uint32_t parity_index, uint32_t packet_size,
+                          const uint8_t* payload, uint32_t size, uint64_t now,
+                          ndn_reassembly_entry_t** result)
+{
+  int ret = 0;
+  *result = NULL;
+  ndn_reassembly_entry_t* entry = reassembly_find_or_insert(table, face, identifier, now);
+  if (entry == NULL) {
+    return NDN_FRAG_NO_MEM;
+  }
+  if (entry->is_done) {
+    // a late fragment of a delivered packet
+    *result = entry;
+    return 0;
+  }
+  entry->expiry = now + NDN_REASSEMBLY_TIMEOUT;
+
+  uint32_t index = frag_count + parity_index;
+  if (frag_count == 0 || size == 0 || parity_index >= NDN_FEC_MAX_PARITY
+      || (entry->frag_count != 0 && entry->frag_count != frag_count)
+      || (entry->unit != 0 && entry->unit != size)
+      || (entry->fec_size != 0 && entry->fec_size != packet_size)
+      || packet_size <= (frag_count - 1) * size || packet_size > frag_count * size) {
+    ret = NDN_FRAG_MALFORMED;
+  }
+  else if (index >= NDN_REASSEMBLY_MAX_FRAGS) {
+    ret = NDN_OVERSIZE;
+  }
+  else if (entry->frag_count == 0 && reassembly_has_frag_from(entry, frag_count)) {
+    ret = NDN_FRAG_MALFORMED;
+  }
+  if (ret == 0) {
+    entry->frag_count = frag_count;
+    entry->fec_size = packet_size;
+    if (entry->unit == 0)
+      ret = reassembly_set_unit(table, entry, size);
+  }
+  if (ret != 0) {
+    ndn_reassembly_remove(table, entry);
+    return ret;
+  }
+  *result = entry;
+  if (ndn_reassembly_is_complete(entry) || reassembly_has_frag(entry, index)) {
+    return 0;
+  }
+  // a parity fragment is only an aid: one which does not fit is ignored
+  if ((index + 1) * size > table->buffer_size + NDN_REASSEMBLY_PARITY_SIZE) {
+    table->parity_dropped ++;
+    return 0;
+  }
+
+  memcpy(entry->buffer + index * size, payload, size);
+  entry->bitmap[index / 32] |= 1u << (index % 32);
+  entry->parity_received ++;
+  reassembly_recover(entry);
+  if (ndn_reassembly_is_complete(entry)) {
+    entry->size = packet_size;
+  }
+  return 0;
+}
+
+void
+ndn_reassembly_remove_face(ndn_reassembly_t* table, const ndn_face_intf_t* face)
+{
+  for (uint32_t i = 0; i < table->capacity; i++) {
+    if (table->entries[i].face == face) {
+      table->entries[i].face = NULL;
+    }
+  }
+}
@@ -0,0 +1,244 @@
+/*
+ * Copyright (C) 2019 Xinyu Ma, Zhiyi Zhang
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#ifndef FORWARDER_REASSEMBLY_H_
+#define FORWARDER_REASSEMBLY_H_
+
+#include "face.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup NDNFwdReassembly Reassembly Table
+ * @brief The packets being reassembled from link layer fragments
+ * @ingroup NDNFwd
+ *
+ * Each entry reassembles one packet, identified by the face it comes from and its fragment
+ * identifier, so fragments of packets from different faces or senders may interleave.
+ * Fragments are accepted in any order: all fragments but the last have the same payload size,
+ * so each one is copied right to its place in the entry buffer and a bitmap tracks which have
+ * arrived. A packet may be as large as the entry buffer and have up to
+ * NDN_REASSEMBLY_MAX_FRAGS fragments.
+ * Parity fragments (see fec.h) are kept after the data fragments in the buffer, which has
+ * NDN_REASSEMBLY_PARITY_SIZE more bytes for them, and lost data fragments are rebuilt from them
+ * as soon as as many fragments as the packet has arrived.
+ * An entry is dropped when no fragment arrived for NDN_REASSEMBLY_TIMEOUT milliseconds,
+ * or to make room for a new packet when the table is full.
+ * @{
+ */
+
+/**
+ * The number of 32-bit words of the fragment bitmap of an entry.
+ */
+#define NDN_REASSEMBLY_BITMAP_WORDS ((NDN_REASSEMBLY_MAX_FRAGS + 31) / 32)
+
+/**
+ * A packet being reassembled.
+ */
+typedef struct ndn_reassembly_entry {
+  /**
+   * The face the fragments come from. NULL for a free entry.
+   */
+  ndn_face_intf_t* face;
+  /**
+   * The fragment identifier.
+   */
+  uint64_t identifier;
+  /**
+   * The time (in milliseconds) the entry is dropped if no more fragment arrives.
+   */
+  uint64_t expiry;
+  /**
+   * The buffer keeping the packet, then its parity fragments.
+   */
+  uint8_t* buffer;
+  /**
+   * The size of the packet, valid once it is complete.
+   */
+  uint32_t size;
+  /**
+   * The number of fragments of the packet. 0 until it is known.
+   */
+  uint32_t frag_count;
+  /**
+   * The number of distinct fragments received.
+   */
+  uint32_t received;
+  /**
+   * The payload size of every fragment but the last. 0 until one is received.
+   */
+  uint32_t unit;
+  /**
+   * The payload size of the last fragment. 0 until it is received.
+   * Until @c unit is known, the last fragment waits at the end of @c buffer.
+   */
+  uint32_t last_size;
+  /**
+   * The number of distinct parity fragments received.
+   */
+  uint32_t parity_received;
+  /**
+   * The size of the packet told by its parity fragments. 0 until one is received.
+   */
+  uint32_t fec_size;
+  /**
+   * The fragments received. Parity fragment j is at bit @c frag_count + j.
+   */
+  uint32_t bitmap[NDN_REASSEMBLY_BITMAP_WORDS];
+  /**
+   * Whether the packet has been delivered. The entry then absorbs the late fragments of the
+   * packet until it expires, so that they do not rebuild it again.
+   */
+  bool is_done;
+  /**
+   * Whether the first fragment carries an NDNLPv2 Nack header, set by the receiver.
+   */
+  bool is_nack;
+  /**
+   * The Nack reason, when @c is_nack is set.
+   */
+  uint8_t nack_reason;
+} ndn_reassembly_entry_t;
+
+/**
+ * Reassembly table class.
+ */
+typedef struct ndn_reassembly {
+  /**
+   * The entry array.
+   */
+  ndn_reassembly_entry_t* entries;
+  /**
+   * The max number of packets reassembled at the same time.
+   */
+  uint32_t capacity;
+  /**
+   * The size of the buffer of each entry, i.e. the largest packet.
+   */
+  uint32_t buffer_size;
+  /**
+   * The number of parity fragments ignored for lack of room after their packet.
+   */
+  uint32_t parity_dropped;
+} ndn_reassembly_t;
+
+/**
+ * The required memory to initialize a reassembly table.
+ * @param capacity Input. The max number of packets reassembled at the same time.
+ * @param buffer_size Input. The largest packet.
+ */
+#define NDN_REASSEMBLY_RESERVE_SIZE(capacity, buffer_size) \
+    ((sizeof(ndn_reassembly_entry_t) \
+      + (((buffer_size) + NDN_REASSEMBLY_PARITY_SIZE + 7) & ~(size_t)7)) * (capacity))
+
+/**
+ * Initialize an empty reassembly table.
+ * @pre NDN_REASSEMBLY_RESERVE_SIZE(capacity, buffer_size) bytes needed, aligned to 8 bytes.
+ * @param table Output. The reassembly table.
+ * @param memory Input. The memory used to keep the entries and their buffers.
+ * @param capacity Input. The max number of packets reassembled at the same time.
+ * @param buffer_size Input. The largest packet.
+ */
+void
+ndn_reassembly_init(ndn_reassembly_t* table, void* memory, uint32_t capacity, uint32_t buffer_size);
+
+/**
+ * Add a fragment to the packet it belongs to.
+ * @param table Input/Output. The reassembly table.
+ * @param face Input. The face the fragment comes from.
+ * @param identifier Input. The identifier shared by the fragments of the packet.
+ * @param index Input. The index of the fragment in the packet.
+ * @param frag_count Input. The number of fragments of the packet, 0 if the fragment does not tell.
+ * @param payload Input. The payload of the fragment.
+ * @param size Input. The size of @c payload.
+ * @param now Input. The current time in milliseconds.
+ * @param entry Output. The entry of the packet. NULL if the packet is dropped.
+ *        Once ndn_reassembly_is_complete(), the caller removes it with ndn_reassembly_remove()
+ *        or ndn_reassembly_finish() after use.
+ * @return 0 if there is no error. NDN_OVERSIZE if the packet exceeds the entry buffer or
+ *         NDN_REASSEMBLY_MAX_FRAGS fragments. NDN_FRAG_MALFORMED if the fragment does not
+ *         agree with the others. The packet is dropped on error.
+ */
+int
+ndn_reassembly_add(ndn_reassembly_t* table, ndn_face_intf_t* face, uint64_t identifier,
+                   uint32_t index, uint32_t frag_count, const uint8_t* payload, uint32_t size,
+                   uint64_t now, ndn_reassembly_entry_t** entry);
+
+/**
+ * Add a parity fragment to the packet it belongs to.
+ * @param table Input/Output. The reassembly table.
+ * @param face Input. The face the fragment comes from.
+ * @param identifier Input. The identifier shared by the fragments of the packet.
+ * @param frag_count Input. The number of data fragments of the packet.
+ * @param parity_index Input. The index of the parity fragment, smaller than NDN_FEC_MAX_PARITY.
+ * @param packet_size Input. The size of the packet.
+ * @param payload Input. The parity block, as large as every data fragment but the last.
+ * @param size Input. The size of @c payload.
+ * @param now Input. The current time in milliseconds.
+ * @param entry Output. The entry of the packet, as ndn_reassembly_add().
+ * @return 0 if there is no error. NDN_FRAG_MALFORMED if the fragment does not agree with
+ *         the others, and the packet is dropped. A parity fragment past the room after the
+ *         packet is ignored and counted in ndn_reassembly#parity_dropped.
+ */
+int
+ndn_reassembly_add_parity(ndn_reassembly_t* table, ndn_face_intf_t* face, uint64_t identifier,
+                          uint32_t frag_count, uint32_t parity_index, uint32_t packet_size,
+                          const uint8_t* payload, uint32_t size, uint64_t now,
+                          ndn_reassembly_entry_t** entry);
+
+/**
+ * Check whether all data fragments of a packet have been received or rebuilt.
+ * @param entry Input. The entry.
+ */
+static inline bool
+ndn_reassembly_is_complete(const ndn_reassembly_entry_t* entry)
+{
+  return !entry->is_done && entry->frag_count != 0 && entry->received == entry->frag_count;
+}
+
+/**
+ * Free an entry.
+ * @param table Input/Output. The reassembly table.
+ * @param entry Input. The entry.
+ */
+static inline void
+ndn_reassembly_remove(ndn_reassembly_t* table, ndn_reassembly_entry_t* entry)
+{
+  (void)table;
+  entry->face = NULL;
+}
+
+/**
+ * Mark the packet of an entry as delivered, keeping the entry until it expires to absorb the
+ * parity fragments still on their way. The entry is the first one dropped to make room.
+ * @param table Input/Output. The reassembly table.
+ * @param entry Input. The complete entry.
+ */
+static inline void
+ndn_reassembly_finish(ndn_reassembly_t* table, ndn_reassembly_entry_t* entry)
+{
+  (void)table;
+  entry->is_done = true;
+}
+
+/**
+ * Drop the packets being reassembled from a face.
+ * @param table Input/Output. The reassembly table.
+ * @param face Input. The face.
+ */
+void
+ndn_reassembly_remove_face(ndn_reassembly_t* table, const ndn_face_intf_t* face);
+
+/*@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FORWARDER_REASSEMBLY_H_
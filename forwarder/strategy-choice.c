@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2019 Xinyu Ma, Zhiyi Zhang
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include "strategy-choice.h"
+
+static ndn_strategy_choice_entry_t*
+strategy_choice_find_exact(const ndn_strategy_choice_t* table, const ndn_packed_name_t* name_prefix,
+                           uint32_t name_hash)
+{
+  uint32_t pos = ndn_hash_index_home(&table->index, name_hash);
+  uint32_t i;
+  while ((i = ndn_hash_index_probe(&table->index, name_hash, &pos)) != NDN_HASH_INDEX_EMPTY) {
+    if (ndn_packed_name_compare(table->entries[i].name_prefix, name_prefix) == 0) {
+      return &table->entries[i];
+    }
+    pos = (pos + 1) & table->index.mask;
+  }
+  return NULL;
+}
+
+void
+ndn_strategy_choice_init(ndn_strategy_choice_t* table, void* memory, uint32_t capacity,
+                         const ndn_strategy_t* default_strategy)
+{
+  uint8_t* ptr = (uint8_t*)memory;
+
+  table->entries = (ndn_strategy_choice_entry_t*)ptr;
+  table->capacity = capacity;
+  ptr += sizeof(ndn_strategy_choice_entry_t) * capacity;
+  ndn_hash_index_init(&table->index, ptr, capacity);
+  ptr += NDN_HASH_INDEX_RESERVE_SIZE(capacity);
+  ndn_name_arena_init(&table->names, ptr, capacity * NDN_FWD_NAME_BYTES_PER_ENTRY);
+  table->free_head = NDN_HASH_INDEX_EMPTY;
+  for (uint32_t i = capacity; i > 0; i--) {
+    table->entries[i - 1].name_prefix = NULL;
+    table->entries[i - 1].name_hash = table->free_head;
+    table->free_head = i - 1;
+  }
+  for (uint32_t i = 0; i <= NDN_NAME_VIEW_COMPONENTS_SIZE; i++) {
+    table->length_count[i] = 0;
+  }
+  table->default_strategy = default_strategy;
+}
+
+int
+ndn_strategy_choice_set(ndn_strategy_choice_t* table, const ndn_packed_name_t* name_prefix,
+                        const ndn_strategy_t* strategy)
+{
+  if (name_prefix->components_size > NDN_NAME_VIEW_COMPONENTS_SIZE) {
+    return NDN_OVERSIZE;
+  }
+  uint32_t name_hash = ndn_packed_name_hash(name_prefix);
+  ndn_strategy_choice_entry_t* entry = strategy_choice_find_exact(table, name_prefix, name_hash);
+  if (entry != NULL) {
+    entry->strategy = strategy;
+    return 0;
+  }
+
+  if (table->free_head == NDN_HASH_INDEX_EMPTY) {
+    return NDN_FWD_STRATEGY_CHOICE_FULL;
+  }
+  ndn_packed_name_t* copy = ndn_name_arena_copy(&table->names, name_prefix);
+  if (copy == NULL) {
+    return NDN_FWD_STRATEGY_CHOICE_FULL;
+  }
+  uint32_t i = table->free_head;
+  entry = &table->entries[i];
+  table->free_head = entry->name_hash;
+
+  entry->name_prefix = copy;
+  entry->name_hash = name_hash;
+  entry->strategy = strategy;
+  ndn_hash_index_insert(&table->index, name_hash, i);
+  table->length_count[name_prefix->components_size] ++;
+  return 0;
+}
+
+void
+ndn_strategy_choice_unset(ndn_strategy_choice_t* table, const ndn_packed_name_t* name_prefix)
+{
+  uint32_t name_hash = ndn_packed_name_hash(name_prefix);
+  ndn_strategy_choice_entry_t* entry = strategy_choice_find_exact(table, name_prefix, name_hash);
+  if (entry == NULL) {
+    return;
+  }
+  uint32_t i = (uint32_t)(entry - table->entries);
+  ndn_hash_index_remove(&table->index, name_hash, i);
+  table->length_count[name_prefix->components_size] --;
+
+  ndn_name_arena_release(&table->names, entry->name_prefix);
+  entry->name_prefix = NULL;
+  entry->strategy = NULL;
+  entry->name_hash = table->free_head;
+  table->free_head = i;
+}
+
+const ndn_strategy_t*
+ndn_strategy_choice_lookup(const ndn_strategy_choice_t* table, const ndn_name_view_t* name)
+{
+  for (uint32_t len = name->components_size + 1; len > 0; len--) {
+    if (table->length_count[len - 1] == 0) {
+      continue;
+    }
+    uint32_t hash = name->prefix_hashes[len - 1];
+    uint32_t pos = ndn_hash_index_home(&table->index, hash);
+    uint32_t i;
+    while ((i = ndn_hash_index_probe(&table->index, hash, &pos)) != NDN_HASH_INDEX_EMPTY) {
+      if (ndn_name_view_prefix_equals(name, len - 1, table->entries[i].name_prefix)) {
+        return table->entries[i].strategy;
+      }
+      pos = (pos + 1) & table->index.mask;
+    }
+  }
+  return table->default_strategy;
+}
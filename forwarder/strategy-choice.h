@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2019 Xinyu Ma, Zhiyi Zhang
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#ifndef FORWARDER_STRATEGY_CHOICE_H_
+#define FORWARDER_STRATEGY_CHOICE_H_
+
+#include "strategy.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup NDNFwdStrategyChoice Strategy Choice Table
+ * @brief Which strategy forwards which name prefix
+ * @ingroup NDNFwd
+ * @{
+ */
+
+/**
+ * Strategy choice entry.
+ */
+typedef struct ndn_strategy_choice_entry {
+  /**
+   * The name prefix, allocated from the name arena of the table.
+   * NULL indicates an empty entry.
+   */
+  ndn_packed_name_t* name_prefix;
+  /**
+   * The hash of @c name_prefix.
+   * For an empty entry, it links to the next free entry.
+   */
+  uint32_t name_hash;
+  /**
+   * The strategy of the prefix.
+   */
+  const ndn_strategy_t* strategy;
+} ndn_strategy_choice_entry_t;
+
+/**
+ * Strategy choice table class.
+ * Like the FIB, it is indexed by prefix hash and looked up by longest prefix match.
+ */
+typedef struct ndn_strategy_choice {
+  /**
+   * The prefix hash index. Values are positions in @c entries.
+   */
+  ndn_hash_index_t index;
+  /**
+   * The entry array.
+   */
+  ndn_strategy_choice_entry_t* entries;
+  /**
+   * The head of the free entry list.
+   */
+  uint32_t free_head;
+  /**
+   * The max number of entries.
+   */
+  uint32_t capacity;
+  /**
+   * The number of entries per prefix length.
+   */
+  uint32_t length_count[NDN_NAME_VIEW_COMPONENTS_SIZE + 1];
+  /**
+   * The arena of entry prefixes.
+   */
+  ndn_name_arena_t names;
+  /**
+   * The strategy of names matching no entry.
+   */
+  const ndn_strategy_t* default_strategy;
+} ndn_strategy_choice_t;
+
+/**
+ * The required memory to initialize a strategy choice table holding up to @c capacity entries.
+ * @param capacity Input. The max number of entries.
+ */
+#define NDN_STRATEGY_CHOICE_RESERVE_SIZE(capacity) \
+    (sizeof(ndn_strategy_choice_entry_t) * (capacity) + NDN_HASH_INDEX_RESERVE_SIZE(capacity) \
+     + NDN_NAME_ARENA_RESERVE_SIZE((capacity) * NDN_FWD_NAME_BYTES_PER_ENTRY))
+
+/**
+ * Initialize an empty strategy choice table.
+ * @pre NDN_STRATEGY_CHOICE_RESERVE_SIZE(capacity) bytes needed.
+ * @param table Output. The table to be inited.
+ * @param memory Input. The memory used to keep entries, index and prefixes.
+ *        It should be aligned to a pointer.
+ * @param capacity Input. The max number of entries.
+ * @param default_strategy Input. The strategy of names matching no entry.
+ */
+void
+ndn_strategy_choice_init(ndn_strategy_choice_t* table, void* memory, uint32_t capacity,
+                         const ndn_strategy_t* default_strategy);
+
+/**
+ * Set the strategy of a name prefix, replacing the old one if any.
+ * @param table Input/Output. The table.
+ * @param name_prefix Input. The name prefix, copied into a new entry.
+ * @param strategy Input. The strategy.
+ * @return 0 if there is no error. NDN_FWD_STRATEGY_CHOICE_FULL if the table is out of
+ *         entries or name memory. NDN_OVERSIZE if the prefix has more than
+ *         NDN_NAME_VIEW_COMPONENTS_SIZE components.
+ */
+int
+ndn_strategy_choice_set(ndn_strategy_choice_t* table, const ndn_packed_name_t* name_prefix,
+                        const ndn_strategy_t* strategy);
+
+/**
+ * Unset the strategy of a name prefix, so that the prefix follows its parent.
+ * @param table Input/Output. The table.
+ * @param name_prefix Input. The name prefix.
+ */
+void
+ndn_strategy_choice_unset(ndn_strategy_choice_t* table, const ndn_packed_name_t* name_prefix);
+
+/**
+ * Find the strategy of a name by longest prefix match.
+ * @param table Input. The table.
+ * @param name Input. The name.
+ * @return The strategy. Never NULL.
+ */
+const ndn_strategy_t*
+ndn_strategy_choice_lookup(const ndn_strategy_choice_t* table, const ndn_name_view_t* name);
+
+/*@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FORWARDER_STRATEGY_CHOICE_H_
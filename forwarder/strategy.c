@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2019 Xinyu Ma, Zhiyi Zhang
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include "strategy.h"
+#include "forwarder.h"
+
+static bool
+strategy_has_out_face(const ndn_pit_entry_t* pit_entry, const ndn_face_intf_t* face)
+{
+  for (const ndn_pit_out_record_t* record = pit_entry->out_records; record != NULL; record = record->next) {
+    if (ndn_pit_record_is_face(record, face))
+      return true;
+  }
+  return false;
+}
+
+/************************************************************/
+/*  Best-route strategy                                     */
+/************************************************************/
+
+static int
+best_route_after_receive_interest(ndn_forwarder_t* forwarder, ndn_face_intf_t* face,
+                                  const ndn_name_view_t* name, const uint8_t* raw_interest, uint32_t size,
+                                  ndn_pit_entry_t* pit_entry, const ndn_fib_entry_t* fib_entry,
+                                  uint32_t nonce, uint64_t now)
+{
+  if (fib_entry == NULL) {
+    return NDN_FWD_INTEREST_REJECTED;
+  }
+  // the first pass skips the next-hops already tried by this PIT entry
+  for (int pass = 0; pass < 2; pass++) {
+    for (uint8_t i = 0; i < fib_entry->nexthop_count; i++) {
+      ndn_face_intf_t* next_hop = fib_entry->nexthops[i].face;
+      if (!ndn_face_table_is_alive(&forwarder->face_table, fib_entry->nexthops[i].face_handle)
+          || next_hop == face || next_hop->state != NDN_FACE_STATE_UP)
+        continue;
+      if (pass == 0 && strategy_has_out_face(pit_entry, next_hop))
+        continue;
+      if (ndn_forwarder_forward_interest(next_hop, name, raw_interest, size, pit_entry, nonce, now) == 0)
+        return 0;
+    }
+  }
+  return NDN_FWD_INTEREST_REJECTED;
+}
+
+static void
+best_route_on_nack(ndn_forwarder_t* forwarder, ndn_face_intf_t* face,
+                   const ndn_name_view_t* name, const uint8_t* raw_interest, uint32_t size,
+                   ndn_pit_entry_t* pit_entry, const ndn_fib_entry_t* fib_entry,
+                   uint8_t reason, uint64_t now)
+{
+  (void)reason;
+  if (fib_entry == NULL) {
+    return;
+  }
+  uint32_t nonce = 0;
+  for (const ndn_pit_out_record_t* record = pit_entry->out_records; record != NULL; record = record->next) {
+    if (ndn_pit_record_is_face(record, face))
+      nonce = record->nonce;
+  }
+  // try the cheapest next-hop not used yet
+  for (uint8_t i = 0; i < fib_entry->nexthop_count; i++) {
+    ndn_face_intf_t* next_hop = fib_entry->nexthops[i].face;
+    if (!ndn_face_table_is_alive(&forwarder->face_table, fib_entry->nexthops[i].face_handle)
+        || next_hop->state != NDN_FACE_STATE_UP || strategy_has_out_face(pit_entry, next_hop))
+      continue;
+    bool is_downstream = false;
+    for (const ndn_pit_in_record_t* record = pit_entry->in_records; record != NULL; record = record->next) {
+      if (ndn_pit_record_is_face(record, next_hop))
+        is_downstream = true;
+    }
+    if (is_downstream)
+      continue;
+    if (ndn_forwarder_forward_interest(next_hop, name, raw_interest, size, pit_entry, nonce, now) == 0)
+      return;
+  }
+}
+
+const ndn_strategy_t ndn_strategy_best_route = {
+  .after_receive_interest = best_route_after_receive_interest,
+  .after_receive_data = NULL,
+  .on_timeout = NULL,
+  .on_nack = best_route_on_nack,
+};
+
+/************************************************************/
+/*  Multicast strategy                                      */
+/************************************************************/
+
+static int
+multicast_after_receive_interest(ndn_forwarder_t* forwarder, ndn_face_intf_t* face,
+                                 const ndn_name_view_t* name, const uint8_t* raw_interest, uint32_t size,
+                                 ndn_pit_entry_t* pit_entry, const ndn_fib_entry_t* fib_entry,
+                                 uint32_t nonce, uint64_t now)
+{
+  int ret = NDN_FWD_INTEREST_REJECTED;
+  if (fib_entry == NULL) {
+    return ret;
+  }
+  for (uint8_t i = 0; i < fib_entry->nexthop_count; i++) {
+    ndn_face_intf_t* next_hop = fib_entry->nexthops[i].face;
+    if (!ndn_face_table_is_alive(&forwarder->face_table, fib_entry->nexthops[i].face_handle)
+        || next_hop == face || next_hop->state != NDN_FACE_STATE_UP)
+      continue;
+    if (ndn_forwarder_forward_interest(next_hop, name, raw_interest, size, pit_entry, nonce, now) == 0)
+      ret = 0;
+  }
+  return ret;
+}
+
+const ndn_strategy_t ndn_strategy_multicast = {
+  .after_receive_interest = multicast_after_receive_interest,
+  .after_receive_data = NULL,
+  .on_timeout = NULL,
+  .on_nack = NULL,
+};
@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2019 Xinyu Ma, Zhiyi Zhang
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#ifndef FORWARDER_STRATEGY_H_
+#define FORWARDER_STRATEGY_H_
+
+#include "pit.h"
+#include "fib.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup NDNFwdStrategy Strategy
+ * @brief Forwarding strategies
+ * @ingroup NDNFwd
+ *
+ * A strategy decides where an Interest goes. It is chosen per name prefix with
+ * ndn_forwarder_set_strategy(), and is called back through the trigger functions below.
+ * All triggers except ndn_strategy#after_receive_interest are optional.
+ * @{
+ */
+
+struct ndn_forwarder;
+
+/**
+ * The trigger invoked when an Interest is to be forwarded.
+ * The strategy sends it with ndn_forwarder_forward_interest().
+ * @param forwarder Input/Output. The forwarder.
+ * @param face Input. The face the Interest came from.
+ * @param name Input. The Interest name.
+ * @param raw_interest Input. The wire format Interest.
+ * @param size Input. The size of the wire format Interest.
+ * @param pit_entry Input/Output. The PIT entry of the Interest.
+ * @param fib_entry Input. The FIB entry matching the Interest. NULL if there is no route.
+ * @param nonce Input. The Nonce of the Interest.
+ * @param now Input. The current time in milliseconds.
+ * @return 0 if the Interest has been forwarded.
+ */
+typedef int (*ndn_strategy_after_receive_interest)(struct ndn_forwarder* forwarder, ndn_face_intf_t* face,
+                                                   const ndn_name_view_t* name,
+                                                   const uint8_t* raw_interest, uint32_t size,
+                                                   ndn_pit_entry_t* pit_entry,
+                                                   const ndn_fib_entry_t* fib_entry,
+                                                   uint32_t nonce, uint64_t now);
+
+/**
+ * The trigger invoked when a Data satisfies a PIT entry, before the Data is
+ * returned to the downstream faces.
+ * @param forwarder Input/Output. The forwarder.
+ * @param face Input. The face the Data came from.
+ * @param pit_entry Input. The PIT entry satisfied.
+ * @param raw_data Input. The wire format Data.
+ * @param size Input. The size of the wire format Data.
+ * @param now Input. The current time in milliseconds.
+ */
+typedef void (*ndn_strategy_after_receive_data)(struct ndn_forwarder* forwarder, ndn_face_intf_t* face,
+                                                ndn_pit_entry_t* pit_entry,
+                                                const uint8_t* raw_data, uint32_t size, uint64_t now);
+
+/**
+ * The trigger invoked when a PIT entry expires, before it is deleted.
+ * @param forwarder Input/Output. The forwarder.
+ * @param pit_entry Input. The expired PIT entry.
+ * @param now Input. The current time in milliseconds.
+ */
+typedef void (*ndn_strategy_on_timeout)(struct ndn_forwarder* forwarder, ndn_pit_entry_t* pit_entry,
+                                        uint64_t now);
+
+/**
+ * The trigger invoked when an upstream face answers a forwarded Interest with a Nack.
+ * The out-record of @c face has been marked with @c reason. The strategy may forward the
+ * Interest to another face. When no out-record is left pending after the trigger, the forwarder
+ * returns a Nack with the least severe reason to the downstream faces.
+ * @param forwarder Input/Output. The forwarder.
+ * @param face Input. The face the Nack came from.
+ * @param name Input. The Interest name.
+ * @param raw_interest Input. The wire format Nacked Interest.
+ * @param size Input. The size of the wire format Interest.
+ * @param pit_entry Input/Output. The PIT entry of the Interest.
+ * @param fib_entry Input. The FIB entry matching the Interest. NULL if there is no route.
+ * @param reason Input. The Nack reason.
+ * @param now Input. The current time in milliseconds.
+ */
+typedef void (*ndn_strategy_on_nack)(struct ndn_forwarder* forwarder, ndn_face_intf_t* face,
+                                     const ndn_name_view_t* name,
+                                     const uint8_t* raw_interest, uint32_t size,
+                                     ndn_pit_entry_t* pit_entry, const ndn_fib_entry_t* fib_entry,
+                                     uint8_t reason, uint64_t now);
+
+/**
+ * Forwarding strategy.
+ * A strategy is a constant table of triggers, usually defined statically.
+ */
+typedef struct ndn_strategy {
+  /**
+   * Required. Forward an Interest.
+   */
+  ndn_strategy_after_receive_interest after_receive_interest;
+  /**
+   * Optional. Observe a Data satisfying a PIT entry.
+   */
+  ndn_strategy_after_receive_data after_receive_data;
+  /**
+   * Optional. Observe a PIT entry expiring.
+   */
+  ndn_strategy_on_timeout on_timeout;
+  /**
+   * Optional. React to a Nack.
+   */
+  ndn_strategy_on_nack on_nack;
+} ndn_strategy_t;
+
+/**
+ * Best-route strategy.
+ * Send to the cheapest next-hop which is up, falling back to the next one when sending fails.
+ * A retransmission prefers the next-hops not tried yet, and so does a Nack. This is the default strategy.
+ */
+extern const ndn_strategy_t ndn_strategy_best_route;
+
+/**
+ * Multicast strategy.
+ * Send to all next-hops which are up.
+ */
+extern const ndn_strategy_t ndn_strategy_multicast;
+
+/*@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FORWARDER_STRATEGY_H_
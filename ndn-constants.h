@@ -14,6 +14,7 @@
 #define NDN_NAME_COMPONENT_BLOCK_SIZE 38
 #define NDN_NAME_COMPONENTS_SIZE 10
 #define NDN_NAME_MAX_BLOCK_SIZE 384
+#define NDN_NAME_VIEW_COMPONENTS_SIZE 32 // max components of a name read in place by the forwarder
 #define NDN_FWD_INVALID_NAME_SIZE ((uint32_t)(-1))
 #define NDN_FWD_INVALID_NAME_COMPONENT_SIZE ((uint32_t)(-1))
 
@@ -23,6 +24,7 @@
 
 // interest
 #define NDN_INTEREST_PARAMS_BUFFER_SIZE 248
+#define NDN_INTEREST_DELEGATIONS_SIZE 2
 #define NDN_SIGNED_INTEREST_BE_SIGNED_MAX_SIZE 680
 #define NDN_DEFAULT_INTEREST_LIFETIME 4000
 
@@ -34,13 +36,39 @@
 
 // forwarder
 #define NDN_FIB_MAX_SIZE 20
+#define NDN_FIB_MAX_NEXTHOPS 3
 #define NDN_PIT_MAX_SIZE 32
+#define NDN_PIT_TIMER_TICK 64
+#define NDN_STRATEGY_CHOICE_MAX_SIZE 4
 #define NDN_CS_MAX_SIZE 10
+#define NDN_CS_BYTE_BUDGET 4096
+#define NDN_CS_CHUNK_SIZE 64
+#define NDN_CS_MAX_DATA_SIZE 1024
+#define NDN_CS_PREFIX_DEPTH 2 // a CanBePrefix Interest finds Data up to this many components longer
+#define NDN_DNL_LIFETIME 6000
+#define NDN_DNL_EXPECTED_RATE 100 // Interests per second leaving the PIT
+// each of the two Dead Nonce List filters takes the (Name, Nonce) pairs of half a lifetime;
+// 32 bits per pair with 3 hashes keep a filter under 0.1% false positives (8 bits: 3%)
+#define NDN_DNL_FILTER_BITS (NDN_DNL_EXPECTED_RATE * NDN_DNL_LIFETIME / 2000 * 32)
+#define NDN_FWD_RETX_SUPPRESSION_INTERVAL 500
+#define NDN_LP_NACK_BUFFER_SIZE 800
+#define NDN_FWD_BURST_SIZE 8
+#define NDN_FWD_TX_QUEUE_SIZE 16
+#define NDN_FWD_MAX_SHARDS 1 // raise for a multi-core gateway, one per forwarding thread
+#define NDN_FWD_NAME_BYTES_PER_ENTRY 64 // packed name memory reserved per PIT, CS, FIB entry
+#define NDN_FWD_APP_NAME_BUFFER_SIZE 1024 // max packed name handed to an application face
+#define NDN_FWD_INTEREST_BUFFER_SIZE 800 // max Interest whose HopLimit is patched in a copy
 #define NDN_FACE_TABLE_MAX_SIZE 10
 #define NDN_FACE_DEFAULT_COST 1
 #define NDN_AES_BLOCK_SIZE 16
 #define NDN_MAX_FACE_PER_PIT_ENTRY 3
 
+// trace
+#ifndef NDN_TRACE_LEVEL
+#define NDN_TRACE_LEVEL 0 // 0: compiled out, 1: errors, 2: info, 3: debug
+#endif
+#define NDN_TRACE_RING_SIZE 1024 // must be a power of 2
+
 // fragmentation support
 #define NDN_FRAG_HDR_LEN 3 // Size of the NDN L2 fragmentation header
 #define NDN_FRAG_HB_MASK 0x80 // 1000 0000
@@ -48,6 +76,20 @@
 #define NDN_FRAG_SEQ_MASK 0x1F // 0001 1111
 #define NDN_FRAG_MAX_SEQ_NUM 30
 #define NDN_FRAG_BUFFER_MAX 512
+#define NDN_REASSEMBLY_MAX_SIZE 2 // packets reassembled at the same time
+#define NDN_REASSEMBLY_BUFFER_SIZE 1024 // max reassembled packet
+#define NDN_REASSEMBLY_MAX_FRAGS 128
+#define NDN_REASSEMBLY_TIMEOUT 500 // ms without a fragment before a packet is dropped
+#define NDN_FEC_MAX_PARITY 8 // parity fragments per packet
+#define NDN_REASSEMBLY_PARITY_SIZE (NDN_FEC_MAX_PARITY * 128) // bytes kept after a packet for its parity fragments
+#define NDN_LP_AGGREGATION_DELAY 200 // us a packet waits for others to share its frame
+#define NDN_LP_RELIABILITY_RTO_INITIAL 500 // ms before the first RTT measurement
+#define NDN_LP_RELIABILITY_RTO_MIN 20 // ms
+#define NDN_LP_RELIABILITY_RTO_MAX 4000 // ms
+#define NDN_LP_RELIABILITY_MAX_RETX 3
+#define NDN_LP_RELIABILITY_LOSS_THRESHOLD 3 // later LpPackets acknowledged before one is deemed lost
+#define NDN_LP_RELIABILITY_ACK_DELAY 5 // ms an Ack waits for an LpPacket to carry it
+#define NDN_LP_RELIABILITY_MAX_ACKS 16 // acks waiting to be sent
 
 // access control
 #define NDN_APPSUPPORT_AC_EDK_SIZE 16
@@ -85,6 +85,7 @@
 #define NDN_FRAG_OUT_OF_ORDER -41
 #define NDN_FRAG_NO_MEM -42
 #define NDN_FRAG_WRONG_IDENTIFIER -43
+#define NDN_FRAG_MALFORMED -44
 /* @} */
 
 /** @defgroup NDNErrorCodeForwarder Forwarder Errors
@@ -96,12 +97,18 @@
 #define NDN_FWD_FIB_FULL -53
 #define NDN_FWD_INTEREST_REJECTED -54
 #define NDN_FWD_NO_MATCHED_CALLBACK -55
+#define NDN_FWD_DUPLICATE_NONCE -56
+#define NDN_FWD_STRATEGY_CHOICE_FULL -57
+#define NDN_FWD_INVALID_SHARD -58
+#define NDN_FWD_FACE_TABLE_FULL -59
+#define NDN_FWD_HOP_LIMIT_EXCEEDED -63
 /* @} */
 
 /** @defgroup NDNErrorCodeFace Face Errors
  * @ingroup NDNErrorCode
  * @{ */
 #define NDN_FWD_APP_FACE_CB_TABLE_FULL -60
+#define NDN_FWD_FACE_RING_FULL -64
 /* @} */
 
 /** @defgroup NDNErrorCodeSD Service Discovery Errors
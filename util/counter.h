@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2019 Xinyu Ma
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#ifndef UTIL_COUNTER_H_
+#define UTIL_COUNTER_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup NDNUtilCounter Counter
+ * @ingroup NDNUtil
+ *
+ * Statistics counters updated by forwarding threads and read from any thread.
+ * Counters are relaxed atomics: an update never tears, but orders nothing else.
+ * @{
+ */
+
+/**
+ * A statistics counter.
+ * It is 64-bit wide where the CPU updates 64-bit values atomically, 32-bit wide otherwise.
+ */
+#if defined(__GCC_ATOMIC_LLONG_LOCK_FREE) && __GCC_ATOMIC_LLONG_LOCK_FREE == 2
+typedef uint64_t ndn_counter_t;
+#else
+typedef uint32_t ndn_counter_t;
+#endif
+
+/**
+ * Add to a counter which several threads may update.
+ * @param counter Input/Output. The counter.
+ * @param n Input. The value to add.
+ */
+static inline void
+ndn_counter_add(ndn_counter_t* counter, uint32_t n)
+{
+  __atomic_fetch_add(counter, (ndn_counter_t)n, __ATOMIC_RELAXED);
+}
+
+/**
+ * Add to a counter which only the calling thread updates.
+ * This saves the locked instruction of ndn_counter_add() while the readers still never
+ * see a torn value.
+ * @param counter Input/Output. The counter.
+ * @param n Input. The value to add.
+ */
+static inline void
+ndn_counter_add_local(ndn_counter_t* counter, uint32_t n)
+{
+  __atomic_store_n(counter, __atomic_load_n(counter, __ATOMIC_RELAXED) + n, __ATOMIC_RELAXED);
+}
+
+/**
+ * Read a counter.
+ * @param counter Input. The counter.
+ * @return The value of the counter.
+ */
+static inline ndn_counter_t
+ndn_counter_read(const ndn_counter_t* counter)
+{
+  return __atomic_load_n(counter, __ATOMIC_RELAXED);
+}
+
+/*@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UTIL_COUNTER_H_
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2019 Xinyu Ma, Zhiyi Zhang
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include "hash-index.h"
+
+void
+ndn_hash_index_init(ndn_hash_index_t* index, void* memory, uint32_t capacity)
+{
+  // keep the load factor <= 0.5
+  uint32_t slot_count = 2;
+  while (slot_count < 2 * capacity) {
+    slot_count <<= 1;
+  }
+  index->slots = (ndn_hash_index_slot_t*)memory;
+  index->mask = slot_count - 1;
+  index->size = 0;
+  for (uint32_t i = 0; i < slot_count; i++) {
+    index->slots[i].value = NDN_HASH_INDEX_EMPTY;
+  }
+}
+
+uint32_t
+ndn_hash_index_insert(ndn_hash_index_t* index, uint32_t hash, uint32_t value)
+{
+  uint32_t pos = hash & index->mask;
+  while (index->slots[pos].value != NDN_HASH_INDEX_EMPTY) {
+    pos = (pos + 1) & index->mask;
+  }
+  index->slots[pos].hash = hash;
+  index->slots[pos].value = value;
+  index->size++;
+  return pos;
+}
+
+void
+ndn_hash_index_erase(ndn_hash_index_t* index, uint32_t pos)
+{
+  uint32_t hole = pos;
+  uint32_t cur = pos;
+  for (;;) {
+    cur = (cur + 1) & index->mask;
+    if (index->slots[cur].value == NDN_HASH_INDEX_EMPTY) {
+      break;
+    }
+    // the slot at cur may fill the hole only if its home is not in (hole, cur]
+    uint32_t home = index->slots[cur].hash & index->mask;
+    if (hole <= cur) {
+      if (hole < home && home <= cur)
+        continue;
+    }
+    else {
+      if (hole < home || home <= cur)
+        continue;
+    }
+    index->slots[hole] = index->slots[cur];
+    hole = cur;
+  }
+  index->slots[hole].value = NDN_HASH_INDEX_EMPTY;
+  index->size--;
+}
+
+int
+ndn_hash_index_remove(ndn_hash_index_t* index, uint32_t hash, uint32_t value)
+{
+  uint32_t pos = ndn_hash_index_home(index, hash);
+  uint32_t candidate;
+  while ((candidate = ndn_hash_index_probe(index, hash, &pos)) != NDN_HASH_INDEX_EMPTY) {
+    if (candidate == value) {
+      ndn_hash_index_erase(index, pos);
+      return 0;
+    }
+    pos = (pos + 1) & index->mask;
+  }
+  return -1;
+}
@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2019 Xinyu Ma, Zhiyi Zhang
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#ifndef UTIL_HASH_INDEX_H_
+#define UTIL_HASH_INDEX_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**@defgroup NDNUtil
+ */
+
+/** @defgroup NDNUtilHashIndex Hash Index
+ * @ingroup NDNUtil
+ *
+ * Open-addressing hash index mapping precomputed 32-bit hashes to 32-bit values
+ * (usually indexes into a caller-owned entry array).
+ * Linear probing is used, and deletion shifts the following slots backward so that
+ * no tombstone is ever left behind.
+ * Keys are not stored: the caller must compare the candidate entries by itself.
+ * @{
+ */
+
+/** The value marking an empty slot.
+ */
+#define NDN_HASH_INDEX_EMPTY ((uint32_t)(-1))
+
+/**
+ * One slot of the hash index.
+ */
+typedef struct ndn_hash_index_slot {
+  /**
+   * The full hash of the key stored in this slot.
+   */
+  uint32_t hash;
+  /**
+   * The value. NDN_HASH_INDEX_EMPTY indicates an empty slot.
+   */
+  uint32_t value;
+} ndn_hash_index_slot_t;
+
+/**
+ * Hash index class.
+ */
+typedef struct ndn_hash_index {
+  /**
+   * The slot array. The number of slots is a power of 2.
+   */
+  ndn_hash_index_slot_t* slots;
+  /**
+   * The number of slots minus 1.
+   */
+  uint32_t mask;
+  /**
+   * The number of occupied slots.
+   */
+  uint32_t size;
+} ndn_hash_index_t;
+
+/**
+ * The required memory to initialize a hash index holding up to @c capacity values.
+ * The index keeps its load factor at or below 0.5, and the slot count is rounded up
+ * to a power of 2, so <tt> 4 * capacity </tt> slots are always enough.
+ * @param capacity Input. The max number of values.
+ */
+#define NDN_HASH_INDEX_RESERVE_SIZE(capacity) \
+    (sizeof(ndn_hash_index_slot_t) * 4 * ((capacity) > 0 ? (capacity) : 1))
+
+/**
+ * Initialize a hash index.
+ * @pre NDN_HASH_INDEX_RESERVE_SIZE(capacity) bytes needed.
+ * @param index Output. The hash index to be inited.
+ * @param memory Input. The memory used to keep the slots.
+ * @param capacity Input. The max number of values.
+ */
+void
+ndn_hash_index_init(ndn_hash_index_t* index, void* memory, uint32_t capacity);
+
+/**
+ * Find the first slot at or after @c pos (in probe order) whose hash equals @c hash.
+ * Start a lookup with <tt> pos = hash & index->mask </tt>, and continue it with
+ * <tt> pos = (pos + 1) & index->mask </tt> when the returned candidate does not match.
+ * @param index Input. The hash index.
+ * @param hash Input. The hash to search.
+ * @param pos Input/Output. The slot to start from. Set to the slot of the candidate found.
+ * @return The value of the candidate. NDN_HASH_INDEX_EMPTY if no more candidates.
+ */
+static inline uint32_t
+ndn_hash_index_probe(const ndn_hash_index_t* index, uint32_t hash, uint32_t* pos)
+{
+  uint32_t i = *pos;
+  while (index->slots[i].value != NDN_HASH_INDEX_EMPTY) {
+    if (index->slots[i].hash == hash) {
+      *pos = i;
+      return index->slots[i].value;
+    }
+    i = (i + 1) & index->mask;
+  }
+  *pos = i;
+  return NDN_HASH_INDEX_EMPTY;
+}
+
+/**
+ * Get the home slot of a hash, i.e. where ndn_hash_index_probe() should start.
+ * @param index Input. The hash index.
+ * @param hash Input. The hash.
+ */
+static inline uint32_t
+ndn_hash_index_home(const ndn_hash_index_t* index, uint32_t hash)
+{
+  return hash & index->mask;
+}
+
+/**
+ * Hint the CPU to load the home slot of a hash into cache ahead of a lookup.
+ * @param index Input. The hash index.
+ * @param hash Input. The hash.
+ */
+static inline void
+ndn_hash_index_prefetch(const ndn_hash_index_t* index, uint32_t hash)
+{
+#if defined(__GNUC__)
+  __builtin_prefetch(&index->slots[hash & index->mask]);
+#else
+  (void)index;
+  (void)hash;
+#endif
+}
+
+/**
+ * Insert a value. Duplicated hashes are allowed.
+ * @param index Input/Output. The hash index.
+ * @param hash Input. The hash of the key.
+ * @param value Input. The value. Must not be NDN_HASH_INDEX_EMPTY.
+ * @return The slot position of the inserted value.
+ */
+uint32_t
+ndn_hash_index_insert(ndn_hash_index_t* index, uint32_t hash, uint32_t value);
+
+/**
+ * Erase the value at a slot position obtained from ndn_hash_index_probe().
+ * Following slots are shifted backward to fill the hole.
+ * @param index Input/Output. The hash index.
+ * @param pos Input. The slot position to erase.
+ */
+void
+ndn_hash_index_erase(ndn_hash_index_t* index, uint32_t pos);
+
+/**
+ * Find and erase the slot holding @c value with @c hash.
+ * @param index Input/Output. The hash index.
+ * @param hash Input. The hash of the key.
+ * @param value Input. The value to erase.
+ * @return 0 if the value is erased. -1 if not found.
+ */
+int
+ndn_hash_index_remove(ndn_hash_index_t* index, uint32_t hash, uint32_t value);
+
+/*@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UTIL_HASH_INDEX_H_
@@ -19,8 +19,14 @@ static ndn_alarm_api_t api = {
 
 static ndn_timer_scheduler_t scheduler;
 
+uint64_t
+ndn_timer_get_now(void)
+{
+  return api.alarm_get_now();
+}
+
 void
-ndn_timer_start(ndn_timer_t* timer, uint32_t start, uint32_t expire)
+ndn_timer_start(ndn_timer_t* timer, uint64_t start, uint32_t expire)
 {
   timer->fire_time = start + expire;
   ndn_timer_scheduler_add(&scheduler, timer);
@@ -33,7 +39,7 @@ ndn_timer_stop(ndn_timer_t* timer)
 }
 
 bool
-ndn_timer_fire_before(ndn_timer_t* lhs, ndn_timer_t* rhs, uint32_t now)
+ndn_timer_fire_before(ndn_timer_t* lhs, ndn_timer_t* rhs, uint64_t now)
 {
   bool retval;
   bool lhs_is_before_now = lhs->fire_time < now ? true : false;
@@ -141,7 +147,7 @@ ndn_timer_scheduler_set_alarm(ndn_timer_scheduler_t* scheduler)
     api.alarm_stop();
   }
   else{
-    uint32_t now = api.alarm_get_now();
+    uint64_t now = api.alarm_get_now();
     uint32_t remaining = now < scheduler->head->fire_time?
                          (scheduler->head->fire_time - now) : 0;
     api.alarm_start(now, remaining);
@@ -10,6 +10,7 @@
 #define NDN_LITE_TIMER_H
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -62,7 +63,7 @@ typedef struct ndn_alarm_api {
   /**
    * Alarm get current time API.
    */
-  uint32_t (*alarm_get_now)(void);
+  uint64_t (*alarm_get_now)(void);
 } ndn_alarm_api_t;
 
 /**
@@ -138,6 +139,13 @@ ndn_timer_stop(ndn_timer_t* timer);
 void
 ndn_timer_start(ndn_timer_t* timer, uint64_t start, uint32_t delta);
 
+/**
+ * This method will get the current time (in millisecond) of the timer scheduler.
+ * @return Current time
+ */
+uint64_t
+ndn_timer_get_now(void);
+
 /**
  * This method will start a timer from now.
  * @param timer. Input. Timer to start.
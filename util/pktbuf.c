@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2019 Xinyu Ma
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include "pktbuf.h"
+#include "../ndn-error-code.h"
+
+#define PKTBUF_NIL ((uint32_t)-1)
+
+static inline ndn_pktbuf_t*
+pktbuf_at(const ndn_pktbuf_pool_t* pool, uint32_t i)
+{
+  return (ndn_pktbuf_t*)(pool->buffers + (size_t)i * pool->stride);
+}
+
+// Push a buffer onto the free stack
+static void
+pktbuf_push_free(ndn_pktbuf_pool_t* pool, ndn_pktbuf_t* buf)
+{
+  uint32_t i = (uint32_t)(((uint8_t*)buf - pool->buffers) / pool->stride);
+  uint64_t top = __atomic_load_n(&pool->free_top, __ATOMIC_RELAXED);
+  uint64_t new_top = 0;
+  do {
+    __atomic_store_n(&buf->next_free, (uint32_t)top, __ATOMIC_RELAXED);
+    new_top = (top & 0xFFFFFFFF00000000ull) | i;
+  } while (!__atomic_compare_exchange_n(&pool->free_top, &top, new_top, true,
+                                        __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+int
+ndn_pktbuf_pool_init(ndn_pktbuf_pool_t* pool, void* memory, uint32_t count,
+                     uint32_t room_size, uint32_t headroom)
+{
+  if (headroom > room_size) {
+    return NDN_OVERSIZE;
+  }
+  pool->buffers = (uint8_t*)memory;
+  pool->stride = (uint32_t)NDN_PKTBUF_STRIDE(room_size);
+  pool->room_size = room_size;
+  pool->headroom = headroom;
+  pool->count = count;
+  pool->free_top = PKTBUF_NIL;
+  for (uint32_t i = count; i > 0; i--) {
+    ndn_pktbuf_t* buf = pktbuf_at(pool, i - 1);
+    buf->pool = pool;
+    buf->refcount = 0;
+    buf->next_free = (uint32_t)pool->free_top;
+    pool->free_top = i - 1;
+  }
+  return 0;
+}
+
+ndn_pktbuf_t*
+ndn_pktbuf_alloc(ndn_pktbuf_pool_t* pool)
+{
+  ndn_pktbuf_t* buf = NULL;
+  uint64_t top = __atomic_load_n(&pool->free_top, __ATOMIC_ACQUIRE);
+  uint64_t new_top = 0;
+  do {
+    if ((uint32_t)top == PKTBUF_NIL) {
+      return NULL;
+    }
+    buf = pktbuf_at(pool, (uint32_t)top);
+    // the tag fails the exchange if buf has been taken and returned meanwhile
+    new_top = (((top >> 32) + 1) << 32) | __atomic_load_n(&buf->next_free, __ATOMIC_RELAXED);
+  } while (!__atomic_compare_exchange_n(&pool->free_top, &top, new_top, true,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE));
+  buf->data = buf->room + pool->headroom;
+  buf->size = 0;
+  __atomic_store_n(&buf->refcount, 1, __ATOMIC_RELAXED);
+  return buf;
+}
+
+void
+ndn_pktbuf_unref(ndn_pktbuf_t* buf)
+{
+  if (__atomic_sub_fetch(&buf->refcount, 1, __ATOMIC_ACQ_REL) == 0) {
+    pktbuf_push_free(buf->pool, buf);
+  }
+}
+
+int
+ndn_pktbuf_narrow(ndn_pktbuf_t* buf, uint32_t offset, uint32_t size)
+{
+  if (offset > buf->size || size > buf->size - offset) {
+    return NDN_OVERSIZE;
+  }
+  buf->data += offset;
+  buf->size = size;
+  return 0;
+}
@@ -0,0 +1,227 @@
+/*
+ * Copyright (C) 2019 Xinyu Ma
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#ifndef UTIL_PKTBUF_H_
+#define UTIL_PKTBUF_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup NDNUtilPktbuf Packet Buffer
+ * @ingroup NDNUtil
+ *
+ * Reference-counted packet buffers taken from a fixed pool.
+ * A buffer keeps one packet with free room before it (headroom) and after it (tailroom),
+ * so that link and fragmentation headers can be added in place. A received buffer can be
+ * held by several output queues and the Content Store at once: each holder takes a
+ * reference, and the buffer returns to its pool when the last one is released.
+ * A buffer with more than one reference is shared and must be treated as read-only.
+ * Buffers can be allocated, referenced and released from any thread.
+ * @{
+ */
+
+struct ndn_pktbuf_pool;
+
+/**
+ * Packet buffer class.
+ */
+typedef struct ndn_pktbuf {
+  /**
+   * The pool the buffer belongs to.
+   */
+  struct ndn_pktbuf_pool* pool;
+  /**
+   * The first byte of the packet.
+   */
+  uint8_t* data;
+  /**
+   * The size of the packet.
+   */
+  uint32_t size;
+  /**
+   * The number of references.
+   */
+  uint32_t refcount;
+  /**
+   * The next free buffer in the pool.
+   */
+  uint32_t next_free;
+  /**
+   * The room keeping the packet and its headroom and tailroom.
+   */
+  uint8_t room[] __attribute__((aligned(8)));
+} ndn_pktbuf_t;
+
+/**
+ * Packet buffer pool class.
+ */
+typedef struct ndn_pktbuf_pool {
+  /**
+   * The buffer memory.
+   */
+  uint8_t* buffers;
+  /**
+   * The distance between two buffers in bytes.
+   */
+  uint32_t stride;
+  /**
+   * The size of the room of a buffer.
+   */
+  uint32_t room_size;
+  /**
+   * The headroom of a newly allocated buffer.
+   */
+  uint32_t headroom;
+  /**
+   * The number of buffers.
+   */
+  uint32_t count;
+  /**
+   * The top of the free buffer stack in the low 32 bits, and a tag bumped on every pop
+   * in the high 32 bits, so that a concurrent pop and push never get mixed up.
+   */
+  uint64_t free_top;
+} ndn_pktbuf_pool_t;
+
+/**
+ * The distance between two buffers of a pool.
+ * @param room_size Input. The size of the room of a buffer, including the headroom.
+ */
+#define NDN_PKTBUF_STRIDE(room_size) \
+    ((sizeof(ndn_pktbuf_t) + (room_size) + 7) & ~(size_t)7)
+
+/**
+ * The required memory to initialize a packet buffer pool.
+ * @param count Input. The number of buffers.
+ * @param room_size Input. The size of the room of a buffer, including the headroom.
+ */
+#define NDN_PKTBUF_POOL_RESERVE_SIZE(count, room_size) \
+    (NDN_PKTBUF_STRIDE(room_size) * (count))
+
+/**
+ * Initialize a packet buffer pool.
+ * @pre NDN_PKTBUF_POOL_RESERVE_SIZE(count, room_size) bytes needed, aligned to 8 bytes.
+ * @param pool Output. The pool.
+ * @param memory Input. The memory used to keep the buffers.
+ * @param count Input. The number of buffers.
+ * @param room_size Input. The size of the room of a buffer, including the headroom.
+ * @param headroom Input. The free room before the packet in a newly allocated buffer.
+ * @return 0 if there is no error. NDN_OVERSIZE if @c headroom exceeds @c room_size.
+ */
+int
+ndn_pktbuf_pool_init(ndn_pktbuf_pool_t* pool, void* memory, uint32_t count,
+                     uint32_t room_size, uint32_t headroom);
+
+/**
+ * Take an empty buffer from a pool, with one reference held by the caller.
+ * @param pool Input/Output. The pool.
+ * @return The buffer. NULL if the pool is exhausted.
+ */
+ndn_pktbuf_t*
+ndn_pktbuf_alloc(ndn_pktbuf_pool_t* pool);
+
+/**
+ * Take one more reference to a buffer.
+ * @param buf Input/Output. The buffer.
+ */
+static inline void
+ndn_pktbuf_ref(ndn_pktbuf_t* buf)
+{
+  __atomic_fetch_add(&buf->refcount, 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * Release a reference to a buffer. The buffer returns to its pool with the last reference.
+ * @param buf Input/Output. The buffer.
+ */
+void
+ndn_pktbuf_unref(ndn_pktbuf_t* buf);
+
+/**
+ * Whether a buffer is held by more than one holder, so that it must not be modified.
+ * @param buf Input. The buffer.
+ */
+static inline bool
+ndn_pktbuf_is_shared(const ndn_pktbuf_t* buf)
+{
+  return __atomic_load_n(&buf->refcount, __ATOMIC_ACQUIRE) > 1;
+}
+
+/**
+ * Get the free room before the packet.
+ * @param buf Input. The buffer.
+ */
+static inline uint32_t
+ndn_pktbuf_headroom(const ndn_pktbuf_t* buf)
+{
+  return (uint32_t)(buf->data - buf->room);
+}
+
+/**
+ * Get the free room after the packet.
+ * @param buf Input. The buffer.
+ */
+static inline uint32_t
+ndn_pktbuf_tailroom(const ndn_pktbuf_t* buf)
+{
+  return buf->pool->room_size - ndn_pktbuf_headroom(buf) - buf->size;
+}
+
+/**
+ * Grow the packet at its beginning, e.g. to add a header.
+ * @param buf Input/Output. The buffer, not shared.
+ * @param len Input. The number of bytes to add.
+ * @return The new beginning of the packet. NULL if the headroom is too small.
+ */
+static inline uint8_t*
+ndn_pktbuf_prepend(ndn_pktbuf_t* buf, uint32_t len)
+{
+  if (len > ndn_pktbuf_headroom(buf))
+    return NULL;
+  buf->data -= len;
+  buf->size += len;
+  return buf->data;
+}
+
+/**
+ * Grow the packet at its end, e.g. to receive it or add a trailer.
+ * @param buf Input/Output. The buffer, not shared.
+ * @param len Input. The number of bytes to add.
+ * @return The first byte added. NULL if the tailroom is too small.
+ */
+static inline uint8_t*
+ndn_pktbuf_append(ndn_pktbuf_t* buf, uint32_t len)
+{
+  if (len > ndn_pktbuf_tailroom(buf))
+    return NULL;
+  buf->size += len;
+  return buf->data + buf->size - len;
+}
+
+/**
+ * Narrow the packet to a part of it, e.g. to strip a header and a trailer.
+ * @param buf Input/Output. The buffer, not shared.
+ * @param offset Input. The number of bytes to remove from the beginning.
+ * @param size Input. The size of the remaining packet.
+ * @return 0 if there is no error. NDN_OVERSIZE if the part is out of the packet.
+ */
+int
+ndn_pktbuf_narrow(ndn_pktbuf_t* buf, uint32_t offset, uint32_t size);
+
+/*@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UTIL_PKTBUF_H_
@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2019 Xinyu Ma
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include "ring.h"
+#include "../ndn-error-code.h"
+#include <string.h>
+
+// Copy n elements into the ring from position pos, wrapping at the end of the array
+static inline void
+ring_copy_in(ndn_ring_t* ring, uint32_t pos, const uint8_t* src, uint32_t n)
+{
+  uint32_t index = pos & (ring->capacity - 1);
+  uint32_t first = ring->capacity - index;
+  if (first > n)
+    first = n;
+  memcpy(ring->elements + (size_t)index * ring->element_size, src, (size_t)first * ring->element_size);
+  if (first < n) {
+    memcpy(ring->elements, src + (size_t)first * ring->element_size,
+           (size_t)(n - first) * ring->element_size);
+  }
+}
+
+// Copy n elements out of the ring from position pos, wrapping at the end of the array
+static inline void
+ring_copy_out(const ndn_ring_t* ring, uint32_t pos, uint8_t* dst, uint32_t n)
+{
+  uint32_t index = pos & (ring->capacity - 1);
+  uint32_t first = ring->capacity - index;
+  if (first > n)
+    first = n;
+  memcpy(dst, ring->elements + (size_t)index * ring->element_size, (size_t)first * ring->element_size);
+  if (first < n) {
+    memcpy(dst + (size_t)first * ring->element_size, ring->elements,
+           (size_t)(n - first) * ring->element_size);
+  }
+}
+
+int
+ndn_ring_init(ndn_ring_t* ring, void* memory, uint32_t capacity, uint32_t element_size,
+              bool multi_producer)
+{
+  if (capacity == 0 || (capacity & (capacity - 1)) != 0 || element_size == 0) {
+    return NDN_OVERSIZE;
+  }
+  ring->elements = (uint8_t*)memory;
+  ring->capacity = capacity;
+  ring->element_size = element_size;
+  ring->multi_producer = multi_producer;
+  atomic_init(&ring->prod_head, 0);
+  atomic_init(&ring->prod_tail, 0);
+  atomic_init(&ring->cons_tail, 0);
+  return 0;
+}
+
+// Reserve up to count slots, only contiguous ones if asked
+static uint32_t
+ring_reserve(ndn_ring_t* ring, uint32_t count, bool contiguous, uint32_t* pos)
+{
+  uint32_t head = atomic_load_explicit(&ring->prod_head, memory_order_relaxed);
+  uint32_t n = 0;
+  do {
+    uint32_t cons_tail = atomic_load_explicit(&ring->cons_tail, memory_order_acquire);
+    n = ring->capacity - (head - cons_tail);
+    if (contiguous && n > ring->capacity - (head & (ring->capacity - 1)))
+      n = ring->capacity - (head & (ring->capacity - 1));
+    if (n > count)
+      n = count;
+    if (n == 0) {
+      return 0;
+    }
+    if (!ring->multi_producer) {
+      atomic_store_explicit(&ring->prod_head, head + n, memory_order_relaxed);
+      break;
+    }
+  } while (!atomic_compare_exchange_weak_explicit(&ring->prod_head, &head, head + n,
+                                                  memory_order_relaxed, memory_order_relaxed));
+  *pos = head;
+  return n;
+}
+
+void
+ndn_ring_enqueue_commit(ndn_ring_t* ring, uint32_t pos, uint32_t count)
+{
+  // Publish in reservation order: wait for the producers which reserved earlier
+  if (ring->multi_producer) {
+    while (atomic_load_explicit(&ring->prod_tail, memory_order_acquire) != pos) {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+      __builtin_ia32_pause();
+#endif
+    }
+  }
+  atomic_store_explicit(&ring->prod_tail, pos + count, memory_order_release);
+}
+
+uint32_t
+ndn_ring_enqueue_reserve(ndn_ring_t* ring, void** first, uint32_t* pos, uint32_t count)
+{
+  uint32_t n = ring_reserve(ring, count, true, pos);
+  *first = ring->elements + (size_t)(*pos & (ring->capacity - 1)) * ring->element_size;
+  return n;
+}
+
+uint32_t
+ndn_ring_enqueue_burst(ndn_ring_t* ring, const void* elements, uint32_t count)
+{
+  uint32_t pos = 0;
+  uint32_t n = ring_reserve(ring, count, false, &pos);
+  if (n == 0) {
+    return 0;
+  }
+  ring_copy_in(ring, pos, (const uint8_t*)elements, n);
+  ndn_ring_enqueue_commit(ring, pos, n);
+  return n;
+}
+
+uint32_t
+ndn_ring_peek_burst(ndn_ring_t* ring, void** first, uint32_t count)
+{
+  uint32_t cons_tail = atomic_load_explicit(&ring->cons_tail, memory_order_relaxed);
+  uint32_t ready = atomic_load_explicit(&ring->prod_tail, memory_order_acquire) - cons_tail;
+  uint32_t index = cons_tail & (ring->capacity - 1);
+  if (ready > ring->capacity - index)
+    ready = ring->capacity - index;
+  if (ready > count)
+    ready = count;
+  *first = ring->elements + (size_t)index * ring->element_size;
+  return ready;
+}
+
+uint32_t
+ndn_ring_dequeue_burst(ndn_ring_t* ring, void* elements, uint32_t count)
+{
+  uint32_t cons_tail = atomic_load_explicit(&ring->cons_tail, memory_order_relaxed);
+  uint32_t n = atomic_load_explicit(&ring->prod_tail, memory_order_acquire) - cons_tail;
+  if (n > count)
+    n = count;
+  if (n == 0) {
+    return 0;
+  }
+  ring_copy_out(ring, cons_tail, (uint8_t*)elements, n);
+  atomic_store_explicit(&ring->cons_tail, cons_tail + n, memory_order_release);
+  return n;
+}
@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2019 Xinyu Ma
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#ifndef UTIL_RING_H_
+#define UTIL_RING_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup NDNUtilRing Ring
+ * @ingroup NDNUtil
+ *
+ * Lock-free bounded ring of fixed-size elements, passing packet descriptors between threads.
+ * A ring has one consumer and either one producer (SPSC) or any number of producers (MPSC).
+ * Elements are copied in on enqueue, and can be read in place by the consumer.
+ * The producer and consumer indexes sit on separate cache lines, so that the two sides
+ * do not invalidate each other's cache on every operation.
+ * @{
+ */
+
+/** The assumed size of a CPU cache line.
+ */
+#define NDN_RING_CACHE_LINE_SIZE 64
+
+/**
+ * Ring class.
+ */
+typedef struct ndn_ring {
+  /**
+   * The element array.
+   */
+  uint8_t* elements;
+  /**
+   * The max number of elements, a power of 2.
+   */
+  uint32_t capacity;
+  /**
+   * The size of an element in bytes.
+   */
+  uint32_t element_size;
+  /**
+   * True if more than one thread may enqueue.
+   */
+  bool multi_producer;
+  /**
+   * The index reserved by the latest enqueue in progress.
+   * The indexes run freely and are masked on access, so the ring uses all its slots.
+   */
+  _Atomic uint32_t prod_head __attribute__((aligned(NDN_RING_CACHE_LINE_SIZE)));
+  /**
+   * The index up to which enqueues have completed.
+   */
+  _Atomic uint32_t prod_tail;
+  /**
+   * The index up to which dequeues have completed.
+   */
+  _Atomic uint32_t cons_tail __attribute__((aligned(NDN_RING_CACHE_LINE_SIZE)));
+} __attribute__((aligned(NDN_RING_CACHE_LINE_SIZE))) ndn_ring_t;
+
+/**
+ * The required memory to initialize a ring.
+ * @param capacity Input. The max number of elements, a power of 2.
+ * @param element_size Input. The size of an element in bytes.
+ */
+#define NDN_RING_RESERVE_SIZE(capacity, element_size) \
+    ((uint32_t)(capacity) * (uint32_t)(element_size))
+
+/**
+ * Initialize a ring. It must not be in use by any thread.
+ * @pre NDN_RING_RESERVE_SIZE(capacity, element_size) bytes needed, aligned to the elements.
+ * @param ring Output. The ring.
+ * @param memory Input. The memory used to keep the elements.
+ * @param capacity Input. The max number of elements, a power of 2.
+ * @param element_size Input. The size of an element in bytes.
+ * @param multi_producer Input. True to allow concurrent enqueues from several threads.
+ * @return 0 if there is no error. NDN_OVERSIZE if @c capacity is not a power of 2.
+ */
+int
+ndn_ring_init(ndn_ring_t* ring, void* memory, uint32_t capacity, uint32_t element_size,
+              bool multi_producer);
+
+/**
+ * Enqueue as many elements of a batch as there is room for.
+ * @param ring Input/Output. The ring.
+ * @param elements Input. The array of @c count elements.
+ * @param count Input. The number of elements.
+ * @return The number of elements enqueued, from the beginning of @c elements.
+ */
+uint32_t
+ndn_ring_enqueue_burst(ndn_ring_t* ring, const void* elements, uint32_t count);
+
+/**
+ * Reserve up to @c count free slots to fill in place, saving a copy of large elements.
+ * The slots are contiguous, so fewer than free may be reserved at the end of the array.
+ * Every reservation must be followed by ndn_ring_enqueue_commit() from the same thread.
+ * @param ring Input/Output. The ring.
+ * @param first Output. The first reserved slot.
+ * @param pos Output. The position of the reservation, to be passed to ndn_ring_enqueue_commit().
+ * @param count Input. The max number of slots.
+ * @return The number of slots reserved from @c first. 0 if the ring is full.
+ */
+uint32_t
+ndn_ring_enqueue_reserve(ndn_ring_t* ring, void** first, uint32_t* pos, uint32_t count);
+
+/**
+ * Publish the slots filled after ndn_ring_enqueue_reserve() to the consumer.
+ * With several producers, this waits for the producers which reserved earlier to commit.
+ * @param ring Input/Output. The ring.
+ * @param pos Input. The position got by ndn_ring_enqueue_reserve().
+ * @param count Input. The number of slots reserved.
+ */
+void
+ndn_ring_enqueue_commit(ndn_ring_t* ring, uint32_t pos, uint32_t count);
+
+/**
+ * Dequeue up to @c count elements. This function is for the consumer thread ONLY.
+ * @param ring Input/Output. The ring.
+ * @param elements Output. The array receiving up to @c count elements.
+ * @param count Input. The max number of elements.
+ * @return The number of elements dequeued.
+ */
+uint32_t
+ndn_ring_dequeue_burst(ndn_ring_t* ring, void* elements, uint32_t count);
+
+/**
+ * Get the elements ready to dequeue, without copying them out.
+ * The elements stay valid until ndn_ring_release() and are contiguous, so fewer than
+ * ready may be returned at the end of the array. This function is for the consumer thread ONLY.
+ * @param ring Input. The ring.
+ * @param first Output. The first element ready.
+ * @param count Input. The max number of elements.
+ * @return The number of contiguous elements from @c first.
+ */
+uint32_t
+ndn_ring_peek_burst(ndn_ring_t* ring, void** first, uint32_t count);
+
+/**
+ * Release the first @c count elements got by ndn_ring_peek_burst() back to the producers.
+ * This function is for the consumer thread ONLY.
+ * @param ring Input/Output. The ring.
+ * @param count Input. The number of elements.
+ */
+static inline void
+ndn_ring_release(ndn_ring_t* ring, uint32_t count)
+{
+  uint32_t tail = atomic_load_explicit(&ring->cons_tail, memory_order_relaxed);
+  atomic_store_explicit(&ring->cons_tail, tail + count, memory_order_release);
+}
+
+/**
+ * Get the number of elements in the ring. The result may be stale when it returns.
+ * @param ring Input. The ring.
+ */
+static inline uint32_t
+ndn_ring_count(ndn_ring_t* ring)
+{
+  return atomic_load_explicit(&ring->prod_tail, memory_order_acquire)
+         - atomic_load_explicit(&ring->cons_tail, memory_order_acquire);
+}
+
+/*@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UTIL_RING_H_
@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2019 Xinyu Ma, Tianyuan Yu
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include "timer-wheel.h"
+
+#define WHEEL_SLOT_OF(wheel, time) \
+  ((uint32_t)((time) / (wheel)->tick) & (NDN_TIMER_WHEEL_SLOTS - 1))
+
+static inline void
+wheel_list_unlink(ndn_timer_wheel_node_t* node)
+{
+  node->prev->next = node->next;
+  node->next->prev = node->prev;
+  node->prev = node->next = node;
+}
+
+static inline void
+wheel_list_append(ndn_timer_wheel_node_t* head, ndn_timer_wheel_node_t* node)
+{
+  node->prev = head->prev;
+  node->next = head;
+  head->prev->next = node;
+  head->prev = node;
+}
+
+static void
+wheel_timer_handler(void* arg)
+{
+  ndn_timer_wheel_t* wheel = (ndn_timer_wheel_t*)arg;
+  ndn_timer_wheel_advance(wheel, ndn_timer_get_now());
+}
+
+void
+ndn_timer_wheel_init(ndn_timer_wheel_t* wheel, uint32_t tick, ndn_timer_wheel_callback on_expire)
+{
+  for (uint32_t i = 0; i < NDN_TIMER_WHEEL_SLOTS; i++) {
+    ndn_timer_wheel_node_init(&wheel->slots[i]);
+  }
+  wheel->last_time = 0;
+  wheel->tick = (tick > 0) ? tick : 1;
+  wheel->count = 0;
+  wheel->on_expire = on_expire;
+  wheel->manual = false;
+  ndn_timer_init(&wheel->timer, wheel_timer_handler, 0, wheel);
+}
+
+void
+ndn_timer_wheel_set_manual(ndn_timer_wheel_t* wheel, bool manual)
+{
+  wheel->manual = manual;
+  if (manual) {
+    ndn_timer_stop(&wheel->timer);
+  }
+  else if (wheel->count > 0) {
+    ndn_timer_start(&wheel->timer, ndn_timer_get_now(), wheel->tick);
+  }
+}
+
+void
+ndn_timer_wheel_schedule(ndn_timer_wheel_t* wheel, ndn_timer_wheel_node_t* node, uint64_t expire_time)
+{
+  if (ndn_timer_wheel_node_is_scheduled(node)) {
+    wheel_list_unlink(node);
+  }
+  else {
+    wheel->count ++;
+  }
+  node->expire_time = expire_time;
+  // a time already passed goes to the slot which is processed next
+  uint64_t slot_time = (expire_time > wheel->last_time) ? expire_time : wheel->last_time;
+  wheel_list_append(&wheel->slots[WHEEL_SLOT_OF(wheel, slot_time)], node);
+
+  if (wheel->last_time == 0) {
+    wheel->last_time = ndn_timer_get_now();
+  }
+  if (!wheel->manual && !ndn_timer_is_running(&wheel->timer)) {
+    ndn_timer_start(&wheel->timer, ndn_timer_get_now(), wheel->tick);
+  }
+}
+
+void
+ndn_timer_wheel_cancel(ndn_timer_wheel_t* wheel, ndn_timer_wheel_node_t* node)
+{
+  if (!ndn_timer_wheel_node_is_scheduled(node)) {
+    return;
+  }
+  wheel_list_unlink(node);
+  wheel->count --;
+  if (wheel->count == 0 && !wheel->manual) {
+    ndn_timer_stop(&wheel->timer);
+  }
+}
+
+void
+ndn_timer_wheel_advance(ndn_timer_wheel_t* wheel, uint64_t now)
+{
+  ndn_timer_wheel_node_t expired;
+  ndn_timer_wheel_node_init(&expired);
+
+  if (now < wheel->last_time) {
+    now = wheel->last_time;
+  }
+  // visit every slot between the last time and now, at most one revolution
+  uint64_t ticks = now / wheel->tick - wheel->last_time / wheel->tick;
+  if (ticks >= NDN_TIMER_WHEEL_SLOTS) {
+    ticks = NDN_TIMER_WHEEL_SLOTS - 1;
+  }
+  uint32_t slot = WHEEL_SLOT_OF(wheel, now);
+  for (uint64_t i = 0; i <= ticks; i++) {
+    ndn_timer_wheel_node_t* head = &wheel->slots[(slot - i) & (NDN_TIMER_WHEEL_SLOTS - 1)];
+    ndn_timer_wheel_node_t* node = head->next;
+    while (node != head) {
+      ndn_timer_wheel_node_t* next = node->next;
+      if (node->expire_time <= now) {
+        wheel_list_unlink(node);
+        wheel_list_append(&expired, node);
+      }
+      node = next;
+    }
+  }
+  wheel->last_time = now;
+
+  // callbacks may cancel or schedule any node, so pop one at a time
+  while (expired.next != &expired) {
+    ndn_timer_wheel_node_t* node = expired.next;
+    wheel_list_unlink(node);
+    wheel->count --;
+    wheel->on_expire(wheel, node);
+  }
+
+  if (wheel->manual) {
+    return;
+  }
+  if (wheel->count > 0) {
+    ndn_timer_start(&wheel->timer, now, wheel->tick);
+  }
+  else {
+    ndn_timer_stop(&wheel->timer);
+  }
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2019 Xinyu Ma, Tianyuan Yu
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#ifndef UTIL_TIMER_WHEEL_H_
+#define UTIL_TIMER_WHEEL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ndn-lite-timer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup NDNUtilTimerWheel Timer Wheel
+ * @ingroup NDNUtil
+ *
+ * Hashed timing wheel for a large number of timeouts, e.g. one per PIT entry.
+ * Scheduling and cancelling are O(1). The wheel itself takes a single timer
+ * of the ndn-lite-timer scheduler, ticking only while some node is pending.
+ * @{
+ */
+
+/** The number of slots of a wheel. Must be a power of 2.
+ */
+#define NDN_TIMER_WHEEL_SLOTS 64
+
+/**
+ * A node scheduled on the wheel. Embed it into the object to expire.
+ */
+typedef struct ndn_timer_wheel_node {
+  struct ndn_timer_wheel_node* prev;
+  struct ndn_timer_wheel_node* next;
+  /**
+   * The time (in milliseconds) at which the node expires.
+   */
+  uint64_t expire_time;
+} ndn_timer_wheel_node_t;
+
+struct ndn_timer_wheel;
+
+/**
+ * The expiry callback. The node has been unscheduled when it is called,
+ * so the callback may schedule it again.
+ * @param wheel Input. The wheel.
+ * @param node Input. The expired node.
+ */
+typedef void (*ndn_timer_wheel_callback)(struct ndn_timer_wheel* wheel, ndn_timer_wheel_node_t* node);
+
+/**
+ * Timer wheel class.
+ */
+typedef struct ndn_timer_wheel {
+  /**
+   * The list heads of all slots.
+   */
+  ndn_timer_wheel_node_t slots[NDN_TIMER_WHEEL_SLOTS];
+  /**
+   * The time (in milliseconds) up to which the wheel has been advanced.
+   */
+  uint64_t last_time;
+  /**
+   * The time span (in milliseconds) of a slot.
+   */
+  uint32_t tick;
+  /**
+   * The number of scheduled nodes.
+   */
+  uint32_t count;
+  /**
+   * The expiry callback.
+   */
+  ndn_timer_wheel_callback on_expire;
+  /**
+   * The timer driving this wheel.
+   */
+  ndn_timer_t timer;
+  /**
+   * True if the wheel is advanced by its owner instead of the timer.
+   */
+  bool manual;
+} ndn_timer_wheel_t;
+
+/**
+ * Initialize a node. A node must be inited before being scheduled or cancelled.
+ * @param node Output. The node.
+ */
+static inline void
+ndn_timer_wheel_node_init(ndn_timer_wheel_node_t* node)
+{
+  node->prev = node->next = node;
+}
+
+/**
+ * Check whether a node is scheduled.
+ * @param node Input. The node.
+ */
+static inline bool
+ndn_timer_wheel_node_is_scheduled(const ndn_timer_wheel_node_t* node)
+{
+  return node->next != node;
+}
+
+/**
+ * Initialize a timer wheel.
+ * @param wheel Output. The wheel.
+ * @param tick Input. The time span (in milliseconds) of a slot, i.e. the precision of the wheel.
+ * @param on_expire Input. The expiry callback.
+ */
+void
+ndn_timer_wheel_init(ndn_timer_wheel_t* wheel, uint32_t tick, ndn_timer_wheel_callback on_expire);
+
+/**
+ * Choose whether the wheel is driven by its timer or by the owner calling
+ * ndn_timer_wheel_advance(). A manual wheel never touches the timer scheduler,
+ * so it can be used by a thread other than the one running the scheduler.
+ * @param wheel Input/Output. The wheel.
+ * @param manual Input. True to stop the timer and advance the wheel manually.
+ */
+void
+ndn_timer_wheel_set_manual(ndn_timer_wheel_t* wheel, bool manual);
+
+/**
+ * Schedule or reschedule a node.
+ * @param wheel Input/Output. The wheel.
+ * @param node Input/Output. The node.
+ * @param expire_time Input. The time (in milliseconds) at which the node expires.
+ */
+void
+ndn_timer_wheel_schedule(ndn_timer_wheel_t* wheel, ndn_timer_wheel_node_t* node, uint64_t expire_time);
+
+/**
+ * Unschedule a node. Do nothing if the node is not scheduled.
+ * @param wheel Input/Output. The wheel.
+ * @param node Input/Output. The node.
+ */
+void
+ndn_timer_wheel_cancel(ndn_timer_wheel_t* wheel, ndn_timer_wheel_node_t* node);
+
+/**
+ * Fire all nodes which expire at or before @c now.
+ * This is called by the driving timer, and can also be called manually.
+ * @param wheel Input/Output. The wheel.
+ * @param now Input. The current time in milliseconds.
+ */
+void
+ndn_timer_wheel_advance(ndn_timer_wheel_t* wheel, uint64_t now);
+
+/*@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UTIL_TIMER_WHEEL_H_
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2019 Xinyu Ma
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include "trace-decoder.h"
+#include "../ndn-error-code.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char* const event_names[NDN_TRACE_EVENT_MAX] = {
+  [NDN_TRACE_EVENT_NONE] = "NONE",
+  [NDN_TRACE_EVENT_FACE_RECEIVE] = "FACE_RECEIVE",
+  [NDN_TRACE_EVENT_INTEREST_IN] = "INTEREST_IN",
+  [NDN_TRACE_EVENT_DATA_IN] = "DATA_IN",
+  [NDN_TRACE_EVENT_NACK_IN] = "NACK_IN",
+  [NDN_TRACE_EVENT_INTEREST_OUT] = "INTEREST_OUT",
+  [NDN_TRACE_EVENT_DATA_OUT] = "DATA_OUT",
+  [NDN_TRACE_EVENT_NACK_OUT] = "NACK_OUT",
+  [NDN_TRACE_EVENT_DROP] = "DROP",
+  [NDN_TRACE_EVENT_PIT_EXPIRE] = "PIT_EXPIRE",
+  [NDN_TRACE_EVENT_FIB_INSERT] = "FIB_INSERT",
+};
+
+static const char* const level_names[] = {"NONE", "ERROR", "INFO", "DEBUG"};
+
+const char*
+ndn_trace_event_name(uint8_t event)
+{
+  if (event >= NDN_TRACE_EVENT_MAX || event_names[event] == NULL)
+    return "UNKNOWN";
+  return event_names[event];
+}
+
+int
+ndn_trace_record_to_text(const ndn_trace_record_t* record, uint64_t base_time,
+                         char* text, uint32_t size)
+{
+  const char* level = (record->level <= NDN_TRACE_LEVEL_DEBUG) ? level_names[record->level] : "UNKNOWN";
+  int len = snprintf(text, size, "%10u +%-12llu %-5s %-12s face=%u name=%08x value=%d\n",
+                     (unsigned)record->sequence, (unsigned long long)(record->timestamp - base_time),
+                     level, ndn_trace_event_name(record->event), (unsigned)record->face_id,
+                     (unsigned)record->name_hash, (int)record->value);
+  if (len < 0 || (uint32_t)len >= size) {
+    return NDN_OVERSIZE;
+  }
+  return len;
+}
+
+int
+ndn_trace_decode(const uint8_t* dump, uint32_t dump_size, char* text, uint32_t size)
+{
+  uint32_t count = dump_size / sizeof(ndn_trace_record_t);
+  uint32_t offset = 0;
+  bool has_base = false;
+  uint64_t base_time = 0;
+  ndn_trace_record_t record;
+
+  if (size == 0) {
+    return NDN_OVERSIZE;
+  }
+  text[0] = '\0';
+  for (uint32_t i = 0; i < count; i++) {
+    // the dump may not be aligned
+    memcpy(&record, dump + i * sizeof(ndn_trace_record_t), sizeof(ndn_trace_record_t));
+    if (record.event == NDN_TRACE_EVENT_NONE)
+      continue;
+    if (!has_base) {
+      base_time = record.timestamp;
+      has_base = true;
+    }
+    int len = ndn_trace_record_to_text(&record, base_time, text + offset, size - offset);
+    if (len < 0) {
+      return len;
+    }
+    offset += len;
+  }
+  return offset;
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2019 Xinyu Ma
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#ifndef UTIL_TRACE_DECODER_H_
+#define UTIL_TRACE_DECODER_H_
+
+#include "trace.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup NDNUtilTraceDecoder Trace Decoder
+ * @ingroup NDNUtilTrace
+ *
+ * Text output of the records got by ndn_trace_dump().
+ * It is kept apart from the trace, so that devices which only dump the ring do not link
+ * the formatting code. A dump must be decoded on a host of the same byte order.
+ * @{
+ */
+
+/**
+ * Get the name of a trace event.
+ * @param event Input. The event.
+ * @return The name, e.g. "INTEREST_IN". "UNKNOWN" for an unknown event.
+ */
+const char*
+ndn_trace_event_name(uint8_t event);
+
+/**
+ * Turn a trace record into a line of text.
+ * @param record Input. The record.
+ * @param base_time Input. The timestamp the time of the record is printed relative to.
+ * @param text Output. The buffer receiving the NUL-terminated line.
+ * @param size Input. The size of @c text.
+ * @return The length of the line. NDN_OVERSIZE if @c text is too small.
+ */
+int
+ndn_trace_record_to_text(const ndn_trace_record_t* record, uint64_t base_time,
+                         char* text, uint32_t size);
+
+/**
+ * Turn a dump of trace records into text, one line per record.
+ * Unused records are skipped, and times are printed relative to the first record.
+ * @param dump Input. The records, as got by ndn_trace_dump() and saved as raw bytes.
+ * @param dump_size Input. The size of @c dump in bytes.
+ * @param text Output. The buffer receiving the NUL-terminated text.
+ * @param size Input. The size of @c text.
+ * @return The length of the text. NDN_OVERSIZE if @c text is too small.
+ */
+int
+ndn_trace_decode(const uint8_t* dump, uint32_t dump_size, char* text, uint32_t size);
+
+/*@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UTIL_TRACE_DECODER_H_
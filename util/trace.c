@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2019 Xinyu Ma
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include "trace.h"
+#include "../ndn-error-code.h"
+#include <string.h>
+
+// No memory is spent on the ring when tracing is compiled out
+#if NDN_TRACE_LEVEL > NDN_TRACE_LEVEL_NONE
+static ndn_trace_record_t trace_records[NDN_TRACE_RING_SIZE];
+#else
+static ndn_trace_record_t trace_records[1];
+#endif
+
+ndn_trace_ring_t ndn_trace_ring = {
+  .records = trace_records,
+  .mask = sizeof(trace_records) / sizeof(ndn_trace_record_t) - 1,
+  .head = 0,
+};
+
+int
+ndn_trace_set_buffer(void* memory, uint32_t capacity)
+{
+  if (capacity == 0 || (capacity & (capacity - 1)) != 0) {
+    return NDN_OVERSIZE;
+  }
+  memset(memory, 0, capacity * sizeof(ndn_trace_record_t));
+  ndn_trace_ring.records = (ndn_trace_record_t*)memory;
+  ndn_trace_ring.mask = capacity - 1;
+  ndn_trace_ring.head = 0;
+  return 0;
+}
+
+uint32_t
+ndn_trace_dump(ndn_trace_record_t* records, uint32_t count)
+{
+  uint32_t head = __atomic_load_n(&ndn_trace_ring.head, __ATOMIC_ACQUIRE);
+  uint32_t size = (head > ndn_trace_ring.mask) ? ndn_trace_ring.mask + 1 : head;
+  if (count > size)
+    count = size;
+  for (uint32_t i = 0; i < count; i++) {
+    records[i] = ndn_trace_ring.records[(head - count + i) & ndn_trace_ring.mask];
+  }
+  return count;
+}
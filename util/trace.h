@@ -0,0 +1,218 @@
+/*
+ * Copyright (C) 2019 Xinyu Ma
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v3.0. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#ifndef UTIL_TRACE_H_
+#define UTIL_TRACE_H_
+
+#include <stdint.h>
+#include "../ndn-constants.h"
+#include "ndn-lite-alarm.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup NDNUtilTrace Trace
+ * @ingroup NDNUtil
+ *
+ * Binary trace of the forwarding path.
+ * Each event is a fixed-size record written into an in-memory ring, which costs a few stores
+ * and an atomic increment instead of a formatted write to stdout. The ring keeps the latest
+ * records and can be dumped with ndn_trace_dump() and turned into text on any host with
+ * ndn_trace_decode().
+ *
+ * Events are compiled in up to NDN_TRACE_LEVEL, e.g. @c -DNDN_TRACE_LEVEL=3 for all of them.
+ * The macros of the levels above it expand to nothing.
+ * @{
+ */
+
+#define NDN_TRACE_LEVEL_NONE 0
+#define NDN_TRACE_LEVEL_ERROR 1
+#define NDN_TRACE_LEVEL_INFO 2
+#define NDN_TRACE_LEVEL_DEBUG 3
+
+/**
+ * The trace events.
+ */
+enum {
+  NDN_TRACE_EVENT_NONE = 0,
+  /** A face handed a packet to the forwarder. Value: the packet size. */
+  NDN_TRACE_EVENT_FACE_RECEIVE = 1,
+  /** The forwarder received an Interest. */
+  NDN_TRACE_EVENT_INTEREST_IN = 2,
+  /** The forwarder received a Data. */
+  NDN_TRACE_EVENT_DATA_IN = 3,
+  /** The forwarder received a Nack. Value: the Nack reason. */
+  NDN_TRACE_EVENT_NACK_IN = 4,
+  /** The forwarder sent an Interest. */
+  NDN_TRACE_EVENT_INTEREST_OUT = 5,
+  /** The forwarder sent a Data. */
+  NDN_TRACE_EVENT_DATA_OUT = 6,
+  /** The forwarder sent a Nack. Value: the Nack reason. */
+  NDN_TRACE_EVENT_NACK_OUT = 7,
+  /** The forwarder dropped a packet. Value: the error code. */
+  NDN_TRACE_EVENT_DROP = 8,
+  /** A PIT entry expired. */
+  NDN_TRACE_EVENT_PIT_EXPIRE = 9,
+  /** A FIB entry was inserted. Face: the next-hop. Name hash: the prefix. */
+  NDN_TRACE_EVENT_FIB_INSERT = 10,
+  NDN_TRACE_EVENT_MAX = 11,
+};
+
+/**
+ * A trace record.
+ */
+typedef struct ndn_trace_record {
+  /**
+   * The time of the event, in ticks of NDN_TRACE_CLOCK().
+   */
+  uint64_t timestamp;
+  /**
+   * The position of the record in the trace, counting from 0.
+   */
+  uint32_t sequence;
+  /**
+   * The hash of the packet name, see ndn_name_hash(). 0 if none.
+   */
+  uint32_t name_hash;
+  /**
+   * An event-specific value.
+   */
+  int32_t value;
+  /**
+   * The ID of the face involved. 0 if none.
+   */
+  uint16_t face_id;
+  /**
+   * The event, e.g. NDN_TRACE_EVENT_INTEREST_IN. NDN_TRACE_EVENT_NONE for an unused record.
+   */
+  uint8_t event;
+  /**
+   * The trace level of the event, e.g. NDN_TRACE_LEVEL_DEBUG.
+   */
+  uint8_t level;
+} ndn_trace_record_t;
+
+/**
+ * The trace ring.
+ */
+typedef struct ndn_trace_ring {
+  /**
+   * The record array.
+   */
+  ndn_trace_record_t* records;
+  /**
+   * The number of records minus 1.
+   */
+  uint32_t mask;
+  /**
+   * The sequence of the next record.
+   */
+  uint32_t head;
+} ndn_trace_ring_t;
+
+/**
+ * The trace ring in use. It has NDN_TRACE_RING_SIZE static records unless replaced by
+ * ndn_trace_set_buffer().
+ */
+extern ndn_trace_ring_t ndn_trace_ring;
+
+/**
+ * The clock the records are stamped with: the CPU time stamp counter where it can be
+ * read in a few cycles, milliseconds of the alarm otherwise.
+ * Define it before including this header to use another clock.
+ */
+#ifndef NDN_TRACE_CLOCK
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define NDN_TRACE_CLOCK() __builtin_ia32_rdtsc()
+#else
+#define NDN_TRACE_CLOCK() ndn_alarm_millis_get_now()
+#endif
+#endif
+
+/**
+ * Write a trace record. Use the NDN_TRACE_* macros instead, so that the call is compiled out
+ * above NDN_TRACE_LEVEL. This function can be invoked from any thread.
+ * @param level Input. The trace level.
+ * @param event Input. The event.
+ * @param face_id Input. The ID of the face involved.
+ * @param name_hash Input. The hash of the packet name.
+ * @param value Input. The event-specific value.
+ */
+static inline void
+ndn_trace_write(uint8_t level, uint8_t event, uint16_t face_id, uint32_t name_hash, int32_t value)
+{
+  uint32_t sequence = __atomic_fetch_add(&ndn_trace_ring.head, 1, __ATOMIC_RELAXED);
+  ndn_trace_record_t* record = &ndn_trace_ring.records[sequence & ndn_trace_ring.mask];
+  record->timestamp = NDN_TRACE_CLOCK();
+  record->sequence = sequence;
+  record->name_hash = name_hash;
+  record->value = value;
+  record->face_id = face_id;
+  record->event = event;
+  record->level = level;
+}
+
+// A trace point compiled out does not evaluate its arguments, but still uses them, so that
+// a variable only traced does not make an unused warning
+#define NDN_TRACE_DISCARD(event, face_id, name_hash, value) \
+  ((void)sizeof((event) + (face_id) + (name_hash) + (value)))
+
+#if NDN_TRACE_LEVEL >= NDN_TRACE_LEVEL_ERROR
+#define NDN_TRACE_ERROR(event, face_id, name_hash, value) \
+  ndn_trace_write(NDN_TRACE_LEVEL_ERROR, (event), (face_id), (name_hash), (value))
+#else
+#define NDN_TRACE_ERROR(event, face_id, name_hash, value) \
+  NDN_TRACE_DISCARD(event, face_id, name_hash, value)
+#endif
+
+#if NDN_TRACE_LEVEL >= NDN_TRACE_LEVEL_INFO
+#define NDN_TRACE_INFO(event, face_id, name_hash, value) \
+  ndn_trace_write(NDN_TRACE_LEVEL_INFO, (event), (face_id), (name_hash), (value))
+#else
+#define NDN_TRACE_INFO(event, face_id, name_hash, value) \
+  NDN_TRACE_DISCARD(event, face_id, name_hash, value)
+#endif
+
+#if NDN_TRACE_LEVEL >= NDN_TRACE_LEVEL_DEBUG
+#define NDN_TRACE_DEBUG(event, face_id, name_hash, value) \
+  ndn_trace_write(NDN_TRACE_LEVEL_DEBUG, (event), (face_id), (name_hash), (value))
+#else
+#define NDN_TRACE_DEBUG(event, face_id, name_hash, value) \
+  NDN_TRACE_DISCARD(event, face_id, name_hash, value)
+#endif
+
+/**
+ * Replace the trace ring storage with caller-supplied memory of a different capacity.
+ * All records are dropped. It must not be invoked while any thread is tracing.
+ * @pre @c capacity * sizeof(ndn_trace_record_t) bytes needed, aligned to 8 bytes.
+ * @param memory Input. The memory used to keep the records.
+ * @param capacity Input. The max number of records, a power of 2.
+ * @return 0 if there is no error. NDN_OVERSIZE if @c capacity is not a power of 2.
+ */
+int
+ndn_trace_set_buffer(void* memory, uint32_t capacity);
+
+/**
+ * Copy the records in the ring out, from the oldest to the latest.
+ * Records being written concurrently may come out torn, so dump a quiet ring
+ * to get an exact trace.
+ * @param records Output. The array receiving the records.
+ * @param count Input. The max number of records, the latest ones are kept.
+ * @return The number of records copied.
+ */
+uint32_t
+ndn_trace_dump(ndn_trace_record_t* records, uint32_t count);
+
+/*@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UTIL_TRACE_H_